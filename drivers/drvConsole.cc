@@ -62,6 +62,7 @@ DriverConsole::DriverConsole(){
   put = new Semaphore((char*)"put",0);
   mutexget = new Lock((char*)"mutex get");
   mutexput = new Lock((char*)"mutex put");
+  pollers = 0;
 }
 
 
@@ -148,7 +149,7 @@ void DriverConsole::GetString(char *buffer,int nbcar) {
   int i;
 
   mutexget->Acquire();
-  g_machine->console->EnableInterrupt();
+  StartPolling();
   
   for (i=0;((i<nbcar) && (c!='\n'));i++) {
     g_current_thread->GetProcessOwner()->stat->incrNumCharRead();
@@ -158,7 +159,35 @@ void DriverConsole::GetString(char *buffer,int nbcar) {
   }
   buffer[i] = 0;
 
-  g_machine->console->DisableInterrupt();
+  StopPolling();
   mutexget->Release();
 
 }
+
+//-----------------------------------------------------------------
+// DriverConsole::StartPolling
+/*!     Enable the console interrupt, unless it is already enabled
+//      for another thread. Both GetString and WaitAny wait for the
+//      keyboard, possibly at the same time.
+*/
+//-----------------------------------------------------------------
+void DriverConsole::StartPolling() {
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  if (pollers++ == 0)
+    g_machine->console->EnableInterrupt();
+  (void) g_machine->interrupt->SetStatus(oldLevel);
+}
+
+//-----------------------------------------------------------------
+// DriverConsole::StopPolling
+/*!     Disable the console interrupt once no thread waits for the
+//      keyboard any more.
+*/
+//-----------------------------------------------------------------
+void DriverConsole::StopPolling() {
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  ASSERT(pollers > 0);
+  if (--pollers == 0)
+    g_machine->console->DisableInterrupt();
+  (void) g_machine->interrupt->SetStatus(oldLevel);
+}
@@ -51,10 +51,20 @@ class DriverConsole {
   void GetAChar();           // Send a char to the console device
   void PutAChar();           // Receive e char from the console
 
+  void StartPolling();       // Poll the keyboard until StopPolling
+  void StopPolling();
+
+  //! Return true if a character has been received (interrupts disabled)
+  bool InputReady() { return get->IsAvailable(); }
+
+  //! Threads in WaitAny, notified when a character is received
+  WaitList *GetInputWatchers() { return get->GetWatchers(); }
+
 private:
   Lock *mutexget;            //!< Lock on read operations
   Lock *mutexput;            //!< Lock on write operations
   Semaphore *get, *put;      //!< Semaphores to wait for interrupts
+  int pollers;               //!< Threads needing the keyboard polled
 };
     
 void ConsoleGet();
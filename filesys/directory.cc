@@ -40,6 +40,9 @@
 #include "filesys/directory.h"
 
 
+//! Cache of the directories
+SlabCache Directory::slabCache("Directory", sizeof(Directory));
+
 //----------------------------------------------------------------------
 // Directory::Directory
 /*! 	Initialize a directory; initially, the directory is completely
@@ -70,6 +70,11 @@ class Directory {
 					
     ~Directory();			// De-allocate the directory
 
+    //! Allocated from a cache, one per lookup (see slab.h)
+    void *operator new(size_t size) { return slabCache.Alloc(size); }
+    void operator delete(void *obj) { slabCache.Free(obj); }
+    static SlabCache slabCache;
+
     void FetchFrom(OpenFile *file);  	// Init directory contents from disk
     void WriteBack(OpenFile *file);	// Write modifications to 
 					// directory contents back to disk
@@ -59,6 +59,7 @@
 
 
 #include "kernel/system.h"
+#include "kernel/execcache.h"
 #include "kernel/msgerror.h"
 #include "machine/disk.h"
 #include "utility/config.h"
@@ -439,6 +440,9 @@ FileSystem::Remove(char *name)
   // Do nothing if it's a directory
   if (fileHdr.IsDir()) return NOT_A_FILE;
 
+  // The header sector may be given to another file
+  g_exec_cache->Invalidate(sector);
+
   // Get the freemap file from the disk
   BitMap freeMap(NUM_SECTORS);
   freeMap.FetchFrom(freeMapFile);
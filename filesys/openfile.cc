@@ -27,10 +27,14 @@
 #include <strings.h>
 #include "kernel/msgerror.h"
 #include "kernel/system.h"
+#include "kernel/execcache.h"
 #include "filesys/filehdr.h"
 #include "filesys/openfile.h"
 #include "drivers/drvDisk.h"
 
+//! Cache of the open files
+SlabCache OpenFile::slabCache("OpenFile", sizeof(OpenFile));
+
 //----------------------------------------------------------------------
 // OpenFile::OpenFile
 /*! 	Open a Nachos file for reading and writing.  Bring the file header
@@ -206,6 +210,12 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
     if ((numBytes <= 0) || (position<0) || (position > fileLength))
       return 0;				// check request
 
+    // The parsed image of the file, if any, is no longer valid. It
+    // is invalidated again once the data is on disk: an Exec of the
+    // file while this thread blocks on the disk could cache a
+    // half-written image.
+    g_exec_cache->Invalidate(fSector);
+
     // Allocate new sectors if the file is not big enough
     if ((position + numBytes) > maxFileLength)
       {                                 // there isn't enough place
@@ -253,6 +263,7 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
     for (i = firstSector; i <= lastSector; i++)	
       g_disk_driver->WriteSector(hdr->ByteToSector(i * g_cfg->SectorSize), 
 			     &buf[(i - firstSector) * g_cfg->SectorSize]);
+    g_exec_cache->Invalidate(fSector);
     return numBytes;
 }
 
@@ -284,6 +295,15 @@ OpenFile::IsDir()
   return hdr->IsDir();
 }
 //----------------------------------------------------------------------
+// OpenFile::GetSector
+//! 	Return the sector of the file's header.
+//----------------------------------------------------------------------
+int
+OpenFile::GetSector()
+{
+  return fSector;
+}
+//----------------------------------------------------------------------
 // OpenFile::GetName
 //! 	Return the name of the file.
 //----------------------------------------------------------------------
@@ -28,6 +28,7 @@
 #include "kernel/copyright.h"
 #include "utility/utility.h"
 #include "kernel/system.h"
+#include "utility/slab.h"
 
 class FileHeader;
 
@@ -48,6 +49,11 @@ public:
 
   //! Close the file
   ~OpenFile();
+
+  //! Allocated from a cache (see slab.h)
+  void *operator new(size_t size) { return slabCache.Alloc(size); }
+  void operator delete(void *obj) { slabCache.Free(obj); }
+  static SlabCache slabCache;
   
   /*! Set the position from which to 
      start reading/writing -- UNIX lseek
@@ -80,6 +86,8 @@ public:
   void SetName(char*);                //!< Set the file's name
   
   bool IsDir();                       //!< return true if the file is a directory
+
+  int GetSector();                    //!< return the sector of the file's header
 private:
   char* name;                         //!< the file's name.
   FileHeader *hdr;		      //!< Header for this file 
@@ -38,7 +38,10 @@
 #include "filesys/openfile.h"
 #include "vm/physMem.h"
 #include "kernel/elf.h"
+#include "kernel/execcache.h"
+#include "vm/faultprof.h"
 #include "kernel/addrspace.h"
+#include "userlib/syscall.h"
 
 //----------------------------------------------------------------------
 /** 	Create an address space to run a user program.
@@ -66,12 +69,16 @@
 //----------------------------------------------------------------------
 AddrSpace::AddrSpace(OpenFile * exec_file, Process *p, int *err)
 {
-  char eident[16];
   *err  = 0;
   translationTable = NULL;
   freePageId = 0;
   process = p;
-  char is32Bits = 0;
+  infoPageAddr = 0;
+  infoPage = NULL;
+  nb_shared_areas = 0;
+  nb_fault_ranges = 0;
+  fault_ranges = NULL;
+  is32Bits = 0;
 
   /* Empty user address space requested ? */
   if (exec_file == NULL) {
@@ -80,41 +87,22 @@ AddrSpace::AddrSpace(OpenFile * exec_file, Process *p, int *err)
     return;
   }
 
-  // Read the 16 first bytes of the Header to check if the
-  // file is 32 or 64 bits
-  exec_file->ReadAt((char *) &eident, 16, 0);
-  if (eident[EI_CLASS] == ELFCLASS32)
-	is32Bits = 1;
-  else if (eident[EI_CLASS] == ELFCLASS64)
-	is32Bits = 0;
-  else {
-    	printf("Error, the ELF File was not recognized as a 32 or 64 bits file, exiting.\n");
-	exit(ERROR);
-  }
-
-  // Read elf header and check file format
-  ElfFile elff(exec_file,is32Bits,err);
-  if (*err != NO_ERROR) {
+  // Get the section layout and contents of the program, parsed
+  // and read from the disk only if the file is not in the exec cache
+  ExecImage *image = g_exec_cache->Get(exec_file, err);
+  if (image == NULL) {
     printf("Error, wrong file format for ELF file, exiting.\n");
     exit(ERROR);
   }
  
   printf("\n****  Loading file %s :\n", exec_file->GetName());
+  is32Bits = image->is32Bits;
  
   // Create an empty translation table
   translationTable = new TranslationTable();
 
-  // Compute the highest virtual address to init the translation table
-  uint64_t mem_topaddr = 0;
-  for (int i = 0 ; i < elff.getShNum() ; i++) {
-    // Ignore empty sections
-    if (elff.getShSize(i) <= 0)
-      continue;
-    uint64_t section_topaddr = elff.getShAddr(i) + elff.getShSize(i);
-    if ((elff.getShFlags(i) & SHF_ALLOC)
-	&& (section_topaddr > mem_topaddr))
-      mem_topaddr = section_topaddr;
-  }
+  // The highest virtual address is used to init the translation table
+  uint64_t mem_topaddr = image->topAddr;
   
   // Allocate space in virtual memory
   int base_addr = this->Alloc(divRoundUp(mem_topaddr, g_cfg->PageSize));
@@ -125,38 +113,33 @@ AddrSpace::AddrSpace(OpenFile * exec_file, Process *p, int *err)
 	mem_topaddr);
   
   // Loading of all sections
-  for (int i = 0 ; i < elff.getShNum() ; i++) {
-    // Retrieve the section name
-    const char *section_name = elff.getShName(i);
-    
-    DEBUG('a', (char*)"Section %d : size=0x%x name=\"%s\"\n",
-	  i, elff.getShSize(i), section_name);
-    
-    // Ignore empty sections
-    if (elff.getShSize(i) <= 0)
-      continue;
-    
-    // Look if this section has to be loaded (SHF_ALLOC flag)
-    if (! (elff.getShFlags(i) & SHF_ALLOC))
-      continue;
+  fault_ranges = new s_fault_range[image->numSections];
+  for (int i = 0 ; i < image->numSections ; i++) {
+    ExecSection *section = &image->sections[i];
+
+    s_fault_range *range = &fault_ranges[nb_fault_ranges++];
+    range->first_page = section->addr / g_cfg->PageSize;
+    range->num_pages = divRoundUp(section->size, g_cfg->PageSize);
+    range->region = g_fault_profiler->GetRegion(exec_file->GetName(),
+						section->name);
     
     printf("\t- Section %s : file offset 0x%x, size 0x%x, addr 0x%x, %s%s\n",
-	   section_name,
-	   (unsigned)elff.getShOffset(i),
-	   (unsigned)elff.getShSize(i),
-	   (unsigned)elff.getShAddr(i),
-	   (elff.getShFlags(i) & SHF_WRITE)?"R/W":"R",
-	   (elff.getShFlags(i) & SHF_EXECINSTR)?"/X":"");
+	   section->name,
+	   (unsigned)section->offset,
+	   (unsigned)section->size,
+	   (unsigned)section->addr,
+	   (section->flags & SHF_WRITE)?"R/W":"R",
+	   (section->flags & SHF_EXECINSTR)?"/X":"");
     
     // Make sure section is aligned on page boundary
-    ASSERT((elff.getShAddr(i) % g_cfg->PageSize)==0);
+    ASSERT((section->addr % g_cfg->PageSize)==0);
 
     
     // Initializes the page table entries and loads the section
     // in memory (demand paging will be implemented later on)
     for (unsigned int pgdisk = 0,
-	   virt_page = elff.getShAddr(i) / g_cfg->PageSize ;
-	 pgdisk < divRoundUp(elff.getShSize(i), g_cfg->PageSize) ;
+	   virt_page = section->addr / g_cfg->PageSize ;
+	 pgdisk < divRoundUp(section->size, g_cfg->PageSize) ;
 	 pgdisk++, virt_page ++)
       {
 
@@ -173,7 +156,7 @@ AddrSpace::AddrSpace(OpenFile * exec_file, Process *p, int *err)
 
 
 
-	if (elff.getShFlags(i) & SHF_WRITE)
+	if (section->flags & SHF_WRITE)
 
 	  translationTable->setBitWriteAllowed(virt_page);
 
@@ -207,27 +190,17 @@ AddrSpace::AddrSpace(OpenFile * exec_file, Process *p, int *err)
 
 	  
 
-	// The SHT_NOBITS flag indicates if the section has an image
-
-	// in the executable file (text or data section) or not 
-
-	// (bss section)
-
-	if (elff.getShType(i) != SHT_NOBITS) {
-
-	  // The section has an image in the executable file
-
-	  // Read it from the disk
+	// The sections without image in the executable file (bss)
+	// have no image in the cache either
+	if (section->image != NULL) {
 
-	  exec_file->ReadAt((char *)&(g_machine->mainMemory[translationTable->getPhysicalPage(virt_page)*g_cfg->PageSize]),
-
-			    g_cfg->PageSize,
-
-			    elff.getShOffset(i)
-
-			    + pgdisk*g_cfg->PageSize);
+	  // The section has an image in the executable file: copy it
+	  // from the exec cache
+	  memcpy(&(g_machine->mainMemory[translationTable->getPhysicalPage(virt_page)*g_cfg->PageSize]),
 
+		 section->image + pgdisk*g_cfg->PageSize,
 
+		 g_cfg->PageSize);
 
 	}
 
@@ -267,12 +240,75 @@ AddrSpace::AddrSpace(OpenFile * exec_file, Process *p, int *err)
     }
 
   // Get program start address
-  CodeStartAddress = (int32_t)elff.getEntry();
+  CodeStartAddress = (int32_t)image->entry;
+  g_exec_cache->Release(image);
   printf("\t- Program start address : 0x%lx\n\n",
 	 (unsigned long)CodeStartAddress);
 
   // Init the number of memory mapped files to zero
   nb_mapped_files = 0;
+
+  // Map the information page, read-only, after the program
+  int info_page = this->Alloc(1);
+  int pp = g_physical_mem_manager->FindFreePage();
+  if (pp == INVALID_PAGE) { 
+    printf("Not enough free space to load program %s\n",
+	   exec_file->GetName());
+    g_machine->interrupt->Halt(ERROR);
+  }
+  g_physical_mem_manager->tpr[pp].virtualPage=info_page;
+  g_physical_mem_manager->tpr[pp].owner = this;
+  g_physical_mem_manager->tpr[pp].locked=true;
+  translationTable->setPhysicalPage(info_page,pp);
+  translationTable->setAddrDisk(info_page,INVALID_SECTOR);
+  translationTable->clearBitSwap(info_page);
+  translationTable->setBitReadAllowed(info_page);
+  translationTable->clearBitWriteAllowed(info_page);
+  translationTable->clearBitIo(info_page);
+  translationTable->setBitValid(info_page);
+  infoPage = &(g_machine->mainMemory[pp*g_cfg->PageSize]);
+  memset(infoPage, 0, g_cfg->PageSize);
+  ASSERT(sizeof(Nachos_InfoPage) <= (unsigned)g_cfg->PageSize);
+  infoPageAddr = (uint64_t)info_page*g_cfg->PageSize;
+  DEBUG('a', (char*)"Information page at 0x%" PRIx64 "\n", infoPageAddr);
+}
+
+//----------------------------------------------------------------------
+/**	Publish the time and the counters of the process in the
+ *	information page. The page is only written here and in
+ *	UpdateInfoTime, while no user instruction is executed, but
+ *	a thread of the process may be preempted between two reads of
+ *	the page: seq is incremented at each update so that user code
+ *	can detect it (see n_info_snapshot in libnachos.c).
+ *
+ *	\param thread the thread of the process now running
+ */
+//----------------------------------------------------------------------
+void AddrSpace::UpdateInfoPage(Thread *thread)
+{
+  if (infoPage == NULL)
+    return;
+  Nachos_InfoPage *info = (Nachos_InfoPage *)infoPage;
+  ProcessStat *stat = process->stat;
+  info->seq++;
+  info->ticks = g_stats->getTotalTicks();
+  info->frequency = g_cfg->ProcessorFrequency;
+  info->numInstructions = stat->getNumInstruction();
+  info->userTicks = stat->getUserTime();
+  info->systemTicks = stat->getSystemTime();
+  info->numPageFaults = stat->getNumPageFaults();
+  info->tid = thread->GetId();
+}
+
+//----------------------------------------------------------------------
+/**	Publish the time in the information page. Called at each tick,
+ *	so only the clock is updated.
+ */
+//----------------------------------------------------------------------
+void AddrSpace::UpdateInfoTime()
+{
+  if (infoPage != NULL)
+    ((Nachos_InfoPage *)infoPage)->ticks = g_stats->getTotalTicks();
 }
 
 //----------------------------------------------------------------------
@@ -302,6 +338,7 @@ AddrSpace::~AddrSpace()
     }
     delete translationTable;
   }
+  delete [] fault_ranges;
 }
 
 //----------------------------------------------------------------------
@@ -447,3 +484,187 @@ OpenFile *AddrSpace::findMappedFile(int64_t addr) {
 
 
 }
+
+//----------------------------------------------------------------------
+/**	Check that pages can be moved to or from another address
+ *	space: they must be allocated, in memory, writable, not
+ *	mapped on a device and not shared. Locked pages are accepted, as all the
+ *	pages are locked without demand paging: the pages moved in
+ *	inherit the lock of the pages they replace.
+ *
+ *	\param vpn first virtual page
+ *	\param numPages number of pages
+ */
+//----------------------------------------------------------------------
+bool AddrSpace::CanMovePages(uint64_t vpn, int numPages)
+{
+  if (numPages <= 0 || vpn + numPages > (uint64_t)freePageId)
+    return false;
+  for (uint64_t p = vpn; p < vpn + numPages; p++)
+    if (!translationTable->getBitValid(p)
+	|| !translationTable->getBitWriteAllowed(p)
+	|| translationTable->getBitIo(p)
+	|| g_physical_mem_manager->tpr[translationTable->getPhysicalPage(p)].owner != this)
+      return false;
+  return true;
+}
+
+//----------------------------------------------------------------------
+/**	Take physical pages out of the address space. They are
+ *	replaced by zeroed pages, so the address space stays valid,
+ *	and belong to no address space (locked in memory) until
+ *	AttachPages maps them elsewhere.
+ *
+ *	\param vpn first virtual page (see CanMovePages)
+ *	\param numPages number of pages
+ *	\param frames where to store the physical pages taken out
+ *	\return NO_ERROR, or OUT_OF_MEMORY if there are not enough
+ *	       free physical pages for the replacement pages
+ */
+//----------------------------------------------------------------------
+int AddrSpace::DetachPages(uint64_t vpn, int numPages, int *frames)
+{
+  PhysicalMemManager *mem = g_physical_mem_manager;
+
+  // Get all the replacement pages first, not to fail halfway
+  for (int i = 0; i < numPages; i++) {
+    frames[i] = mem->FindFreePage();
+    if (frames[i] == INVALID_PAGE) {
+      while (--i >= 0) {
+	mem->tpr[frames[i]].owner = NULL;
+	mem->RemovePhysicalToVirtualMapping(frames[i]);
+      }
+      return OUT_OF_MEMORY;
+    }
+  }
+
+  for (int i = 0; i < numPages; i++) {
+    uint64_t p = vpn + i;
+    int fresh = frames[i];
+    frames[i] = translationTable->getPhysicalPage(p);
+
+    memset(&(g_machine->mainMemory[fresh*g_cfg->PageSize]), 0, g_cfg->PageSize);
+    mem->tpr[fresh].virtualPage = p;
+    mem->tpr[fresh].owner = this;
+    mem->tpr[fresh].locked = mem->tpr[frames[i]].locked;
+    translationTable->setPhysicalPage(p, fresh);
+
+    mem->tpr[frames[i]].owner = NULL;
+    mem->tpr[frames[i]].locked = true;
+  }
+  return NO_ERROR;
+}
+
+//----------------------------------------------------------------------
+/**	Map physical pages returned by DetachPages, in place of the
+ *	pages of the address space, which are freed.
+ *
+ *	\param vpn first virtual page (see CanMovePages)
+ *	\param numPages number of pages
+ *	\param frames the physical pages
+ */
+//----------------------------------------------------------------------
+void AddrSpace::AttachPages(uint64_t vpn, int numPages, int *frames)
+{
+  PhysicalMemManager *mem = g_physical_mem_manager;
+
+  for (int i = 0; i < numPages; i++) {
+    uint64_t p = vpn + i;
+    int old = translationTable->getPhysicalPage(p);
+    bool locked = mem->tpr[old].locked;
+    mem->RemovePhysicalToVirtualMapping(old);
+
+    mem->tpr[frames[i]].virtualPage = p;
+    mem->tpr[frames[i]].owner = this;
+    mem->tpr[frames[i]].locked = locked;
+    translationTable->setPhysicalPage(p, frames[i]);
+    translationTable->setBitValid(p);
+  }
+}
+
+//----------------------------------------------------------------------
+/**	Map the physical pages of a shared memory segment in a new
+ *	virtual area, readable and writable. Each page gets one more
+ *	reference: it is only freed once unmapped from all the address
+ *	spaces (the destructor unmaps the areas left).
+ *
+ *	\param numPages number of pages
+ *	\param frames the physical pages
+ *	\return the virtual address of the area, 0 if there are too many
+ *	       areas or not enough virtual space
+ */
+//----------------------------------------------------------------------
+uint64_t AddrSpace::MapShared(int numPages, int *frames)
+{
+  if (nb_shared_areas == MAX_SHARED_AREAS)
+    return 0;
+  int vpn = this->Alloc(numPages);
+  if (vpn == INVALID_PAGE)
+    return 0;
+
+  for (int i = 0; i < numPages; i++) {
+    uint64_t p = vpn + i;
+    g_physical_mem_manager->ShareFrame(frames[i]);
+    translationTable->setPhysicalPage(p, frames[i]);
+    translationTable->setAddrDisk(p, INVALID_SECTOR);
+    translationTable->clearBitSwap(p);
+    translationTable->setBitReadAllowed(p);
+    translationTable->setBitWriteAllowed(p);
+    translationTable->clearBitIo(p);
+    translationTable->setBitValid(p);
+  }
+  shared_areas[nb_shared_areas].first_page = vpn;
+  shared_areas[nb_shared_areas].num_pages = numPages;
+  nb_shared_areas++;
+
+  DEBUG('a', (char*)"Shared area [0x%" PRIx64 ",0x%" PRIx64 "[ mapped\n",
+	(uint64_t)vpn*g_cfg->PageSize, (uint64_t)(vpn+numPages)*g_cfg->PageSize);
+  return (uint64_t)vpn*g_cfg->PageSize;
+}
+
+//----------------------------------------------------------------------
+/**	Unmap an area mapped by MapShared, dropping a reference on its
+ *	physical pages. The virtual area is not reused (see Alloc).
+ *
+ *	\param addr virtual address of the area
+ *	\return NO_ERROR, or INVALID_USER_ADDRESS if no area starts there
+ */
+//----------------------------------------------------------------------
+int AddrSpace::UnmapShared(uint64_t addr)
+{
+  int a;
+  for (a = 0; a < nb_shared_areas; a++)
+    if (shared_areas[a].first_page*g_cfg->PageSize == addr)
+      break;
+  if (a == nb_shared_areas)
+    return INVALID_USER_ADDRESS;
+
+  uint64_t vpn = shared_areas[a].first_page;
+  for (uint64_t p = vpn; p < vpn + shared_areas[a].num_pages; p++) {
+    g_physical_mem_manager->RemovePhysicalToVirtualMapping(translationTable->getPhysicalPage(p));
+    translationTable->clearBitValid(p);
+    translationTable->clearBitReadAllowed(p);
+    translationTable->clearBitWriteAllowed(p);
+  }
+  shared_areas[a] = shared_areas[--nb_shared_areas];
+  return NO_ERROR;
+}
+
+//----------------------------------------------------------------------
+/**	Return the region of the page fault profiler a virtual page
+ *	belongs to. Only called on page faults: the sections are few,
+ *	and a linear search is enough.
+ *
+ *	\param vpn virtual page number
+ *	\return the region of the section of vpn, FAULT_OTHER_REGION
+ *	       if vpn is not in a section (stack, mappings)
+ */
+//----------------------------------------------------------------------
+int AddrSpace::FaultRegion(uint64_t vpn)
+{
+  for (int i = 0; i < nb_fault_ranges; i++)
+    if (vpn >= fault_ranges[i].first_page
+	&& vpn < fault_ranges[i].first_page + fault_ranges[i].num_pages)
+      return fault_ranges[i].region;
+  return FAULT_OTHER_REGION;
+}
@@ -41,6 +41,20 @@ typedef struct {
 } s_mapped_file;
 typedef s_mapped_file t_mapped_files[MAX_MAPPED_FILES];
 
+#define MAX_SHARED_AREAS 8
+//! Virtual area where a shared memory segment is mapped
+typedef struct {
+  uint64_t first_page;
+  int num_pages;
+} s_shared_area;
+
+//! Pages of a section, for the page fault profiler (see faultprof.h)
+typedef struct {
+  uint64_t first_page;
+  uint64_t num_pages;
+  int region;
+} s_fault_range;
+
 /**
  @brief Defines the data structures to keep track of memory resources of
  executing user programs (address spaces).
@@ -105,6 +119,10 @@ public:
     allocated in RAM. */
   TranslationTable *translationTable;  
 
+  /*! 1 if the program was compiled for RV32 (class of its ELF
+    file), 0 for RV64 or an empty address space */
+  char is32Bits;
+
   /*! Map an open file in memory
    *
    * \param f: pointer to open file descriptor
@@ -119,6 +137,73 @@ public:
    */
   OpenFile *findMappedFile(int64_t addr);
 
+  /*! Virtual address of the information page (see Nachos_InfoPage
+   *  in syscall.h), 0 if the address space has none
+   */
+  uint64_t getInfoPageAddress() { return infoPageAddr; }
+
+  /*! Publish the time and the counters of the process in the
+   *  information page
+   *
+   * \param thread: the thread of the process now running
+   */
+  void UpdateInfoPage(Thread *thread);
+
+  /*! Publish the time in the information page (called at each tick) */
+  void UpdateInfoTime();
+
+  /*! Check that pages can be moved to or from another address
+   *  space: they must be allocated, in memory and writable
+   *
+   * \param vpn: first virtual page
+   * \param numPages: number of pages
+   */
+  bool CanMovePages(uint64_t vpn, int numPages);
+
+  /*! Take the physical pages out of the address space, replacing
+   *  them by zeroed pages (used by message ports)
+   *
+   * \param vpn: first virtual page
+   * \param numPages: number of pages
+   * \param frames: where to store the physical pages taken out
+   * \return NO_ERROR, or OUT_OF_MEMORY
+   */
+  int DetachPages(uint64_t vpn, int numPages, int *frames);
+
+  /*! Map physical pages taken out of another address space, freeing
+   *  the pages they replace
+   *
+   * \param vpn: first virtual page
+   * \param numPages: number of pages
+   * \param frames: the physical pages, returned by DetachPages
+   */
+  void AttachPages(uint64_t vpn, int numPages, int *frames);
+
+  /*! Map the physical pages of a shared memory segment, in a new
+   *  virtual area
+   *
+   * \param numPages: number of pages
+   * \param frames: the physical pages
+   * \return the virtual address of the area, 0 if it cannot be mapped
+   */
+  uint64_t MapShared(int numPages, int *frames);
+
+  /*! Unmap a virtual area mapped by MapShared
+   *
+   * \param addr: virtual address of the area
+   * \return NO_ERROR, or INVALID_USER_ADDRESS if no area starts there
+   */
+  int UnmapShared(uint64_t addr);
+
+  /*! Return the region of the page fault profiler a virtual page
+   *  belongs to
+   *
+   * \param vpn: virtual page number
+   * \return the region of the section of vpn, FAULT_OTHER_REGION if
+   *         vpn is not in a section
+   */
+  int FaultRegion(uint64_t vpn);
+
 private:
 
   //* Code start address, found in the ELF file
@@ -145,6 +230,20 @@ private:
   /*! List of memory-mapped files */
   int nb_mapped_files;
   t_mapped_files mapped_files;
+
+  /*! Areas where shared memory segments are mapped */
+  int nb_shared_areas;
+  s_shared_area shared_areas[MAX_SHARED_AREAS];
+
+  /*! Virtual address of the information page, 0 if none */
+  uint64_t infoPageAddr;
+
+  /*! The information page, in the memory of the machine (NULL if none) */
+  void *infoPage;
+
+  /*! Sections of the program, for the page fault profiler */
+  int nb_fault_ranges;
+  s_fault_range *fault_ranges;
 };
 
 #endif // ADDRSPACE_H
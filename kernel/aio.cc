@@ -0,0 +1,246 @@
+/*! \file aio.cc
+//  \brief Routines of the asynchronous file input/output engine
+//
+//	The I/O thread blocks in the disk driver, exactly as a thread
+//	calling Read or Write would: the other threads, the one which
+//	submitted the request included, keep the CPU meanwhile.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "kernel/aio.h"
+#include "kernel/msgerror.h"
+#include "kernel/synch.h"
+#include "kernel/thread.h"
+#include "filesys/openfile.h"
+#include "machine/machine.h"
+#include "utility/stats.h"
+
+//----------------------------------------------------------------------
+// AioRequest::AioRequest
+/*!	Initialize a request, with an uninitialized buffer of size bytes
+//
+//	\param reqOp AIO_OP_READ or AIO_OP_WRITE
+//	\param reqFile the file to transfer from/to
+//	\param reqSize number of bytes to transfer
+//	\param reqOffset position of the transfer in the file
+*/
+//----------------------------------------------------------------------
+AioRequest::AioRequest(int reqOp, OpenFile *reqFile, int reqSize, int reqOffset)
+{
+  op = reqOp;
+  file = reqFile;
+  size = reqSize;
+  offset = reqOffset;
+  buffer = new char[size];
+  addr = 0;
+  result = 0;
+  done = false;
+  completion = new Condition((char *)"aio");
+  waiters = 0;
+  collected = false;
+}
+
+//----------------------------------------------------------------------
+// AioRequest::~AioRequest
+//!	Deallocate a request, which must be done and waited for by
+//	nobody
+//----------------------------------------------------------------------
+AioRequest::~AioRequest()
+{
+  ASSERT(done && waiters == 0);
+  delete [] buffer;
+  delete completion;
+}
+
+//----------------------------------------------------------------------
+// AioManager::AioManager
+/*!	Create the I/O thread. It belongs to process owner for the
+//	accounting of its time, and only runs kernel code.
+//
+//	\param owner the process of the I/O thread
+*/
+//----------------------------------------------------------------------
+AioManager::AioManager(Process *owner)
+{
+  running = NULL;
+  work = new Semaphore((char *)"aio work", 0);
+  completed = new Condition((char *)"aio completed");
+  numRequests = 0;
+  numBytes = 0;
+  busyTicks = 0;
+  worker = new Thread((char *)"aio");
+  if (worker->StartKernel(owner, Worker, (int64_t)this) != NO_ERROR) {
+    fprintf(stderr, "Nachos boot error: cannot start the I/O thread\n");
+    exit(ERROR);
+  }
+}
+
+//----------------------------------------------------------------------
+// AioManager::~AioManager
+/*!	Deallocate the engine. Nachos is halting: the I/O thread is
+//	blocked and will never run again.
+*/
+//----------------------------------------------------------------------
+AioManager::~AioManager()
+{
+  delete work;
+  delete completed;
+}
+
+//----------------------------------------------------------------------
+// AioManager::Submit
+/*!	Queue a request for the I/O thread. The caller keeps the CPU.
+//
+//	\param request the request, filled in by the caller
+*/
+//----------------------------------------------------------------------
+void
+AioManager::Submit(AioRequest *request)
+{
+  DEBUG('f', (char *)"AIO: queue %s of %d bytes at %d in %s\n",
+	(request->op == AIO_OP_READ) ? "read" : "write", request->size,
+	request->offset, request->file->GetName());
+  pending.Append(request);
+  work->V();
+}
+
+//----------------------------------------------------------------------
+// AioManager::Wait
+/*!	Block until a request is done. Several threads may wait for
+//	the same request: the one which collects it first cannot delete
+//	it while the others are still waking up, so the last of them
+//	deletes it (see Release).
+//
+//	\param request a submitted request, which may be deleted on
+//	       return if another thread collected it meanwhile
+*/
+//----------------------------------------------------------------------
+void
+AioManager::Wait(AioRequest *request)
+{
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  request->waiters++;
+  while (!request->done)
+    request->completion->Wait();
+  bool last = (--request->waiters == 0 && request->collected);
+  g_machine->interrupt->SetStatus(oldLevel);
+  if (last)
+    delete request;
+}
+
+//----------------------------------------------------------------------
+// AioManager::Release
+/*!	Delete a request whose result was collected, unless threads
+//	are still in Wait for it: the last of them deletes it.
+//
+//	\param request a done request, removed from the object table
+*/
+//----------------------------------------------------------------------
+void
+AioManager::Release(AioRequest *request)
+{
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  request->collected = true;
+  bool last = (request->waiters == 0);
+  g_machine->interrupt->SetStatus(oldLevel);
+  if (last)
+    delete request;
+}
+
+//----------------------------------------------------------------------
+// AioManager::Drain
+/*!	Block until no request uses a file, so that it can be closed.
+//
+//	\param file the file to be closed
+*/
+//----------------------------------------------------------------------
+void
+AioManager::Drain(OpenFile *file)
+{
+  // Check and wait atomically, not to miss the end of the last request
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  while (Uses(file))
+    completed->Wait();
+  g_machine->interrupt->SetStatus(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// AioManager::Print
+//!	Print the number of requests and bytes transferred
+//----------------------------------------------------------------------
+void
+AioManager::Print()
+{
+  printf("Asynchronous I/O: %" PRIu64 " requests, %" PRIu64
+	 " bytes, busy %" PRIu64 " cycles\n",
+	 numRequests, numBytes, (uint64_t)busyTicks);
+}
+
+//----------------------------------------------------------------------
+// AioManager::Uses
+/*!	Check whether a pending or running request uses a file
+//
+//	\param file an open file
+*/
+//----------------------------------------------------------------------
+bool
+AioManager::Uses(OpenFile *file)
+{
+  if (running != NULL && running->file == file)
+    return true;
+  for (AioRequest *r = pending.First(); r != NULL; r = pending.Next(r))
+    if (r->file == file)
+      return true;
+  return false;
+}
+
+//----------------------------------------------------------------------
+// AioManager::Worker
+/*!	Body of the I/O thread: execute the requests in the order they
+//	were submitted, forever.
+//
+//	\param arg the AioManager
+*/
+//----------------------------------------------------------------------
+void
+AioManager::Worker(int64_t arg)
+{
+  AioManager *aio = (AioManager *)arg;
+
+  for (;;) {
+    aio->work->P();
+    AioRequest *request = aio->pending.Remove();
+    ASSERT(request != NULL);
+    aio->running = request;
+
+    Time start = g_stats->getTotalTicks();
+    if (request->op == AIO_OP_READ)
+      request->result = request->file->ReadAt(request->buffer, request->size,
+					      request->offset);
+    else
+      request->result = request->file->WriteAt(request->buffer, request->size,
+					       request->offset);
+    aio->busyTicks += g_stats->getTotalTicks() - start;
+    aio->numRequests++;
+    aio->numBytes += request->result;
+    DEBUG('f', (char *)"AIO: %d bytes transferred\n", request->result);
+
+    aio->running = NULL;
+    request->done = true;
+    request->completion->Broadcast();
+    aio->completed->Broadcast();
+  }
+}
@@ -0,0 +1,121 @@
+/*! \file aio.h
+    \brief Asynchronous file input/output
+
+    Read and Write block the calling thread for every sector of the
+    transfer. AioRead and AioWrite only queue the transfer, which is
+    done by a kernel I/O thread while the calling thread goes on
+    computing; the program collects the result later with AioWait
+    (blocking) or AioPoll (non-blocking).
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef AIO_H
+#define AIO_H
+
+#include "kernel/copyright.h"
+#include "kernel/system.h"
+#include "utility/queue.h"
+
+class OpenFile;
+class Process;
+class Semaphore;
+class Condition;
+
+//! Operations of an asynchronous request
+#define AIO_OP_READ  0
+#define AIO_OP_WRITE 1
+
+/*! \brief An asynchronous transfer between a file and a kernel buffer
+//
+// The I/O thread runs in its own address space, so it never touches
+// the program memory: the data to write is copied into the buffer
+// when the request is queued, and the data read is copied to the
+// program when it collects the request.
+*/
+class AioRequest {
+public:
+  AioRequest(int op, OpenFile *file, int size, int offset);
+  ~AioRequest();
+
+  int op;               //!< AIO_OP_READ or AIO_OP_WRITE
+  OpenFile *file;       //!< File to transfer from/to
+  char *buffer;         //!< Kernel copy of the data
+  int size;             //!< Number of bytes to transfer
+  int offset;           //!< Position of the transfer in the file
+  uint64_t addr;        //!< Program buffer (read requests)
+  int result;           //!< Number of bytes transferred, once done
+  bool done;            //!< true once the transfer is over
+  Condition *completion;//!< Broadcast by the I/O thread once done
+  int waiters;          //!< Number of threads in Wait
+  bool collected;       //!< true once a thread collected the result
+  QueueLink link;       //!< Link in the queue of pending requests
+};
+
+/*! \brief Defines the asynchronous I/O engine
+//
+// Requests are executed one at a time, in the order they were
+// submitted, by a kernel thread started at boot time.
+//
+//	Submit(request) -- queue a request, return at once
+//
+//	Wait(request) -- block until the request is done
+//
+//	Release(request) -- delete a collected request, or leave it to
+//	        the last thread still in Wait
+//
+//	Drain(file) -- block until no request uses file (called before
+//	        the file is closed)
+*/
+class AioManager {
+public:
+  //! Start the I/O thread, attached to process owner
+  AioManager(Process *owner);
+  ~AioManager();
+
+  //! Queue a request for the I/O thread
+  void Submit(AioRequest *request);
+
+  //! Wait for the end of a request
+  void Wait(AioRequest *request);
+
+  //! Delete a collected request once no thread waits for it
+  void Release(AioRequest *request);
+
+  //! Wait for the end of all the requests using a file
+  void Drain(OpenFile *file);
+
+  //! Print the number of requests and bytes transferred
+  void Print();
+
+private:
+  //! Body of the I/O thread
+  static void Worker(int64_t arg);
+
+  //! true if a pending or running request uses file
+  bool Uses(OpenFile *file);
+
+  Queue<AioRequest, &AioRequest::link> pending; //!< Requests to execute
+  AioRequest *running;    //!< Request being executed, NULL if none
+  Semaphore *work;        //!< Number of pending requests
+  Condition *completed;   //!< Broadcast at the end of each request
+  Thread *worker;         //!< The I/O thread
+  uint64_t numRequests;   //!< Number of executed requests
+  uint64_t numBytes;      //!< Number of bytes transferred
+  Time busyTicks;         //!< Time spent executing requests
+};
+
+#endif // AIO_H
@@ -0,0 +1,184 @@
+/*! \file alarm.cc
+//  \brief Routines to put threads to sleep until a given date
+//
+//	Pending interrupts cannot be cancelled: an interrupt may fire
+//	after the waiter it was scheduled for has been removed. The
+//	handler then finds nothing to do, and schedules the interrupt
+//	of the next waiter if needed.
+//
+//	The list of waiters may be long: it is walked by a deferred
+//	work (see softirq.h) rather than by the interrupt handler,
+//	interrupts being disabled only for one waiter at a time.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include <limits.h>
+
+#include "kernel/alarm.h"
+#include "kernel/scheduler.h"
+#include "kernel/synch.h"
+#include "kernel/thread.h"
+#include "machine/machine.h"
+#include "utility/stats.h"
+
+//----------------------------------------------------------------------
+// Alarm::Alarm
+//!	Initialize an alarm without waiters
+//----------------------------------------------------------------------
+Alarm::Alarm() : expireWork(Expire, (int64_t)this)
+{
+  armedAt = 0;
+}
+
+//----------------------------------------------------------------------
+// Alarm::SleepUntil
+/*!	Block the current thread until date when. Returns at once if
+//	this date has already come.
+//
+//	\param when date (in cycles, see Statistics::getTotalTicks)
+*/
+//----------------------------------------------------------------------
+void
+Alarm::SleepUntil(Time when)
+{
+  AlarmWaiter waiter;
+
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  if (when > g_stats->getTotalTicks()) {
+    waiter.thread = g_current_thread;
+    waiter.when = when;
+    waiter.sema = NULL;
+    Add(&waiter);
+    g_current_thread->Sleep();
+  }
+  g_machine->interrupt->SetStatus(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Alarm::Add
+/*!	Register a waiter, to be woken up at date waiter->when. If
+//	waiter->sema is not NULL, the thread is blocked in
+//	Semaphore::TimedP, and is only woken up if it is still waiting
+//	for the semaphore.
+//
+//	\param waiter the waiter, with thread, when and sema filled in
+*/
+//----------------------------------------------------------------------
+void
+Alarm::Add(AlarmWaiter *waiter)
+{
+  ASSERT(g_machine->interrupt->GetStatus() == INTERRUPTS_OFF);
+  DEBUG('t', (char *)"Thread \"%s\" sleeps until %" PRIu64 "\n",
+	waiter->thread->GetName(), (uint64_t)waiter->when);
+
+  waiter->expired = false;
+  AlarmWaiter *next = waiters.First();
+  while (next != NULL && next->when <= waiter->when)
+    next = waiters.Next(next);
+  if (next != NULL)
+    waiters.InsertBefore(waiter, next);
+  else
+    waiters.Append(waiter);
+  Arm();
+}
+
+//----------------------------------------------------------------------
+// Alarm::Remove
+/*!	Forget a waiter woken up by something else than the alarm
+//
+//	\param waiter a waiter registered by Add
+*/
+//----------------------------------------------------------------------
+void
+Alarm::Remove(AlarmWaiter *waiter)
+{
+  ASSERT(g_machine->interrupt->GetStatus() == INTERRUPTS_OFF);
+  waiters.RemoveItem(waiter);
+}
+
+//----------------------------------------------------------------------
+// Alarm::Arm
+/*!	Schedule an interrupt at the date of the first waiter, unless
+//	one is already scheduled at this date or before.
+*/
+//----------------------------------------------------------------------
+void
+Alarm::Arm()
+{
+  AlarmWaiter *first = waiters.First();
+  if (first == NULL || (armedAt != 0 && armedAt <= first->when))
+    return;
+
+  // A date too far away is reached in several steps
+  Time now = g_stats->getTotalTicks();
+  Time delay = (first->when > now) ? first->when - now : 1;
+  if (delay > INT_MAX)
+    delay = INT_MAX;
+  armedAt = now + delay;
+  g_machine->interrupt->Schedule(Handler, (int64_t)this, (int)delay, ALARM_INT);
+}
+
+//----------------------------------------------------------------------
+// Alarm::Handler
+/*!	Interrupt handler of the alarm: leave the wake up of the threads
+//	to the softirq thread.
+//
+//	\param arg the Alarm
+*/
+//----------------------------------------------------------------------
+void
+Alarm::Handler(int64_t arg)
+{
+  Alarm *alarm = (Alarm *)arg;
+
+  if (alarm->armedAt <= g_stats->getTotalTicks())
+    alarm->armedAt = 0;
+  g_softirq->Raise(&alarm->expireWork);
+}
+
+//----------------------------------------------------------------------
+// Alarm::Expire
+/*!	Deferred work of the alarm: wake up the threads whose date has
+//	come, then schedule the next interrupt. Runs with interrupts
+//	enabled, in the softirq thread.
+//
+//	\param arg the Alarm
+*/
+//----------------------------------------------------------------------
+void
+Alarm::Expire(int64_t arg)
+{
+  Alarm *alarm = (Alarm *)arg;
+
+  for (;;) {
+    IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+    AlarmWaiter *waiter = alarm->waiters.First();
+    if (waiter == NULL || waiter->when > g_stats->getTotalTicks()) {
+      alarm->Arm();
+      g_machine->interrupt->SetStatus(oldLevel);
+      return;
+    }
+    alarm->waiters.RemoveItem(waiter);
+    // A thread in TimedP may have got the semaphore in the meantime
+    if (waiter->sema == NULL || waiter->sema->Cancel(waiter->thread)) {
+      waiter->expired = true;
+      DEBUG('t', (char *)"Alarm wakes up thread \"%s\"\n",
+	    waiter->thread->GetName());
+      g_scheduler->ReadyToRun(waiter->thread);
+    }
+    g_machine->interrupt->SetStatus(oldLevel);
+  }
+}
@@ -0,0 +1,86 @@
+/*! \file alarm.h
+    \brief Timed waits of kernel threads
+
+    The alarm keeps the threads sleeping until a given date, sorted
+    by date, and wakes them up from an interrupt scheduled at the
+    earliest date. When all threads sleep, Interrupt::Idle advances
+    the simulated time directly to this interrupt.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef ALARM_H
+#define ALARM_H
+
+#include "kernel/copyright.h"
+#include "kernel/system.h"
+#include "kernel/softirq.h"
+#include "utility/queue.h"
+
+class Semaphore;
+class Thread;
+
+/*! \brief A thread waiting for a date
+
+    Allocated on the kernel stack of the waiting thread, for the
+    time it waits.
+*/
+typedef struct {
+  Thread *thread;     //!< The waiting thread
+  Time when;          //!< Date the thread must be woken up at
+  Semaphore *sema;    //!< Semaphore waited for (TimedP), NULL if none
+  bool expired;       //!< true if the thread was woken up by the alarm
+  QueueLink link;     //!< Link in the list of the alarm
+} AlarmWaiter;
+
+/*! \brief Defines the alarm clock of the kernel
+//
+//	SleepUntil(when) -- block the current thread until date when
+//
+//	Add(waiter) -- wake waiter->thread up at date waiter->when,
+//	        unless it is removed before (used by Semaphore::TimedP)
+//
+//	Remove(waiter) -- forget a waiter
+*/
+class Alarm {
+public:
+  Alarm();
+
+  //! Block the current thread until date when
+  void SleepUntil(Time when);
+
+  //! Register a waiter (interrupts must be disabled)
+  void Add(AlarmWaiter *waiter);
+
+  //! Forget a waiter, if it is still registered (interrupts must be disabled)
+  void Remove(AlarmWaiter *waiter);
+
+private:
+  //! Interrupt handler: defer the wake up of the threads to Expire
+  static void Handler(int64_t arg);
+
+  //! Wake up the threads whose date has come (deferred work)
+  static void Expire(int64_t arg);
+
+  //! Schedule an interrupt at the earliest date, if needed
+  void Arm();
+
+  Queue<AlarmWaiter, &AlarmWaiter::link> waiters; //!< Sorted by date
+  Time armedAt;       //!< Date of the next alarm interrupt, 0 if none
+  DeferredWork expireWork; //!< Raised by the handler, executes Expire
+};
+
+#endif // ALARM_H
@@ -28,58 +28,2100 @@
  * (see see <http://www.gnu.org/licenses/>).
  * -----------------------------------------------------
 */ 
+#include <limits.h>
+
 #include "machine/machine.h"
 #include "kernel/msgerror.h"
 #include "kernel/system.h"
 #include "userlib/syscall.h"
 #include "kernel/synch.h"
+#include "kernel/futex.h"
+#include "kernel/aio.h"
+#include "kernel/alarm.h"
+#include "kernel/pipe.h"
+#include "kernel/port.h"
+#include "kernel/shm.h"
+#include "kernel/systable.h"
+#include "kernel/waitany.h"
+#include "kernel/roi.h"
 #include "drivers/drvACIA.h"
 #include "drivers/drvConsole.h"
 #include "filesys/oftable.h"
 #include "vm/pagefaultmanager.h"
+#include "vm/faultprof.h"
+
+// Layout of the syscall ring structures in user memory (Nachos_Ring,
+// Nachos_RingSqe and Nachos_RingCqe, see syscall.h)
+#define RING_SQ_HEAD_OFFSET     0
+#define RING_SQ_TAIL_OFFSET     4
+#define RING_CQ_HEAD_OFFSET     8
+#define RING_CQ_TAIL_OFFSET    12
+#define RING_ENTRIES_OFFSET    16
+#define RING_SQES_OFFSET       24
+#define RING_CQES_OFFSET       32
+#define RING_SQE_SIZE          32
+#define RING_SQE_OP_OFFSET      0
+#define RING_SQE_LEN_OFFSET     4
+#define RING_SQE_ID_OFFSET      8
+#define RING_SQE_ADDR_OFFSET   16
+#define RING_SQE_DATA_OFFSET   24
+#define RING_CQE_SIZE          16
+#define RING_CQE_DATA_OFFSET    0
+#define RING_CQE_RESULT_OFFSET  8
+
+// Layout of a Nachos_Time in the user memory
+#define TIME_SECONDS_OFFSET     0
+#define TIME_NANOS_OFFSET       8
+
+// Layout of a Nachos_IoVec in the user memory
+#define IOVEC_SIZE             16
+#define IOVEC_BASE_OFFSET       0
+#define IOVEC_LEN_OFFSET        8
+
+//----------------------------------------------------------------------
+// GetLengthParam
+/*! Returns the length of a string stored in the machine memory,
+//    including the '\0' terminal
+//
+// \param addr is the memory address of the string */
+//----------------------------------------------------------------------
+static int GetLengthParam(int addr) {
+   int i=0;
+   uint64_t c=1; // Non nul value to start scanning the string
+   
+   // Scan the string until the null character is found
+   while (c != 0) {
+     g_machine->mmu->ReadMem(addr++,1,&c);
+     i++;
+   }
+   return i+1;
+ }
+
+//----------------------------------------------------------------------
+// GetStringParam
+/*!	Copies a string from the machine memory
+//
+//	\param addr is the memory address of the string
+//	\param dest is where the string is going to be copied
+//      \param maxlen maximum length of the string to copy in dest,
+//        including the trailing '\0' 
+*/
+//----------------------------------------------------------------------
+static void GetStringParam(uint64_t addr,char *dest,int maxlen) {
+   int i=0;
+   uint64_t c=1; // Non nul value to start scanning the string
+   
+   while ((c != 0) && (i < maxlen)) {
+     // Read a character from the machine memory
+     g_machine->mmu->ReadMem(addr++,1,&c);
+     // Put it in the kernel memory
+     dest[i++] = (char)c;
+   }
+   // Force a \0 at the end
+   dest[maxlen-1]='\0';
+ }
+
+//! Longest string argument printed by the system call trace
+#define TRACE_STRLEN 32
+
+//----------------------------------------------------------------------
+// FormatSyscall
+/*!	Prints a system call as the program wrote it, with the values of
+//	its arguments (see systable.h), for the 'y' debug flag
+//
+//	\param type is the system call number
+//	\param buf is where to print the call
+//	\param size is the size of buf
+*/
+//----------------------------------------------------------------------
+static void FormatSyscall(int type, char *buf, int size) {
+  const char *args = (type >= 0 && type < NUM_SYSCALLS) ? g_syscall_table[type].args : "";
+  int n = snprintf(buf,size,"%s(",SyscallName(type));
+
+  for (int i=0;args[i]!='\0' && n<size;i++) {
+    int64_t val = g_machine->ReadIntRegister(10+i);
+    const char *sep = (i > 0) ? ", " : "";
+    if (args[i] == 's') {
+      char str[TRACE_STRLEN];
+      GetStringParam(val,str,TRACE_STRLEN);
+      n += snprintf(buf+n,size-n,"%s\"%s\"",sep,str);
+    }
+    else if (args[i] == 'x')
+      n += snprintf(buf+n,size-n,"%s0x%" PRIx64 "",sep,(uint64_t)val);
+    else
+      n += snprintf(buf+n,size-n,"%s%" PRId64 "",sep,val);
+  }
+  if (n < size)
+    snprintf(buf+n,size-n,")");
+}
+
+//----------------------------------------------------------------------
+// DoOpen
+/*!	Opens a file. Shared by the Open system call and the syscall
+//	ring (as are the other Do* functions below), which all set the
+//	error message of the calling thread.
+//
+//	\param addr is the memory address of the file name
+//	\return the openfile identifier, 0 on error
+*/
+//----------------------------------------------------------------------
+static int DoOpen(uint64_t addr) {
+  int ret=0;
+  // Get the file name
+  int sizep = GetLengthParam(addr);
+  char ch[sizep];
+  GetStringParam(addr,ch,sizep);
+  // Try to open the file
+  OpenFile *file = g_open_file_table->Open(ch);
+  if (file == NULL) {
+    g_syscall_error->SetMsg(ch,OPENFILE_ERROR);
+  }
+  else {
+    ret = g_object_addrs->AddObject(file,FILE_TYPE);
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+  return ret;
+}
+
+//----------------------------------------------------------------------
+// ReadBuffer
+/*!	Reads in a file or the console into a kernel buffer
+//
+//	\param buffer is the kernel buffer
+//	\param size is the requested size
+//	\param f is the openfile identifier, or 0 (console)
+//	\return the number of bytes read, ERROR on error
+*/
+//----------------------------------------------------------------------
+static int ReadBuffer(char *buffer, int size, int64_t f) {
+  char msg[MAXSTRLEN];
+  int numread;
+  Pipe *pipe;
+
+  // The standard input may be redirected to a pipe
+  if (f == CONSOLE_INPUT)
+    pipe = g_current_thread->GetProcessOwner()->stdinPipe;
+  else
+    pipe = (Pipe *)g_object_addrs->SearchObject(f,PIPE_READ_TYPE);
+
+  // Read in a pipe, holding a reference on its read end: the pipe
+  // must outlive the read if the identifiers are closed meanwhile
+  if (pipe) {
+    pipe->Open(PIPE_READ_END);
+    numread = pipe->Read(buffer,size);
+    Pipe::Release(pipe,PIPE_READ_END);
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+  // Read in a file
+  else if (f != CONSOLE_INPUT) {
+    OpenFile *file = (OpenFile *)g_object_addrs->SearchObject(f,FILE_TYPE);
+    if (file) {
+      numread = file->Read(buffer,size);
+      g_syscall_error->SetMsg((char*)"",NO_ERROR);
+    }
+    else {
+      numread = ERROR;
+      sprintf(msg,"%" PRId64 "",f);
+      g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
+    }
+  }
+  // Read on the console
+  else {
+    g_console_driver->GetString(buffer,size);
+    DEBUG('e', (char*)"Console read. We have %s of size %d\n", buffer, size);
+    numread = size;
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+  return numread;
+}
+
+//----------------------------------------------------------------------
+// WriteBuffer
+/*!	Writes from a kernel buffer in a file or at the console
+//
+//	\param buffer is the kernel buffer
+//	\param size is the number of bytes to write
+//	\param f is the openfile identifier, or 1 (console)
+//	\return the number of bytes written, ERROR on error
+*/
+//----------------------------------------------------------------------
+static int WriteBuffer(char *buffer, int size, int64_t f) {
+  char msg[MAXSTRLEN];
+  int numwrite;
+  Pipe *pipe;
+
+  // The standard output may be redirected to a pipe
+  if (f == CONSOLE_OUTPUT)
+    pipe = g_current_thread->GetProcessOwner()->stdoutPipe;
+  else
+    pipe = (Pipe *)g_object_addrs->SearchObject(f,PIPE_WRITE_TYPE);
+
+  // Write in a pipe, holding a reference on its write end (see
+  // ReadBuffer)
+  if (pipe) {
+    pipe->Open(PIPE_WRITE_END);
+    numwrite = pipe->Write(buffer,size);
+    Pipe::Release(pipe,PIPE_WRITE_END);
+    if (numwrite == ERROR) {
+      sprintf(msg,"%" PRId64 "",f);
+      g_syscall_error->SetMsg(msg,BROKEN_PIPE);
+    }
+    else
+      g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+  // Write in a file
+  else if (f > CONSOLE_OUTPUT) {
+    OpenFile *file = (OpenFile *)g_object_addrs->SearchObject(f,FILE_TYPE);
+    if (file) {
+      //write in file
+      numwrite = file->Write(buffer,size);
+      g_syscall_error->SetMsg((char*)"",NO_ERROR);
+    }
+    else {
+      numwrite = ERROR;
+      sprintf(msg,"%" PRId64 "",f);
+      g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
+    }
+  }
+  // write at the console
+  else {
+    if (f==CONSOLE_OUTPUT) {
+      g_console_driver->PutString(buffer,size);
+      numwrite = size;
+      g_syscall_error->SetMsg((char*)"",NO_ERROR);
+    }
+    else {
+      numwrite = ERROR;
+      sprintf(msg,"%" PRId64 "",f);
+      g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
+    }
+  }
+  return numwrite;
+}
+
+//----------------------------------------------------------------------
+// DoRead
+/*!	Reads in a file or the console into the machine memory
+//
+//	\param addr is the memory address of the buffer
+//	\param size is the requested size
+//	\param f is the openfile identifier, or 0 (console)
+//	\return the number of bytes read, ERROR on error
+*/
+//----------------------------------------------------------------------
+static int DoRead(uint64_t addr, int size, int64_t f) {
+  char buffer[size];
+  int numread = ReadBuffer(buffer,size,f);
+  for (int i=0;i<numread;i++)
+    { //copy the buffer into the emulator memory
+      g_machine->mmu->WriteMem(addr++,1,buffer[i]);
+    }
+  return numread;
+}
+
+//----------------------------------------------------------------------
+// DoWrite
+/*!	Writes from the machine memory in a file or at the console
+//
+//	\param addr is the memory address of the buffer
+//	\param size is the number of bytes to write
+//	\param f is the openfile identifier, or 1 (console)
+//	\return the number of bytes written, ERROR on error
+*/
+//----------------------------------------------------------------------
+static int DoWrite(uint64_t addr, int size, int64_t f) {
+  uint64_t c;
+  char buffer [size];
+  for (int i=0;i<size;i++) {
+    g_machine->mmu->ReadMem(addr++,1,&c);
+    buffer[i] = c;
+  }
+  return WriteBuffer(buffer,size,f);
+}
+
+//----------------------------------------------------------------------
+// GetIoVec
+/*!	Reads an array of Nachos_IoVec from the machine memory, and
+//	checks it
+//
+//	\param addr is the memory address of the array
+//	\param count is the number of elements of the array
+//	\param iov is where to store the elements
+//	\return the total size of the buffers, ERROR on error
+*/
+//----------------------------------------------------------------------
+static int GetIoVec(uint64_t addr, int count, Nachos_IoVec *iov) {
+  char msg[MAXSTRLEN];
+  uint64_t base, len;
+  int total = 0;
+
+  if (count < 0 || count > NACHOS_IOV_MAX) {
+    sprintf(msg,"%d buffers",count);
+    g_syscall_error->SetMsg(msg,INVALID_SIZE);
+    return ERROR;
+  }
+  for (int i=0;i<count;i++) {
+    uint64_t entry = addr + i*IOVEC_SIZE;
+    if (!g_machine->mmu->ReadMem(entry+IOVEC_BASE_OFFSET,8,&base)
+	|| !g_machine->mmu->ReadMem(entry+IOVEC_LEN_OFFSET,4,&len)) {
+      sprintf(msg,"0x%" PRIx64 "",entry);
+      g_syscall_error->SetMsg(msg,INVALID_USER_ADDRESS);
+      return ERROR;
+    }
+    iov[i].base = (char *)base;
+    iov[i].len = (int)len;
+    // The total is the size of a kernel buffer: it must fit an int
+    if (iov[i].len < 0 || iov[i].len > INT_MAX - total) {
+      sprintf(msg,"%d",iov[i].len);
+      g_syscall_error->SetMsg(msg,INVALID_SIZE);
+      return ERROR;
+    }
+    total += iov[i].len;
+  }
+  return total;
+}
+
+//----------------------------------------------------------------------
+// DoReadv
+/*!	Reads in a file or the console into several buffers of the
+//	machine memory, with a single read of the file
+//
+//	\param addr is the memory address of the Nachos_IoVec array
+//	\param count is the number of buffers
+//	\param f is the openfile identifier, or 0 (console)
+//	\return the number of bytes read, ERROR on error
+*/
+//----------------------------------------------------------------------
+static int DoReadv(uint64_t addr, int count, int64_t f) {
+  Nachos_IoVec iov[NACHOS_IOV_MAX];
+  int total = GetIoVec(addr,count,iov);
+  if (total == ERROR)
+    return ERROR;
+
+  char *buffer = new char[total];
+  int numread = ReadBuffer(buffer,total,f);
+
+  // Fill in the buffers in order, up to the number of bytes read
+  int pos = 0;
+  for (int i=0;i<count && pos<numread;i++) {
+    uint64_t dest = (uint64_t)iov[i].base;
+    for (int j=0;j<iov[i].len && pos<numread;j++)
+      g_machine->mmu->WriteMem(dest++,1,buffer[pos++]);
+  }
+  delete [] buffer;
+  return numread;
+}
+
+//----------------------------------------------------------------------
+// DoWritev
+/*!	Writes from several buffers of the machine memory in a file or
+//	at the console, with a single write of the file
+//
+//	\param addr is the memory address of the Nachos_IoVec array
+//	\param count is the number of buffers
+//	\param f is the openfile identifier, or 1 (console)
+//	\return the number of bytes written, ERROR on error
+*/
+//----------------------------------------------------------------------
+static int DoWritev(uint64_t addr, int count, int64_t f) {
+  Nachos_IoVec iov[NACHOS_IOV_MAX];
+  int total = GetIoVec(addr,count,iov);
+  if (total == ERROR)
+    return ERROR;
+
+  // Gather the buffers
+  char *buffer = new char[total];
+  uint64_t c;
+  int pos = 0;
+  for (int i=0;i<count;i++) {
+    uint64_t src = (uint64_t)iov[i].base;
+    for (int j=0;j<iov[i].len;j++) {
+      g_machine->mmu->ReadMem(src++,1,&c);
+      buffer[pos++] = c;
+    }
+  }
+  int numwrite = WriteBuffer(buffer,total,f);
+  delete [] buffer;
+  return numwrite;
+}
+
+//----------------------------------------------------------------------
+// DoClose
+/*!	Closes a file
+//
+//	\param fid is the openfile identifier
+//	\return NO_ERROR, or ERROR if fid is not an open file
+*/
+//----------------------------------------------------------------------
+static int DoClose(int64_t fid) {
+  char msg[MAXSTRLEN];
+
+  // Close an end of a pipe
+  Pipe *pipe = (Pipe *)g_object_addrs->SearchObject(fid,PIPE_READ_TYPE);
+  int end = PIPE_READ_END;
+  if (pipe == NULL) {
+    pipe = (Pipe *)g_object_addrs->SearchObject(fid,PIPE_WRITE_TYPE);
+    end = PIPE_WRITE_END;
+  }
+  if (pipe) {
+    g_object_addrs->RemoveObject(fid);
+    Pipe::Release(pipe,end);
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+    return NO_ERROR;
+  }
+
+  OpenFile *file = (OpenFile *)g_object_addrs->SearchObject(fid,FILE_TYPE);
+  if (file) {
+    // Asynchronous requests may still use the file
+    g_aio->Drain(file);
+    if (g_object_addrs->SearchObject(fid,FILE_TYPE) != file) {
+      // Closed by another thread meanwhile
+      sprintf(msg,"%" PRId64 "",fid);
+      g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
+      return ERROR;
+    }
+    g_open_file_table->Close(file->GetName());
+    g_object_addrs->RemoveObject(fid);
+    delete file;
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+    return NO_ERROR;
+  }
+  sprintf(msg,"%" PRId64 "",fid);
+  g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
+  return ERROR;
+}
+
+//----------------------------------------------------------------------
+// DoP
+/*!	Does the operation P on a semaphore
+//
+//	\param sid is the semaphore identifier
+//	\return NO_ERROR, or ERROR if sid is not a semaphore
+*/
+//----------------------------------------------------------------------
+static int DoP(int64_t sid) {
+  char msg[MAXSTRLEN];
+  Semaphore *sema = (Semaphore *)g_object_addrs->SearchObject(sid,SEMAPHORE_TYPE);
+  if (sema) {
+    sema->P();
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+    return NO_ERROR;
+  }
+  sprintf(msg,"%" PRId64 "",sid);
+  g_syscall_error->SetMsg(msg,INVALID_SEMAPHORE_ID);
+  return ERROR;
+}
+
+//----------------------------------------------------------------------
+// DoV
+/*!	Does the operation V on a semaphore
+//
+//	\param sid is the semaphore identifier
+//	\return NO_ERROR, or ERROR if sid is not a semaphore
+*/
+//----------------------------------------------------------------------
+static int DoV(int64_t sid) {
+  char msg[MAXSTRLEN];
+  Semaphore *sema = (Semaphore *)g_object_addrs->SearchObject(sid,SEMAPHORE_TYPE);
+  if (sema) {
+    sema->V();
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+    return NO_ERROR;
+  }
+  sprintf(msg,"%" PRId64 "",sid);
+  g_syscall_error->SetMsg(msg,INVALID_SEMAPHORE_ID);
+  return ERROR;
+}
+
+//----------------------------------------------------------------------
+// DoWaitAny
+/*!	Blocks until one of several objects is ready (see WaitAny in
+//	syscall.h)
+//
+//	\param addr is the memory address of the array of identifiers
+//	\param count is the number of identifiers
+//	\return the index of the ready object, ERROR on error
+*/
+//----------------------------------------------------------------------
+static int DoWaitAny(uint64_t addr, int count) {
+  char msg[MAXSTRLEN];
+  int64_t ids[WAIT_ANY_MAX];
+
+  if (count <= 0 || count > WAIT_ANY_MAX) {
+    sprintf(msg,"%d objects",count);
+    g_syscall_error->SetMsg(msg,INVALID_SIZE);
+    return ERROR;
+  }
+  for (int i=0;i<count;i++) {
+    uint64_t entry = addr + i*sizeof(int64_t);
+    uint64_t id;
+    g_machine->mmu->ReadMem(entry,sizeof(int64_t),&id);
+    ids[i] = (int64_t)id;
+    if (!CanWaitFor(ids[i])) {
+      sprintf(msg,"%" PRId64 "",ids[i]);
+      g_syscall_error->SetMsg(msg,INVALID_WAIT_ID);
+      return ERROR;
+    }
+  }
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  return WaitForAny(ids,count);
+}
+
+//----------------------------------------------------------------------
+// DoRingSetup
+/*!	Registers the syscall ring of the current process (see
+//	Nachos_Ring in syscall.h)
+//
+//	\param addr is the memory address of the Nachos_Ring structure
+//	\param entries is the number of slots of each queue (power of 2)
+//	\return NO_ERROR, or ERROR if the ring is invalid
+*/
+//----------------------------------------------------------------------
+static int DoRingSetup(uint64_t addr, int entries) {
+  char msg[MAXSTRLEN];
+  Process *p = g_current_thread->GetProcessOwner();
+  uint64_t sqes, cqes;
+
+  if (entries <= 0 || (entries & (entries - 1)) != 0
+      || !g_machine->mmu->ReadMem(addr + RING_SQES_OFFSET, 8, &sqes)
+      || !g_machine->mmu->ReadMem(addr + RING_CQES_OFFSET, 8, &cqes)) {
+    sprintf(msg,"0x%" PRIx64 " (syscall ring)",addr);
+    g_syscall_error->SetMsg(msg,INVALID_USER_ADDRESS);
+    return ERROR;
+  }
+
+  // Both queues are initially empty
+  for (int off = 0; off < RING_ENTRIES_OFFSET; off += 4)
+    g_machine->mmu->WriteMem(addr + off, 4, 0);
+  g_machine->mmu->WriteMem(addr + RING_ENTRIES_OFFSET, 4, entries);
+
+  p->ringAddr = addr;
+  p->ringSqes = sqes;
+  p->ringCqes = cqes;
+  p->ringEntries = entries;
+  p->ringCqTail = 0;
+  p->ringCqReserved = 0;
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  return NO_ERROR;
+}
+
+//----------------------------------------------------------------------
+// DoRingEnter
+/*!	Executes the requests queued in the submission queue of the
+//	syscall ring of the current process, in order, and posts a
+//	completion for each of them. Stops early when the completion
+//	queue is full. The heads and tails are updated after each
+//	request, so that a request blocking in P leaves a consistent
+//	ring behind it. The completion slot of a request is reserved
+//	before it executes: the threads of the process entering the
+//	ring meanwhile cannot take it.
+//
+//	\param toSubmit is the maximum number of requests to execute
+//	       (all queued requests if <= 0)
+//	\return the number of requests executed, or ERROR if no ring
+//	       is registered or the ring is not accessible
+*/
+//----------------------------------------------------------------------
+static int DoRingEnter(int toSubmit) {
+  Process *p = g_current_thread->GetProcessOwner();
+  uint64_t addr = p->ringAddr;
+  uint64_t sqHead, sqTail, cqHead;
+  uint32_t mask = p->ringEntries - 1;
+  int done = 0;
+
+  if (addr == 0) {
+    g_syscall_error->SetMsg((char*)"(no syscall ring)",INVALID_USER_ADDRESS);
+    return ERROR;
+  }
+
+  for (;;) {
+    if (toSubmit > 0 && done >= toSubmit)
+      break;
+    if (!g_machine->mmu->ReadMem(addr + RING_SQ_HEAD_OFFSET, 4, &sqHead)
+	|| !g_machine->mmu->ReadMem(addr + RING_SQ_TAIL_OFFSET, 4, &sqTail)
+	|| !g_machine->mmu->ReadMem(addr + RING_CQ_HEAD_OFFSET, 4, &cqHead))
+      return ERROR;
+    // Nothing left to submit, or no room for the completion. The
+    // kernel's own tail counts the completions posted by the other
+    // threads, the user's head may only be late (less room)
+    if ((uint32_t)sqHead == (uint32_t)sqTail
+	|| p->ringCqTail + p->ringCqReserved - (uint32_t)cqHead >= p->ringEntries)
+      break;
+    p->ringCqReserved++;
+
+    // Fetch the request
+    uint64_t sqe = p->ringSqes + (sqHead & mask) * RING_SQE_SIZE;
+    uint64_t op, len, id, buf, userData;
+    if (!g_machine->mmu->ReadMem(sqe + RING_SQE_OP_OFFSET, 4, &op)
+	|| !g_machine->mmu->ReadMem(sqe + RING_SQE_LEN_OFFSET, 4, &len)
+	|| !g_machine->mmu->ReadMem(sqe + RING_SQE_ID_OFFSET, 8, &id)
+	|| !g_machine->mmu->ReadMem(sqe + RING_SQE_ADDR_OFFSET, 8, &buf)
+	|| !g_machine->mmu->ReadMem(sqe + RING_SQE_DATA_OFFSET, 8, &userData)) {
+      p->ringCqReserved--;
+      return ERROR;
+    }
+    g_machine->mmu->WriteMem(addr + RING_SQ_HEAD_OFFSET, 4, sqHead + 1);
+
+    // Execute it
+    int64_t result;
+    switch (op) {
+    case RING_OP_READ:  result = DoRead(buf, (int32_t)len, id); break;
+    case RING_OP_WRITE: result = DoWrite(buf, (int32_t)len, id); break;
+    case RING_OP_OPEN:  result = DoOpen(buf); break;
+    case RING_OP_CLOSE: result = DoClose(id); break;
+    case RING_OP_P:     result = DoP(id); break;
+    case RING_OP_V:     result = DoV(id); break;
+    default:
+      result = ERROR;
+      g_syscall_error->SetMsg((char*)"(unknown syscall ring operation)",INC_ERROR);
+      break;
+    }
+    DEBUG('e', (char*)"Syscall ring: op %d, result %" PRId64 "\n", (int)op, result);
+
+    // Post its completion in the reserved slot: the first one not
+    // taken by the other threads meanwhile
+    uint32_t slot = p->ringCqTail++;
+    p->ringCqReserved--;
+    uint64_t cqe = p->ringCqes + (slot & mask) * RING_CQE_SIZE;
+    g_machine->mmu->WriteMem(cqe + RING_CQE_DATA_OFFSET, 8, userData);
+    g_machine->mmu->WriteMem(cqe + RING_CQE_RESULT_OFFSET, 8, result);
+    g_machine->mmu->WriteMem(addr + RING_CQ_TAIL_OFFSET, 4, p->ringCqTail);
+    done++;
+  }
+  return done;
+}
+
+//----------------------------------------------------------------------
+// GetTimeParam
+/*!	Reads a Nachos_Time from the machine memory, and converts it
+//	into cycles
+//
+//	\param addr is the memory address of the Nachos_Time
+//	\param ticks is where to store the number of cycles
+//	\return NO_ERROR, or ERROR if addr is not a valid Nachos_Time
+*/
+//----------------------------------------------------------------------
+static int GetTimeParam(uint64_t addr, Time *ticks) {
+  char msg[MAXSTRLEN];
+  uint64_t seconds, nanos;
+  if (!g_machine->mmu->ReadMem(addr+TIME_SECONDS_OFFSET,sizeof(int64_t),&seconds)
+      || !g_machine->mmu->ReadMem(addr+TIME_NANOS_OFFSET,sizeof(int64_t),&nanos)) {
+    sprintf(msg,"0x%" PRIx64 "",addr);
+    g_syscall_error->SetMsg(msg,INVALID_USER_ADDRESS);
+    return ERROR;
+  }
+  if ((int64_t)seconds < 0 || (int64_t)nanos < 0 || nanos >= 1000000000) {
+    sprintf(msg,"%" PRId64 "s %" PRId64 "ns",(int64_t)seconds,(int64_t)nanos);
+    g_syscall_error->SetMsg(msg,INVALID_SIZE);
+    return ERROR;
+  }
+  // Inverse of cycle_to_sec and cycle_to_nano (frequency in MHz)
+  *ticks = seconds*g_cfg->ProcessorFrequency*1000000
+    + nanos*g_cfg->ProcessorFrequency/1000;
+  return NO_ERROR;
+}
+
+//----------------------------------------------------------------------
+// TouchPages
+/*!	Reads a byte of each page of a buffer of the machine memory,
+//	so that the pages swapped out are brought back in memory
+//
+//	\param addr is the memory address of the buffer
+//	\param size is the size of the buffer
+*/
+//----------------------------------------------------------------------
+static void TouchPages(uint64_t addr, int size) {
+  uint64_t c;
+  for (int64_t off = 0; off < size; off += g_cfg->PageSize)
+    g_machine->mmu->ReadMem(addr+off,1,&c);
+}
+
+//----------------------------------------------------------------------
+// DoAioSubmit
+/*!	Queues an asynchronous read or write on a file
+//
+//	\param op AIO_OP_READ or AIO_OP_WRITE
+//	\param addr is the memory address of the buffer
+//	\param size is the number of bytes to transfer
+//	\param f is the openfile identifier (not the console)
+//	\param offset is the position of the transfer in the file
+//	\return the identifier of the request, ERROR on error
+*/
+//----------------------------------------------------------------------
+static int64_t DoAioSubmit(int op, uint64_t addr, int size, int64_t f,
+			   int offset) {
+  char msg[MAXSTRLEN];
+  OpenFile *file = (OpenFile *)g_object_addrs->SearchObject(f,FILE_TYPE);
+  if (file == NULL) {
+    sprintf(msg,"%" PRId64 "",f);
+    g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
+    return ERROR;
+  }
+  if (size < 0 || offset < 0) {
+    sprintf(msg,"%d at %d",size,offset);
+    g_syscall_error->SetMsg(msg,INVALID_SIZE);
+    return ERROR;
+  }
+
+  AioRequest *request = new AioRequest(op,file,size,offset);
+  request->addr = addr;
+  if (op == AIO_OP_WRITE) {
+    uint64_t c;
+    for (int i=0;i<size;i++) {
+      g_machine->mmu->ReadMem(addr++,1,&c);
+      request->buffer[i] = c;
+    }
+  }
+  g_aio->Submit(request);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  return g_object_addrs->AddObject(request,AIO_TYPE);
+}
+
+//----------------------------------------------------------------------
+// DoAioCollect
+/*!	Returns the result of an asynchronous request, and releases it.
+//	The data of a read request is copied into the program buffer.
+//
+//	\param id is the identifier of the request
+//	\param wait true to block until the request is done
+//	\return the number of bytes transferred, AIO_PENDING if wait is
+//	       false and the request is not done, ERROR on error
+*/
+//----------------------------------------------------------------------
+static int DoAioCollect(int64_t id, bool wait) {
+  char msg[MAXSTRLEN];
+  AioRequest *request = (AioRequest *)g_object_addrs->SearchObject(id,AIO_TYPE);
+  if (request == NULL) {
+    sprintf(msg,"%" PRId64 "",id);
+    g_syscall_error->SetMsg(msg,INVALID_AIO_ID);
+    return ERROR;
+  }
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  if (!request->done) {
+    if (!wait)
+      return AIO_PENDING;
+    g_aio->Wait(request);
+    // Another thread may have collected the request meanwhile, in
+    // which case it may be deleted: only compare the pointer
+    if (g_object_addrs->SearchObject(id,AIO_TYPE) != request) {
+      sprintf(msg,"%" PRId64 "",id);
+      g_syscall_error->SetMsg(msg,INVALID_AIO_ID);
+      return ERROR;
+    }
+  }
+
+  g_object_addrs->RemoveObject(id);
+  int result = request->result;
+  if (request->op == AIO_OP_READ) {
+    uint64_t addr = request->addr;
+    for (int i=0;i<result;i++)
+      g_machine->mmu->WriteMem(addr++,1,request->buffer[i]);
+  }
+  g_aio->Release(request);
+  return result;
+}
+
+//----------------------------------------------------------------------
+// SysHalt
+/*!	The halt system call. Stops Nachos.
+*/
+//----------------------------------------------------------------------
+static void SysHalt(int type) {
+  DEBUG('e', (char*)"Shutdown, initiated by user program.\n");
+  g_machine->interrupt->Halt(NO_ERROR);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysSysTime
+/*!	The systime system call. Gets the system time
+*/
+//----------------------------------------------------------------------
+static void SysSysTime(int type) {
+  DEBUG('e', (char*)"Systime call, initiated by user program.\n");
+  int addr=g_machine->ReadIntRegister(10);
+  uint64_t tick = g_stats->getTotalTicks();
+  uint32_t seconds = (uint32_t)
+    cycle_to_sec(tick,g_cfg->ProcessorFrequency);
+  uint32_t nanos =  (uint32_t)
+    cycle_to_nano(tick,g_cfg->ProcessorFrequency);
+  g_machine->mmu->WriteMem(addr+TIME_SECONDS_OFFSET,sizeof(int64_t),seconds);
+  g_machine->mmu->WriteMem(addr+TIME_NANOS_OFFSET,sizeof(int64_t),nanos);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysExit
+/*!	The exit system call
+//	Ends the calling thread
+*/
+//----------------------------------------------------------------------
+static void SysExit(int type) {
+  DEBUG('e', (char*)"Thread 0x%x %s exit call.\n", g_current_thread,g_current_thread->GetName());
+  ASSERT(g_current_thread->type == THREAD_TYPE);
+  g_current_thread->Finish();
+}
+
+//----------------------------------------------------------------------
+// SysExec
+/*!	The exec system call
+//	Creates a new process (thread+address space)
+*/
+//----------------------------------------------------------------------
+static void SysExec(int type) {
+  DEBUG('e', (char*)"Process: Exec call.\n");
+  int addr;
+  int size;
+  char name[MAXSTRLEN];
+  int error=NO_ERROR;
+
+  // Get the process name
+  addr = g_machine->ReadIntRegister(10);
+  size = GetLengthParam(addr);
+  char ch[size];
+  GetStringParam(addr,ch,size);
+  sprintf(name,"master thread of process %s",ch);
+  Process * p = new Process(ch, &error);
+  if (error != NO_ERROR) {
+    g_machine->WriteIntRegister(10,ERROR);
+    if (error == OUT_OF_MEMORY)
+      g_syscall_error->SetMsg((char*)"",error);
+    else
+      g_syscall_error->SetMsg(ch,error);
+    return;
+  }
+  // The new process inherits the standard input and output
+  Process *parent = g_current_thread->GetProcessOwner();
+  p->Redirect(parent->stdinPipe,parent->stdoutPipe);
+  Thread *ptThread = new Thread(name);
+  int32_t tid = g_object_addrs->AddObject(ptThread,THREAD_TYPE);
+  ptThread->SetId(tid);
+  error = ptThread->Start(p,
+			  p->addrspace->getCodeStartAddress64(),
+			  -1);
+  if (error != NO_ERROR) {
+    g_machine->WriteIntRegister(10,ERROR);
+    if (error == OUT_OF_MEMORY)
+      g_syscall_error->SetMsg((char*)"",error);
+    else
+      g_syscall_error->SetMsg(name,error);
+    return;
+  }
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  g_machine->WriteIntRegister(10,tid);
+}
+
+//----------------------------------------------------------------------
+// SysNewThread
+/*!	The newThread system call
+//	Create a new thread in the same address space
+*/
+//----------------------------------------------------------------------
+static void SysNewThread(int type) {
+  DEBUG('e', (char*)"Multithread: NewThread call.\n");
+  Thread *ptThread;
+  int name_addr;
+  int64_t fun;
+  int arg;
+  int err=NO_ERROR;
+  // Get the address of the string for the name of the thread
+  name_addr = g_machine->ReadIntRegister(10);
+  // Get the pointer to the function to be executed by the new thread
+  fun = g_machine->ReadIntRegister(11);
+  // Get the function parameters
+  arg = g_machine->ReadIntRegister(12);
+  // Build the name of the thread
+  int size = GetLengthParam(name_addr);
+  char thr_name[size];
+  GetStringParam(name_addr, thr_name, size);
+  //char *proc_name = g_current_thread->getProcessOwner()->getName();
+  // Finally start it
+  ptThread = new Thread(thr_name);
+  int32_t tid = g_object_addrs->AddObject(ptThread,THREAD_TYPE);
+  ptThread->SetId(tid);
+  err = ptThread->Start(g_current_thread->GetProcessOwner(),
+			fun, arg);
+  if (err != NO_ERROR) {
+    g_machine->WriteIntRegister(10,ERROR);
+    g_syscall_error->SetMsg((char*)"",err);
+  }
+  else {
+    g_machine->WriteIntRegister(10,tid);
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+}
+
+//----------------------------------------------------------------------
+// SysJoin
+/*!	The join system call
+//	Wait for the thread idThread to finish
+*/
+//----------------------------------------------------------------------
+static void SysJoin(int type) {
+  DEBUG('e', (char*)"Process or thread: Join call.\n");
+  int64_t tid;
+  Thread* ptThread;
+  tid = g_machine->ReadIntRegister(10);
+  ptThread = (Thread *)g_object_addrs->SearchObject(tid,THREAD_TYPE);
+  if (ptThread)
+    {
+      g_current_thread->Join(ptThread);
+      g_syscall_error->SetMsg((char*)"",NO_ERROR);
+      g_machine->WriteIntRegister(10,NO_ERROR);
+    }
+  else
+    // Thread already terminated (stale identifier) or call on an object
+    // that is not a thread
+    // Exit with no error code since we cannot separate the two cases
+    {
+      g_syscall_error->SetMsg((char*)"",NO_ERROR);
+      g_machine->WriteIntRegister(10,NO_ERROR);
+    }
+  DEBUG('e',(char*)"Fin Join");
+}
+
+//----------------------------------------------------------------------
+// SysYield
+/*!	The Yield system call
+*/
+//----------------------------------------------------------------------
+static void SysYield(int type) {
+  DEBUG('e', (char*)"Process or thread: Yield call.\n");
+  if(g_current_thread->type == THREAD_TYPE){
+    g_current_thread->Yield();
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+    g_machine->WriteIntRegister(10,NO_ERROR);
+  }
+  else{
+    g_syscall_error->SetMsg((char*)"", INVALID_SEMAPHORE_ID);
+    g_machine->WriteIntRegister(10,ERROR);
+  }
+}
+
+//----------------------------------------------------------------------
+// SysPError
+/*!	the PError system call
+//	print the last error message
+*/
+//----------------------------------------------------------------------
+static void SysPError(int type) {
+  DEBUG('e', (char*)"Debug: Perror call.\n");
+  int size;
+  int addr;
+  addr = g_machine->ReadIntRegister(10);
+  size = GetLengthParam(addr);
+  char ch[size];
+  GetStringParam(addr,ch,size);
+  g_syscall_error->PrintLastMsg(g_console_driver,ch);
+}
+
+//----------------------------------------------------------------------
+// SysCreate
+/*!	The create system call
+//	Create a new file in nachos file system
+*/
+//----------------------------------------------------------------------
+static void SysCreate(int type) {
+  DEBUG('e', (char*)"Filesystem: Create call.\n");
+  int addr;
+  int size;
+  int ret;
+  int sizep;
+  // Get the name and initial size of the new file
+  addr = g_machine->ReadIntRegister(10);
+  size = g_machine->ReadIntRegister(11);
+  sizep = GetLengthParam(addr);
+  char ch[sizep];
+  GetStringParam(addr,ch,sizep);
+  // Try to create it
+  int err = g_file_system->Create(ch,size);
+  if (err == NO_ERROR) {
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+    ret = NO_ERROR;
+  }
+  else {
+    ret = ERROR;
+    if (err == OUT_OF_DISK) g_syscall_error->SetMsg((char*)"",err);
+    else g_syscall_error->SetMsg(ch,err);
+  }
+  g_machine->WriteIntRegister(10,ret);
+}
+
+//----------------------------------------------------------------------
+// SysOpen
+/*!	The open system call
+//	Opens a file and returns an openfile identifier
+*/
+//----------------------------------------------------------------------
+static void SysOpen(int type) {
+  DEBUG('e', (char*)"Filesystem: Open call.\n");
+  g_machine->WriteIntRegister(10,DoOpen(g_machine->ReadIntRegister(10)));
+}
+
+//----------------------------------------------------------------------
+// SysRead
+/*!	The read system call
+//	Read in a file or the console
+*/
+//----------------------------------------------------------------------
+static void SysRead(int type) {
+  DEBUG('e', (char*)"Filesystem: Read call.\n");
+  // Buffer address, requested size and openfile number or 0 (console)
+  g_machine->WriteIntRegister(10,DoRead(g_machine->ReadIntRegister(10),
+					g_machine->ReadIntRegister(11),
+					g_machine->ReadIntRegister(12)));
+}
+
+//----------------------------------------------------------------------
+// SysWrite
+/*!	The write system call
+//	Write in a file or at the console
+*/
+//----------------------------------------------------------------------
+static void SysWrite(int type) {
+  DEBUG('e', (char*)"Filesystem: Write call.\n");
+  // Buffer address, size and openfile number or 1 (console)
+  g_machine->WriteIntRegister(10,DoWrite(g_machine->ReadIntRegister(10),
+					 g_machine->ReadIntRegister(11),
+					 g_machine->ReadIntRegister(12)));
+}
+
+//----------------------------------------------------------------------
+// SysReadv
+/*!	Read in a file or the console into several buffers
+*/
+//----------------------------------------------------------------------
+static void SysReadv(int type) {
+  DEBUG('e', (char*)"Filesystem: Readv call.\n");
+  g_machine->WriteIntRegister(10,DoReadv(g_machine->ReadIntRegister(10),
+					 g_machine->ReadIntRegister(11),
+					 g_machine->ReadIntRegister(12)));
+}
+
+//----------------------------------------------------------------------
+// SysWritev
+/*!	Write from several buffers in a file or at the console
+*/
+//----------------------------------------------------------------------
+static void SysWritev(int type) {
+  DEBUG('e', (char*)"Filesystem: Writev call.\n");
+  g_machine->WriteIntRegister(10,DoWritev(g_machine->ReadIntRegister(10),
+					  g_machine->ReadIntRegister(11),
+					  g_machine->ReadIntRegister(12)));
+}
+
+//----------------------------------------------------------------------
+// SysPipeCreate
+/*!	Create a pipe, and return the identifiers of its ends
+*/
+//----------------------------------------------------------------------
+static void SysPipeCreate(int type) {
+  DEBUG('e', (char*)"Filesystem: PipeCreate call.\n");
+  uint64_t addr = g_machine->ReadIntRegister(10);
+  Pipe *pipe = new Pipe();
+  int64_t rd = g_object_addrs->AddObject(pipe,PIPE_READ_TYPE);
+  int64_t wr = g_object_addrs->AddObject(pipe,PIPE_WRITE_TYPE);
+  pipe->Open(PIPE_READ_END);
+  pipe->Open(PIPE_WRITE_END);
+  g_machine->mmu->WriteMem(addr,sizeof(int64_t),rd);
+  g_machine->mmu->WriteMem(addr+sizeof(int64_t),sizeof(int64_t),wr);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  g_machine->WriteIntRegister(10,NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysRedirect
+/*!	Redirect the standard input and output to pipes
+*/
+//----------------------------------------------------------------------
+static void SysRedirect(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Filesystem: Redirect call.\n");
+  int64_t in = g_machine->ReadIntRegister(10);
+  int64_t out = g_machine->ReadIntRegister(11);
+  Pipe *inPipe = NULL;
+  Pipe *outPipe = NULL;
+  if (in != CONSOLE_INPUT)
+    inPipe = (Pipe *)g_object_addrs->SearchObject(in,PIPE_READ_TYPE);
+  if (out != CONSOLE_OUTPUT)
+    outPipe = (Pipe *)g_object_addrs->SearchObject(out,PIPE_WRITE_TYPE);
+  if ((in != CONSOLE_INPUT && inPipe == NULL)
+      || (out != CONSOLE_OUTPUT && outPipe == NULL)) {
+    sprintf(msg,"%" PRId64 "",(in != CONSOLE_INPUT && inPipe == NULL) ? in : out);
+    g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  g_current_thread->GetProcessOwner()->Redirect(inPipe,outPipe);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  g_machine->WriteIntRegister(10,NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysSeek
+/*!	Seek to a given position in an opened file
+*/
+//----------------------------------------------------------------------
+static void SysSeek(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Filesystem: Seek call.\n");
+  int offset;
+  int64_t f;
+  int error=NO_ERROR;
+
+  // Get the offset into the file
+  offset = g_machine->ReadIntRegister(10);
+  // Get the openfile number or 1 (console)
+  f = g_machine->ReadIntRegister(11);
+
+  // Seek into a file
+  if (f > CONSOLE_OUTPUT) {
+    int64_t fid = f;
+    OpenFile *file = (OpenFile *)g_object_addrs->SearchObject(fid,FILE_TYPE);
+    if (file)
+      {
+	file->Seek(offset);
+	g_syscall_error->SetMsg((char*)"",NO_ERROR);
+      }
+    else
+      {
+	error = ERROR;
+	sprintf(msg,"%" PRId64 "",f);
+	g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
+      }
+    g_machine->WriteIntRegister(10,error);
+  }
+  else {
+    g_machine->WriteIntRegister(10,ERROR);
+    sprintf(msg,"%" PRId64 "",f);
+    g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
+  }
+}
+
+//----------------------------------------------------------------------
+// SysClose
+/*!	The close system call
+//	Close a file
+*/
+//----------------------------------------------------------------------
+static void SysClose(int type) {
+  DEBUG('e', (char*)"Filesystem: Close call.\n");
+  g_machine->WriteIntRegister(10,DoClose(g_machine->ReadIntRegister(10)));
+}
+
+//----------------------------------------------------------------------
+// SysSemCreate
+/*!	Create a semaphore
+*/
+//----------------------------------------------------------------------
+static void SysSemCreate(int type) {
+  DEBUG('e', (char*)"Semaphore: SemCreate call.\n");
+  uint64_t addr = g_machine->ReadIntRegister(10);
+  int count = g_machine->ReadIntRegister(11);
+  int sizep = GetLengthParam(addr);
+  char ch[sizep];
+  GetStringParam(addr,ch,sizep);
+  if (count < 0) {
+    g_syscall_error->SetMsg((char*)"",INVALID_COUNTER);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  Semaphore *sema = new Semaphore(ch,count);
+  g_machine->WriteIntRegister(10,g_object_addrs->AddObject(sema,SEMAPHORE_TYPE));
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysSemDestroy
+/*!	Destroy a semaphore
+*/
+//----------------------------------------------------------------------
+static void SysSemDestroy(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Semaphore: SemDestroy call.\n");
+  int64_t sid = g_machine->ReadIntRegister(10);
+  Semaphore *sema = (Semaphore *)g_object_addrs->SearchObject(sid,SEMAPHORE_TYPE);
+  if (sema) {
+    g_object_addrs->RemoveObject(sid);
+    delete sema;
+    g_machine->WriteIntRegister(10,NO_ERROR);
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+  else {
+    g_machine->WriteIntRegister(10,ERROR);
+    sprintf(msg,"%" PRId64 "",sid);
+    g_syscall_error->SetMsg(msg,INVALID_SEMAPHORE_ID);
+  }
+}
+
+//----------------------------------------------------------------------
+// SysP
+/*!	Operation P on a semaphore
+*/
+//----------------------------------------------------------------------
+static void SysP(int type) {
+  DEBUG('e', (char*)"Semaphore: P call.\n");
+  g_machine->WriteIntRegister(10,DoP(g_machine->ReadIntRegister(10)));
+}
+
+//----------------------------------------------------------------------
+// SysV
+/*!	Operation V on a semaphore
+*/
+//----------------------------------------------------------------------
+static void SysV(int type) {
+  DEBUG('e', (char*)"Semaphore: V call.\n");
+  g_machine->WriteIntRegister(10,DoV(g_machine->ReadIntRegister(10)));
+}
+
+//----------------------------------------------------------------------
+// SysRWLockCreate
+/*!	Create a reader-writer lock
+*/
+//----------------------------------------------------------------------
+static void SysRWLockCreate(int type) {
+  DEBUG('e', (char*)"RWLock: RWLockCreate call.\n");
+  uint64_t addr = g_machine->ReadIntRegister(10);
+  int flags = g_machine->ReadIntRegister(11);
+  int sizep = GetLengthParam(addr);
+  char ch[sizep];
+  GetStringParam(addr,ch,sizep);
+  RWLock *rwlock = new RWLock(ch,(flags & RWLOCK_WRITER_PREF) != 0);
+  g_machine->WriteIntRegister(10,g_object_addrs->AddObject(rwlock,RWLOCK_TYPE));
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysRWLockOp
+/*!	Operations on a reader-writer lock
+//
+//	\param type is the system call number (SC_RWLOCK_DESTROY, SC_RWLOCK_READ, SC_RWLOCK_WRITE, SC_RWLOCK_RELEASE)
+*/
+//----------------------------------------------------------------------
+static void SysRWLockOp(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"RWLock: RWLock call %d.\n", type);
+  int64_t lid = g_machine->ReadIntRegister(10);
+  RWLock *rwlock = (RWLock *)g_object_addrs->SearchObject(lid,RWLOCK_TYPE);
+  if (rwlock == NULL || (type == SC_RWLOCK_RELEASE && !rwlock->isHeld())) {
+    sprintf(msg,"%" PRId64 "%s",lid,(rwlock == NULL) ? "" : " (not held)");
+    g_syscall_error->SetMsg(msg,INVALID_RWLOCK_ID);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  if (type == SC_RWLOCK_DESTROY && rwlock->isBusy()) {
+    sprintf(msg,"%" PRId64 "",lid);
+    g_syscall_error->SetMsg(msg,OBJECT_BUSY);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  if (type == SC_RWLOCK_DESTROY) {
+    g_object_addrs->RemoveObject(lid);
+    delete rwlock;
+  }
+  else if (type == SC_RWLOCK_READ)
+    rwlock->AcquireRead();
+  else if (type == SC_RWLOCK_WRITE)
+    rwlock->AcquireWrite();
+  else
+    rwlock->Release();
+  g_machine->WriteIntRegister(10,NO_ERROR);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysBarrierCreate
+/*!	Create a barrier
+*/
+//----------------------------------------------------------------------
+static void SysBarrierCreate(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Barrier: BarrierCreate call.\n");
+  uint64_t addr = g_machine->ReadIntRegister(10);
+  int count = g_machine->ReadIntRegister(11);
+  int sizep = GetLengthParam(addr);
+  char ch[sizep];
+  GetStringParam(addr,ch,sizep);
+  if (count <= 0) {
+    sprintf(msg,"%d",count);
+    g_syscall_error->SetMsg(msg,INVALID_THREAD_COUNT);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  Barrier *barrier = new Barrier(ch,count);
+  g_machine->WriteIntRegister(10,g_object_addrs->AddObject(barrier,BARRIER_TYPE));
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysBarrierOp
+/*!	Destroy a barrier, or wait on it
+//
+//	\param type is the system call number (SC_BARRIER_DESTROY, SC_BARRIER_WAIT)
+*/
+//----------------------------------------------------------------------
+static void SysBarrierOp(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Barrier: Barrier call %d.\n", type);
+  int64_t bid = g_machine->ReadIntRegister(10);
+  Barrier *barrier = (Barrier *)g_object_addrs->SearchObject(bid,BARRIER_TYPE);
+  if (barrier == NULL) {
+    sprintf(msg,"%" PRId64 "",bid);
+    g_syscall_error->SetMsg(msg,INVALID_BARRIER_ID);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  if (type == SC_BARRIER_DESTROY && barrier->isBusy()) {
+    sprintf(msg,"%" PRId64 "",bid);
+    g_syscall_error->SetMsg(msg,OBJECT_BUSY);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  if (type == SC_BARRIER_DESTROY) {
+    g_object_addrs->RemoveObject(bid);
+    delete barrier;
+    g_machine->WriteIntRegister(10,NO_ERROR);
+  }
+  else
+    g_machine->WriteIntRegister(10,barrier->Wait() ? BARRIER_SERIAL : NO_ERROR);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysRoiBegin
+/*!	Begin a region of interest
+*/
+//----------------------------------------------------------------------
+static void SysRoiBegin(int type) {
+  DEBUG('e', (char*)"RoiBegin call.\n");
+  uint64_t addr = g_machine->ReadIntRegister(10);
+  int sizep = GetLengthParam(addr);
+  char ch[sizep];
+  GetStringParam(addr,ch,sizep);
+  int err = g_roi->Begin(ch);
+  g_syscall_error->SetMsg(ch,err);
+  g_machine->WriteIntRegister(10,(err == NO_ERROR) ? NO_ERROR : ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysRoiEnd
+/*!	End the active region of interest
+*/
+//----------------------------------------------------------------------
+static void SysRoiEnd(int type) {
+  DEBUG('e', (char*)"RoiEnd call.\n");
+  int err = g_roi->End();
+  g_syscall_error->SetMsg((char*)"",err);
+  g_machine->WriteIntRegister(10,(err == NO_ERROR) ? NO_ERROR : ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysWaitAny
+/*!	Wait for the first ready object among several
+*/
+//----------------------------------------------------------------------
+static void SysWaitAny(int type) {
+  DEBUG('e', (char*)"WaitAny call.\n");
+  g_machine->WriteIntRegister(10,DoWaitAny(g_machine->ReadIntRegister(10),
+					  g_machine->ReadIntRegister(11)));
+}
+
+//----------------------------------------------------------------------
+// SysRingSetup
+/*!	Register the syscall ring of the process
+*/
+//----------------------------------------------------------------------
+static void SysRingSetup(int type) {
+  DEBUG('e', (char*)"Syscall ring: RingSetup call.\n");
+  g_machine->WriteIntRegister(10,DoRingSetup(g_machine->ReadIntRegister(10),
+					   g_machine->ReadIntRegister(11)));
+}
+
+//----------------------------------------------------------------------
+// SysRingEnter
+/*!	Execute the requests queued in the syscall ring
+*/
+//----------------------------------------------------------------------
+static void SysRingEnter(int type) {
+  DEBUG('e', (char*)"Syscall ring: RingEnter call.\n");
+  g_machine->WriteIntRegister(10,DoRingEnter(g_machine->ReadIntRegister(10)));
+}
+
+//----------------------------------------------------------------------
+// SysRemove
+/*!	The Remove system call
+//	Remove a file from the file system
+*/
+//----------------------------------------------------------------------
+static void SysRemove(int type) {
+  DEBUG('e', (char*)"Filesystem: Remove call.\n");
+  int ret;
+  int addr;
+  int sizep;
+  // Get the name of the file to be removes
+  addr = g_machine->ReadIntRegister(10);
+  sizep = GetLengthParam(addr);
+  char *ch = new char[sizep];
+  GetStringParam(addr,ch,sizep);
+  // Actually remove it
+  int err=g_open_file_table->Remove(ch);
+  if (err == NO_ERROR) {
+    ret = 0;
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+  else {
+    ret = ERROR;
+    g_syscall_error->SetMsg(ch,err);
+  }
+  g_machine->WriteIntRegister(10,ret);
+}
+
+//----------------------------------------------------------------------
+// SysMkdir
+/*!	the Mkdir system call
+//	make a new directory in the file system
+*/
+//----------------------------------------------------------------------
+static void SysMkdir(int type) {
+  DEBUG('e', (char*)"Filesystem: Mkdir call.\n");
+  int addr;
+  int sizep;
+  addr = g_machine->ReadIntRegister(10);
+  sizep = GetLengthParam(addr);
+  char name[sizep];
+  GetStringParam(addr,name,sizep);
+  // name is the name of the new directory
+  int good=g_file_system->Mkdir(name);
+  if (good != NO_ERROR) {
+    g_machine->WriteIntRegister(10,ERROR);
+    if (good == OUT_OF_DISK) g_syscall_error->SetMsg((char*)"",good);
+    else g_syscall_error->SetMsg(name,good);
+  }
+  else {
+    g_machine->WriteIntRegister(10,((int)good));
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+}
+
+//----------------------------------------------------------------------
+// SysRmdir
+/*!	the Rmdir system call
+//	remove a directory from the file system
+*/
+//----------------------------------------------------------------------
+static void SysRmdir(int type) {
+  DEBUG('e', (char*)"Filesystem: Rmdir call.\n");
+  int addr;
+  int sizep;
+  addr = g_machine->ReadIntRegister(10);
+  sizep = GetLengthParam(addr);
+  char name[sizep];
+  GetStringParam(addr,name,sizep);
+  int good=g_file_system->Rmdir(name);
+  if (good != NO_ERROR) {
+    g_machine->WriteIntRegister(10,ERROR);
+    g_syscall_error->SetMsg(name,good);
+  }
+  else {
+    g_machine->WriteIntRegister(10,good);
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+}
 
 //----------------------------------------------------------------------
-// GetLengthParam
-/*! Returns the length of a string stored in the machine memory,
-//    including the '\0' terminal
+// SysFSList
+/*!	The FSList system call
+//	Lists all the file and directories in the filesystem
+*/
+//----------------------------------------------------------------------
+static void SysFSList(int type) {
+  g_file_system->List();
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysTtySend
+/*!	the TtySend system call
+//	Sends some char by the serial line emulated
+*/
+//----------------------------------------------------------------------
+static void SysTtySend(int type) {
+  DEBUG('e', (char*)"ACIA: Send call.\n");
+  if (g_cfg->ACIA != ACIA_NONE) {
+    int result;
+    uint64_t c;
+    int i;
+    uint64_t addr=g_machine->ReadIntRegister(10);
+    char buff[MAXSTRLEN];
+    for(i=0;;i++)
+      {
+	g_machine->mmu->ReadMem(addr+i,1,&c);
+	buff[i]=(char) c;
+	if (buff[i] == '\0') break;
+      }
+    result=g_acia_driver->TtySend(buff);
+    g_machine->WriteIntRegister(10,result);
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+  else {
+    g_machine->WriteIntRegister(10,ERROR);
+    g_syscall_error->SetMsg((char*)"",NO_ACIA);
+  }
+}
+
+//----------------------------------------------------------------------
+// SysTtyReceive
+/*!	the TtyReceive system call
+//	read some char on the serial line
+*/
+//----------------------------------------------------------------------
+static void SysTtyReceive(int type) {
+  DEBUG('e', (char*)"ACIA: Receive call.\n");
+  if (g_cfg->ACIA != ACIA_NONE) {
+    int result;
+    int i=0;
+    int addr=g_machine->ReadIntRegister(10);
+    int length=g_machine->ReadIntRegister(11);
+    char buff[length+1];
+    result=g_acia_driver->TtyReceive(buff,length);
+    while ((i <= length)) {
+      g_machine->mmu->WriteMem(addr,1,buff[i]);
+      addr++;
+      i++;
+    }
+    g_machine->mmu->WriteMem(addr,1,0);
+    g_machine->WriteIntRegister(10,result);
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+  else {
+    g_machine->WriteIntRegister(10,ERROR);
+    g_syscall_error->SetMsg((char*)"",NO_ACIA);
+  }
+}
+
+//----------------------------------------------------------------------
+// SysMmap
+/*!	Map a file in memory
+*/
+//----------------------------------------------------------------------
+static void SysMmap(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Filesystem: Mmap call.\n");
+  int32_t fid = g_machine->ReadIntRegister(10);
+  OpenFile *file = (OpenFile *)g_object_addrs->SearchObject(fid,FILE_TYPE);
+  if (file) {
+    int size = g_machine->ReadIntRegister(11);
+    AddrSpace *ap = g_current_thread->GetProcessOwner()->addrspace;
+    int addr=ap->Mmap(file,size);
+    g_machine->WriteIntRegister(10,((int)addr));
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+  else {
+    g_machine->WriteIntRegister(10,ERROR);
+    sprintf(msg,"%p",file);
+    g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
+  }
+}
+
+//----------------------------------------------------------------------
+// SysFutexWait
+/*!	Block the calling thread on a futex word
+*/
+//----------------------------------------------------------------------
+static void SysFutexWait(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Futex: FutexWait call.\n");
+  uint64_t addr = g_machine->ReadIntRegister(10);
+  int32_t val = g_machine->ReadIntRegister(11);
+  if (g_futex_table->Wait(addr,val) == NO_ERROR) {
+    g_machine->WriteIntRegister(10,NO_ERROR);
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  }
+  else {
+    g_machine->WriteIntRegister(10,ERROR);
+    sprintf(msg,"0x%" PRIx64 " (misaligned futex)",addr);
+    g_syscall_error->SetMsg(msg,INVALID_USER_ADDRESS);
+  }
+}
+
+//----------------------------------------------------------------------
+// SysFutexWake
+/*!	Wake up threads blocked on a futex word
+*/
+//----------------------------------------------------------------------
+static void SysFutexWake(int type) {
+  DEBUG('e', (char*)"Futex: FutexWake call.\n");
+  uint64_t addr = g_machine->ReadIntRegister(10);
+  int count = g_machine->ReadIntRegister(11);
+  g_machine->WriteIntRegister(10,g_futex_table->Wake(addr,count));
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysSetPriority
+/*!	Change the base priority of a thread
+*/
+//----------------------------------------------------------------------
+static void SysSetPriority(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Scheduler: SetPriority call.\n");
+  int64_t tid = g_machine->ReadIntRegister(10);
+  int64_t prio = g_machine->ReadIntRegister(11);
+  Thread *ptThread = (tid == 0) ? g_current_thread :
+    (Thread *)g_object_addrs->SearchObject(tid,THREAD_TYPE);
+  if (ptThread == NULL) {
+    sprintf(msg,"%" PRId64,tid);
+    g_syscall_error->SetMsg(msg,INVALID_THREAD_ID);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  if (prio < MIN_PRIORITY || prio > MAX_PRIORITY) {
+    sprintf(msg,"%" PRId64,prio);
+    g_syscall_error->SetMsg(msg,INVALID_PRIORITY);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  ptThread->SetPriority(prio);
+  g_machine->WriteIntRegister(10,NO_ERROR);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  // A thread made more urgent than the caller runs at once
+  if (ptThread != g_current_thread
+      && ptThread->GetPriority() > g_current_thread->GetPriority())
+    g_current_thread->Yield();
+}
+
+//----------------------------------------------------------------------
+// SysGetSchedStat
+/*!	Copy the scheduling statistics of a thread to user memory
+*/
+//----------------------------------------------------------------------
+static void SysGetSchedStat(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Scheduler: GetSchedStat call.\n");
+  int64_t tid = g_machine->ReadIntRegister(10);
+  uint64_t addr = g_machine->ReadIntRegister(11);
+  Thread *ptThread = (tid == 0) ? g_current_thread :
+    (Thread *)g_object_addrs->SearchObject(tid,THREAD_TYPE);
+  if (ptThread == NULL) {
+    sprintf(msg,"%" PRId64,tid);
+    g_syscall_error->SetMsg(msg,INVALID_THREAD_ID);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  // Same layout as Nachos_SchedStat (see syscall.h)
+  SchedStat *s = &ptThread->schedStat;
+  uint64_t fields[SCHED_HIST_SIZE + 7];
+  int n = 0;
+  for (int i = 0; i < SCHED_HIST_SIZE; i++)
+    fields[n++] = s->readyLatency[i];
+  fields[n++] = s->maxReadyLatency;
+  fields[n++] = s->readyTicks;
+  fields[n++] = s->runTicks;
+  fields[n++] = s->blockedTicks;
+  fields[n++] = s->numVoluntarySwitches;
+  fields[n++] = s->numInvoluntarySwitches;
+  fields[n++] = s->numPriorityBoosts;
+  int i;
+  for (i = 0; i < n; i++)
+    if (!g_machine->mmu->WriteMem(addr + i*sizeof(uint64_t),
+				  sizeof(uint64_t), fields[i]))
+      break;
+  if (i < n) {
+    sprintf(msg,"0x%" PRIx64,addr);
+    g_syscall_error->SetMsg(msg,INVALID_USER_ADDRESS);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  g_machine->WriteIntRegister(10,NO_ERROR);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysAioSubmit
+/*!	Queue an asynchronous read or write, and return at once
 //
-// \param addr is the memory address of the string */
+//	\param type is the system call number (SC_AIO_READ, SC_AIO_WRITE)
+*/
 //----------------------------------------------------------------------
-static int GetLengthParam(int addr) {
-   int i=0;
-   uint64_t c=1; // Non nul value to start scanning the string
-   
-   // Scan the string until the null character is found
-   while (c != 0) {
-     g_machine->mmu->ReadMem(addr++,1,&c);
-     i++;
-   }
-   return i+1;
- }
+static void SysAioSubmit(int type) {
+  DEBUG('e', (char*)"Filesystem: AioRead/AioWrite call.\n");
+  int64_t id = DoAioSubmit((type == SC_AIO_READ) ? AIO_OP_READ : AIO_OP_WRITE,
+			   g_machine->ReadIntRegister(10),
+			   g_machine->ReadIntRegister(11),
+			   g_machine->ReadIntRegister(12),
+			   g_machine->ReadIntRegister(13));
+  g_machine->WriteIntRegister(10,id);
+}
 
 //----------------------------------------------------------------------
-// GetStringParam
-/*!	Copies a string from the machine memory
+// SysAioCollect
+/*!	Collect the result of an asynchronous read or write
 //
-//	\param addr is the memory address of the string
-//	\param dest is where the string is going to be copied
-//      \param maxlen maximum length of the string to copy in dest,
-//        including the trailing '\0' 
+//	\param type is the system call number (SC_AIO_WAIT, SC_AIO_POLL)
 */
 //----------------------------------------------------------------------
-static void GetStringParam(uint64_t addr,char *dest,int maxlen) {
-   int i=0;
-   uint64_t c=1; // Non nul value to start scanning the string
-   
-   while ((c != 0) && (i < maxlen)) {
-     // Read a character from the machine memory
-     g_machine->mmu->ReadMem(addr++,1,&c);
-     // Put it in the kernel memory
-     dest[i++] = (char)c;
-   }
-   // Force a \0 at the end
-   dest[maxlen-1]='\0';
- }
+static void SysAioCollect(int type) {
+  DEBUG('e', (char*)"Filesystem: AioWait/AioPoll call.\n");
+  g_machine->WriteIntRegister(10,DoAioCollect(g_machine->ReadIntRegister(10),
+					      type == SC_AIO_WAIT));
+}
+
+//----------------------------------------------------------------------
+// SysSleep
+/*!	Sleep for a duration or until a date
+*/
+//----------------------------------------------------------------------
+static void SysSleep(int type) {
+  DEBUG('e', (char*)"Nachos: Sleep call.\n");
+  Time ticks;
+  if (GetTimeParam(g_machine->ReadIntRegister(10),&ticks) != NO_ERROR) {
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  if (!(g_machine->ReadIntRegister(11) & SLEEP_ABSOLUTE))
+    ticks += g_stats->getTotalTicks();
+  g_alarm->SleepUntil(ticks);
+  g_machine->WriteIntRegister(10,NO_ERROR);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysTimedP
+/*!	P on a semaphore, giving up after a timeout
+*/
+//----------------------------------------------------------------------
+static void SysTimedP(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Semaphore: TimedP call.\n");
+  int64_t sid = g_machine->ReadIntRegister(10);
+  Semaphore *sema = (Semaphore *)g_object_addrs->SearchObject(sid,SEMAPHORE_TYPE);
+  Time ticks;
+  if (sema == NULL) {
+    sprintf(msg,"%" PRId64 "",sid);
+    g_syscall_error->SetMsg(msg,INVALID_SEMAPHORE_ID);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  if (GetTimeParam(g_machine->ReadIntRegister(11),&ticks) != NO_ERROR) {
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  bool acquired = sema->TimedP(g_stats->getTotalTicks() + ticks);
+  g_machine->WriteIntRegister(10,acquired ? NO_ERROR : P_TIMEOUT);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysPortCreate
+/*!	Create a message port, or find the existing one with this name
+*/
+//----------------------------------------------------------------------
+static void SysPortCreate(int type) {
+  DEBUG('e', (char*)"Port: PortCreate call.\n");
+  uint64_t addr = g_machine->ReadIntRegister(10);
+  int sizep = GetLengthParam(addr);
+  char ch[sizep];
+  GetStringParam(addr,ch,sizep);
+  Port *port = Port::Find(ch);
+  if (port == NULL)
+    port = new Port(ch);
+  port->Open();
+  g_machine->WriteIntRegister(10,g_object_addrs->AddObject(port,PORT_TYPE));
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysPortDestroy
+/*!	Drop an identifier of a message port
+*/
+//----------------------------------------------------------------------
+static void SysPortDestroy(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Port: PortDestroy call.\n");
+  int64_t pid = g_machine->ReadIntRegister(10);
+  Port *port = (Port *)g_object_addrs->SearchObject(pid,PORT_TYPE);
+  if (port == NULL) {
+    sprintf(msg,"%" PRId64 "",pid);
+    g_syscall_error->SetMsg(msg,INVALID_PORT_ID);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  g_object_addrs->RemoveObject(pid);
+  Port::Release(port);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  g_machine->WriteIntRegister(10,NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysPortTransfer
+/*!	Move pages from the address space of the caller to a port,
+//	or from a port to the address space of the caller
+//
+//	\param type is the system call number (SC_PORT_SEND, SC_PORT_RECEIVE)
+*/
+//----------------------------------------------------------------------
+static void SysPortTransfer(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Port: PortSend/PortReceive call.\n");
+  int64_t pid = g_machine->ReadIntRegister(10);
+  uint64_t addr = g_machine->ReadIntRegister(11);
+  int size = g_machine->ReadIntRegister(12);
+  Port *port = (Port *)g_object_addrs->SearchObject(pid,PORT_TYPE);
+  if (port == NULL) {
+    sprintf(msg,"%" PRId64 "",pid);
+    g_syscall_error->SetMsg(msg,INVALID_PORT_ID);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  // The port must outlive the transfer, even if its identifiers are
+  // destroyed while the caller blocks
+  port->Open();
+  AddrSpace *space = g_current_thread->GetProcessOwner()->addrspace;
+  TouchPages(addr,size);
+  int err;
+  int result;
+  if (type == SC_PORT_SEND) {
+    err = port->Send(space,addr,size);
+    result = (err == NO_ERROR) ? NO_ERROR : ERROR;
+  }
+  else
+    result = port->Receive(space,addr,size,&err);
+  Port::Release(port);
+  if (err != NO_ERROR) {
+    sprintf(msg,"0x%" PRIx64 " (%d bytes)",addr,size);
+    g_syscall_error->SetMsg(msg,err);
+  }
+  else
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  g_machine->WriteIntRegister(10,result);
+}
+
+//----------------------------------------------------------------------
+// SysShmCreate
+/*!	Create a shared memory segment, or find the existing one
+//	with this name
+*/
+//----------------------------------------------------------------------
+static void SysShmCreate(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Shm: ShmCreate call.\n");
+  uint64_t addr = g_machine->ReadIntRegister(10);
+  int size = g_machine->ReadIntRegister(11);
+  int sizep = GetLengthParam(addr);
+  char ch[sizep];
+  GetStringParam(addr,ch,sizep);
+  ShmSegment *seg = ShmSegment::Find(ch);
+  if (seg != NULL && size > seg->GetSize()) {
+    sprintf(msg,"%d (segment %s is %d bytes)",size,ch,seg->GetSize());
+    g_syscall_error->SetMsg(msg,INVALID_SIZE);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  if (seg == NULL) {
+    int err;
+    seg = new ShmSegment(ch,size,&err);
+    if (err != NO_ERROR) {
+      delete seg;
+      sprintf(msg,"%d",size);
+      g_syscall_error->SetMsg(msg,err);
+      g_machine->WriteIntRegister(10,ERROR);
+      return;
+    }
+  }
+  seg->Open();
+  g_machine->WriteIntRegister(10,g_object_addrs->AddObject(seg,SHM_TYPE));
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysShmDestroy
+/*!	Drop an identifier of a shared memory segment
+*/
+//----------------------------------------------------------------------
+static void SysShmDestroy(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Shm: ShmDestroy call.\n");
+  int64_t sid = g_machine->ReadIntRegister(10);
+  ShmSegment *seg = (ShmSegment *)g_object_addrs->SearchObject(sid,SHM_TYPE);
+  if (seg == NULL) {
+    sprintf(msg,"%" PRId64 "",sid);
+    g_syscall_error->SetMsg(msg,INVALID_SHM_ID);
+    g_machine->WriteIntRegister(10,ERROR);
+    return;
+  }
+  g_object_addrs->RemoveObject(sid);
+  ShmSegment::Release(seg);
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  g_machine->WriteIntRegister(10,NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysShmAttach
+/*!	Map a shared memory segment in the address space of the caller
+*/
+//----------------------------------------------------------------------
+static void SysShmAttach(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Shm: ShmAttach call.\n");
+  int64_t sid = g_machine->ReadIntRegister(10);
+  ShmSegment *seg = (ShmSegment *)g_object_addrs->SearchObject(sid,SHM_TYPE);
+  if (seg == NULL) {
+    sprintf(msg,"%" PRId64 "",sid);
+    g_syscall_error->SetMsg(msg,INVALID_SHM_ID);
+    g_machine->WriteIntRegister(10,0);
+    return;
+  }
+  AddrSpace *space = g_current_thread->GetProcessOwner()->addrspace;
+  uint64_t addr = space->MapShared(seg->GetNumPages(),seg->GetFrames());
+  if (addr == 0) {
+    sprintf(msg,"(segment %s)",seg->GetName());
+    g_syscall_error->SetMsg(msg,OUT_OF_MEMORY);
+  }
+  else
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+  g_machine->WriteIntRegister(10,addr);
+}
+
+//----------------------------------------------------------------------
+// SysShmDetach
+/*!	Unmap a shared memory segment from the address space of the caller
+*/
+//----------------------------------------------------------------------
+static void SysShmDetach(int type) {
+  char msg[MAXSTRLEN];
+  DEBUG('e', (char*)"Shm: ShmDetach call.\n");
+  uint64_t addr = g_machine->ReadIntRegister(10);
+  AddrSpace *space = g_current_thread->GetProcessOwner()->addrspace;
+  int err = space->UnmapShared(addr);
+  if (err != NO_ERROR) {
+    sprintf(msg,"0x%" PRIx64 "",addr);
+    g_syscall_error->SetMsg(msg,err);
+    g_machine->WriteIntRegister(10,ERROR);
+  }
+  else {
+    g_syscall_error->SetMsg((char*)"",NO_ERROR);
+    g_machine->WriteIntRegister(10,NO_ERROR);
+  }
+}
+
+//----------------------------------------------------------------------
+// SysInfoPage
+/*!	Address of the information page of the process
+*/
+//----------------------------------------------------------------------
+static void SysInfoPage(int type) {
+  DEBUG('e', (char*)"Nachos: InfoPage call.\n");
+  AddrSpace *space = g_current_thread->GetProcessOwner()->addrspace;
+  g_machine->WriteIntRegister(10,space->getInfoPageAddress());
+  g_syscall_error->SetMsg((char*)"",NO_ERROR);
+}
+
+//----------------------------------------------------------------------
+// SysDebug
+/*!	Map a file in memory
+*/
+//----------------------------------------------------------------------
+static void SysDebug(int type) {
+  DEBUG('e', (char*)"Nachos: debug system call.\n");
+  printf("Debug system call: parameter %llx\n",g_machine->ReadIntRegister(10));
+}
+
+// Entries are in the order of the numbers: a system call added to
+// syscall.h must be added here too, at its place, with its handler.
+// Each entry repeats its number, which SyscallName checks. The lock
+// and condition system calls have no handler yet.
+
+//! Descriptions and handlers of the system calls, indexed by number
+const SyscallDesc g_syscall_table[NUM_SYSCALLS] = {
+  { SC_HALT,            "Halt",           "",     SysHalt },
+  { SC_EXIT,            "Exit",           "d",    SysExit },
+  { SC_EXEC,            "Exec",           "s",    SysExec },
+  { SC_JOIN,            "Join",           "d",    SysJoin },
+  { SC_CREATE,          "Create",         "sd",   SysCreate },
+  { SC_OPEN,            "Open",           "s",    SysOpen },
+  { SC_READ,            "Read",           "xdd",  SysRead },
+  { SC_WRITE,           "Write",          "xdd",  SysWrite },
+  { SC_SEEK,            "Seek",           "dd",   SysSeek },
+  { SC_CLOSE,           "Close",          "d",    SysClose },
+  { SC_NEW_THREAD,      "newThread",      "sxd",  SysNewThread },
+  { SC_YIELD,           "Yield",          "",     SysYield },
+  { SC_PERROR,          "PError",         "s",    SysPError },
+  { SC_P,               "P",              "d",    SysP },
+  { SC_V,               "V",              "d",    SysV },
+  { SC_SEM_CREATE,      "SemCreate",      "sd",   SysSemCreate },
+  { SC_SEM_DESTROY,     "SemDestroy",     "d",    SysSemDestroy },
+  { SC_LOCK_CREATE,     "LockCreate",     "s",    NULL },
+  { SC_LOCK_DESTROY,    "LockDestroy",    "d",    NULL },
+  { SC_LOCK_ACQUIRE,    "LockAcquire",    "d",    NULL },
+  { SC_LOCK_RELEASE,    "LockRelease",    "d",    NULL },
+  { SC_COND_CREATE,     "CondCreate",     "s",    NULL },
+  { SC_COND_DESTROY,    "CondDestroy",    "d",    NULL },
+  { SC_COND_WAIT,       "CondWait",       "d",    NULL },
+  { SC_COND_SIGNAL,     "CondSignal",     "d",    NULL },
+  { SC_COND_BROADCAST,  "CondBroadcast",  "d",    NULL },
+  { SC_TTY_SEND,        "TtySend",        "s",    SysTtySend },
+  { SC_TTY_RECEIVE,     "TtyReceive",     "xd",   SysTtyReceive },
+  { SC_MKDIR,           "Mkdir",          "s",    SysMkdir },
+  { SC_RMDIR,           "Rmdir",          "s",    SysRmdir },
+  { SC_REMOVE,          "Remove",         "s",    SysRemove },
+  { SC_FSLIST,          "FSList",         "",     SysFSList },
+  { SC_SYS_TIME,        "SysTime",        "x",    SysSysTime },
+  { SC_MMAP,            "Mmap",           "dd",   SysMmap },
+  { SC_DEBUG,           "Debug",          "x",    SysDebug },
+  { SC_FUTEX_WAIT,      "FutexWait",      "xd",   SysFutexWait },
+  { SC_FUTEX_WAKE,      "FutexWake",      "xd",   SysFutexWake },
+  { SC_SCHED_STAT,      "GetSchedStat",   "dx",   SysGetSchedStat },
+  { SC_RING_SETUP,      "RingSetup",      "xd",   SysRingSetup },
+  { SC_RING_ENTER,      "RingEnter",      "d",    SysRingEnter },
+  { SC_INFO_PAGE,       "InfoPage",       "",     SysInfoPage },
+  { SC_AIO_READ,        "AioRead",        "xddd", SysAioSubmit },
+  { SC_AIO_WRITE,       "AioWrite",       "xddd", SysAioSubmit },
+  { SC_AIO_WAIT,        "AioWait",        "d",    SysAioCollect },
+  { SC_AIO_POLL,        "AioPoll",        "d",    SysAioCollect },
+  { SC_READV,           "Readv",          "xdd",  SysReadv },
+  { SC_WRITEV,          "Writev",         "xdd",  SysWritev },
+  { SC_SLEEP,           "Sleep",          "xd",   SysSleep },
+  { SC_TIMED_P,         "TimedP",         "dx",   SysTimedP },
+  { SC_PIPE_CREATE,     "PipeCreate",     "x",    SysPipeCreate },
+  { SC_REDIRECT,        "Redirect",       "dd",   SysRedirect },
+  { SC_PORT_CREATE,     "PortCreate",     "s",    SysPortCreate },
+  { SC_PORT_DESTROY,    "PortDestroy",    "d",    SysPortDestroy },
+  { SC_PORT_SEND,       "PortSend",       "dxd",  SysPortTransfer },
+  { SC_PORT_RECEIVE,    "PortReceive",    "dxd",  SysPortTransfer },
+  { SC_SHM_CREATE,      "ShmCreate",      "sd",   SysShmCreate },
+  { SC_SHM_DESTROY,     "ShmDestroy",     "d",    SysShmDestroy },
+  { SC_SHM_ATTACH,      "ShmAttach",      "d",    SysShmAttach },
+  { SC_SHM_DETACH,      "ShmDetach",      "x",    SysShmDetach },
+  { SC_SET_PRIORITY,    "SetPriority",    "dd",   SysSetPriority },
+  { SC_RWLOCK_CREATE,   "RWLockCreate",   "sd",   SysRWLockCreate },
+  { SC_RWLOCK_DESTROY,  "RWLockDestroy",  "d",    SysRWLockOp },
+  { SC_RWLOCK_READ,     "RWLockRead",     "d",    SysRWLockOp },
+  { SC_RWLOCK_WRITE,    "RWLockWrite",    "d",    SysRWLockOp },
+  { SC_RWLOCK_RELEASE,  "RWLockRelease",  "d",    SysRWLockOp },
+  { SC_BARRIER_CREATE,  "BarrierCreate",  "sd",   SysBarrierCreate },
+  { SC_BARRIER_DESTROY, "BarrierDestroy", "d",    SysBarrierOp },
+  { SC_BARRIER_WAIT,    "BarrierWait",    "d",    SysBarrierOp },
+  { SC_WAIT_ANY,        "WaitAny",        "xd",   SysWaitAny },
+  { SC_ROI_BEGIN,       "RoiBegin",       "s",    SysRoiBegin },
+  { SC_ROI_END,         "RoiEnd",         "",     SysRoiEnd },
+};
+
+//----------------------------------------------------------------------
+// SyscallName
+/*!	Name a system call
+//
+//	\param number the system call number
+//	\return the name of the user function, "?" if there is none
+*/
+//----------------------------------------------------------------------
+const char *
+SyscallName(int number)
+{
+  if (number < 0 || number >= NUM_SYSCALLS)
+    return "?";
+  ASSERT(g_syscall_table[number].number == number);
+  return g_syscall_table[number].name;
+}
 
  //----------------------------------------------------------------------
  // ExceptionHandler
@@ -118,550 +2160,37 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
 
   case SYSCALL_EXCEPTION: {
 
-    // System calls
-    // -------------
-    switch(type) {
-	char msg[MAXSTRLEN]; // Argument for the PError system call
-
-    case SC_HALT: 
-      // The halt system call. Stops Nachos.
-      DEBUG('e', (char*)"Shutdown, initiated by user program.\n");
-      g_machine->interrupt->Halt(NO_ERROR);
-      g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      return;
-	  
-    case SC_SYS_TIME: {
-      // The systime system call. Gets the system time
-      DEBUG('e', (char*)"Systime call, initiated by user program.\n");
-      int addr=g_machine->ReadIntRegister(10);
-      uint64_t tick = g_stats->getTotalTicks();
-      uint32_t seconds = (uint32_t)
-	cycle_to_sec(tick,g_cfg->ProcessorFrequency);
-      uint32_t nanos =  (uint32_t)
-	cycle_to_nano(tick,g_cfg->ProcessorFrequency);
-      g_machine->mmu->WriteMem(addr,sizeof(uint32_t),seconds);
-      g_machine->mmu->WriteMem(addr+4,sizeof(uint32_t),nanos);
-      g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      break;
-    }
-
-    case SC_EXIT:{
-      // The exit system call
-      // Ends the calling thread
-      DEBUG('e', (char*)"Thread 0x%x %s exit call.\n", g_current_thread,g_current_thread->GetName());
-      ASSERT(g_current_thread->type == THREAD_TYPE);
-      g_current_thread->Finish();
-      break;
-    }
-
-    case SC_EXEC: {
-      // The exec system call
-      // Creates a new process (thread+address space)
-      DEBUG('e', (char*)"Process: Exec call.\n");
-      int addr;
-      int size;
-      char name[MAXSTRLEN];
-      int error=NO_ERROR;
-	  
-      // Get the process name
-      addr = g_machine->ReadIntRegister(10);
-      size = GetLengthParam(addr);
-      char ch[size];
-      GetStringParam(addr,ch,size);	
-      sprintf(name,"master thread of process %s",ch);
-      Process * p = new Process(ch, &error);
-      if (error != NO_ERROR) {
-	g_machine->WriteIntRegister(10,ERROR);
-	if (error == OUT_OF_MEMORY)
-	  g_syscall_error->SetMsg((char*)"",error);
-	else
-	  g_syscall_error->SetMsg(ch,error);
-	break;
-      }
-      Thread *ptThread = new Thread(name);
-      int32_t tid = g_object_addrs->AddObject(ptThread);
-      error = ptThread->Start(p,
-			      p->addrspace->getCodeStartAddress64(),
-			      -1);
-      if (error != NO_ERROR) {
-	g_machine->WriteIntRegister(10,ERROR);
-	if (error == OUT_OF_MEMORY)
-	  g_syscall_error->SetMsg((char*)"",error);
-	else
-	  g_syscall_error->SetMsg(name,error);
-	break;
-      }
-      g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      g_machine->WriteIntRegister(10,tid);
-      break;
-    }
-
-    case SC_NEW_THREAD: {	  
-      // The newThread system call
-      // Create a new thread in the same address space
-      DEBUG('e', (char*)"Multithread: NewThread call.\n");
-      Thread *ptThread;
-      int name_addr;
-      int64_t fun;
-      int arg;
-      int err=NO_ERROR;
-      // Get the address of the string for the name of the thread
-      name_addr = g_machine->ReadIntRegister(10);
-      // Get the pointer to the function to be executed by the new thread
-      fun = g_machine->ReadIntRegister(11);
-      // Get the function parameters
-      arg = g_machine->ReadIntRegister(12);
-      // Build the name of the thread
-      int size = GetLengthParam(name_addr);
-      char thr_name[size];
-      GetStringParam(name_addr, thr_name, size);
-      //char *proc_name = g_current_thread->getProcessOwner()->getName();
-      // Finally start it
-      ptThread = new Thread(thr_name);
-      int32_t tid = g_object_addrs->AddObject(ptThread);
-      err = ptThread->Start(g_current_thread->GetProcessOwner(),
-			    fun, arg);
-      if (err != NO_ERROR) {
-	g_machine->WriteIntRegister(10,ERROR);
-	g_syscall_error->SetMsg((char*)"",err);
-      }
-      else {
-	g_machine->WriteIntRegister(10,tid);
-	g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      }
-      break;	   
-    }
-	
-    case SC_JOIN: {
-      // The join system call
-      // Wait for the thread idThread to finish
-      DEBUG('e', (char*)"Process or thread: Join call.\n");	  
-      int64_t tid;
-      Thread* ptThread;
-      tid = g_machine->ReadIntRegister(10);
-      ptThread = (Thread *)g_object_addrs->SearchObject(tid);
-      if (ptThread
-	  && ptThread->type == THREAD_TYPE)
-	{
-	  g_current_thread->Join(ptThread);
-	  g_syscall_error->SetMsg((char*)"",NO_ERROR);
-	  g_machine->WriteIntRegister(10,NO_ERROR);
-	}
-      else
-	// Thread already terminated (type set to INVALID_TYPE) or call on an object
-	// that is not a thread
-	// Exit with no error code since we cannot separate the two cases
-	{
-	  g_syscall_error->SetMsg((char*)"",NO_ERROR);
-	  g_machine->WriteIntRegister(10,NO_ERROR);
-	}
-      DEBUG('e',(char*)"Fin Join");
-      break;	   
-    }
-
-    case SC_YIELD: {
-      DEBUG('e', (char*)"Process or thread: Yield call.\n");
-      if(g_current_thread->type == THREAD_TYPE){
-	g_current_thread->Yield();
-	g_syscall_error->SetMsg((char*)"",NO_ERROR);
-	g_machine->WriteIntRegister(10,NO_ERROR);
-      }
-      else{
-	g_syscall_error->SetMsg((char*)"", INVALID_SEMAPHORE_ID);
-	g_machine->WriteIntRegister(10,ERROR);
-      }
-      break;
-    }
-      
-    case SC_PERROR: { 
-      // the PError system call
-      // print the last error message
-      DEBUG('e', (char*)"Debug: Perror call.\n");
-      int size;
-      int addr;
-      addr = g_machine->ReadIntRegister(10);
-      size = GetLengthParam(addr);
-      char ch[size];
-      GetStringParam(addr,ch,size);
-      g_syscall_error->PrintLastMsg(g_console_driver,ch);
-      break;
-    }
-
-    case SC_CREATE: {
-      // The create system call
-      // Create a new file in nachos file system
-      DEBUG('e', (char*)"Filesystem: Create call.\n");	 
-      int addr;
-      int size;
-      int ret;
-      int sizep;
-      // Get the name and initial size of the new file
-      addr = g_machine->ReadIntRegister(10);
-      size = g_machine->ReadIntRegister(11);
-      sizep = GetLengthParam(addr);
-      char ch[sizep];
-      GetStringParam(addr,ch,sizep);
-      // Try to create it
-      int err = g_file_system->Create(ch,size);
-      if (err == NO_ERROR) {
-	g_syscall_error->SetMsg((char*)"",NO_ERROR);
-	ret = NO_ERROR; 
-      }
-      else { 
-	ret = ERROR; 
-	if (err == OUT_OF_DISK) g_syscall_error->SetMsg((char*)"",err);
-	else g_syscall_error->SetMsg(ch,err);
-      }
-      g_machine->WriteIntRegister(10,ret);
-      break;
-    }
-         
-    case SC_OPEN: {
-      // The open system call
-      // Opens a file and returns an openfile identifier
-      DEBUG('e', (char*)"Filesystem: Open call.\n");
-      int addr;
-      int sizep;
-      int ret=0;
-      // Get the file name
-      addr = g_machine->ReadIntRegister(10);
-      sizep = GetLengthParam(addr);
-      char ch[sizep];
-      GetStringParam(addr,ch,sizep);
-      // Try to open the file
-      OpenFile *file = g_open_file_table->Open(ch);
-      if (file == NULL) {
-	g_syscall_error->SetMsg(ch,OPENFILE_ERROR);
-      }
-      else {
-	ret = g_object_addrs->AddObject(file);
-	g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      }
-      g_machine->WriteIntRegister(10,ret); 
-      break;         
-    }
-      
-    case SC_READ: {
-      // The read system call
-      // Read in a file or the console
-      DEBUG('e', (char*)"Filesystem: Read call.\n");
-      int addr;
-      int size;
-      int64_t f;
-      int numread;
-      // Get the buffer address in the machine memory 
-      addr = g_machine->ReadIntRegister(10);
-      // Get the requested size
-      size = g_machine->ReadIntRegister(11);
-      // Get the openfile number or 0 (console)
-      f = g_machine->ReadIntRegister(12);
-      char buffer[size];
-
-      // Read in a file
-      if (f != CONSOLE_INPUT) {
-	int64_t fid = f;
-	OpenFile *file = (OpenFile *)g_object_addrs->SearchObject(fid);
-	if (file && file->type == FILE_TYPE) {
-	  numread = file->Read(buffer,size);
-	  g_syscall_error->SetMsg((char*)"",NO_ERROR);
-	}
-	else {
-	  numread = ERROR;
-	  sprintf(msg,"%" PRId64 "",f);
-	  g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
-	}
-      }
-      // Read on the console
-      else {
-	g_console_driver->GetString(buffer,size);
-	DEBUG('e', (char*)"Console read. We have %s of size %d\n", buffer, size);
-	numread = size;
-	g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      }         
-      for (int i=0;i<numread;i++)
-	{ //copy the buffer into the emulator memory
-	  g_machine->mmu->WriteMem(addr++,1,buffer[i]);
-	}         
-      g_machine->WriteIntRegister(10,numread); 
-      break;
-    }
- 
-    case SC_WRITE: {
-      // The write system call
-      // Write in a file or at the console
-      DEBUG('e', (char*)"Filesystem: Write call.\n");
-      uint64_t addr;
-      int size;
-      uint64_t f;
-      uint64_t c;
-      addr = g_machine->ReadIntRegister(10);
-      size = g_machine->ReadIntRegister(11);
-      //f is the openfileid or 1 (console)
-      f = g_machine->ReadIntRegister(12);
-      char buffer [size];
-      for (int i=0;i<size;i++) {
-	g_machine->mmu->ReadMem(addr++,1,&c);
-	buffer[i] = c;
-      }
-      int numwrite;
-      // Write in a file
-      if (f > CONSOLE_OUTPUT) {
-	int64_t fid = f;
-	OpenFile *file = (OpenFile *)g_object_addrs->SearchObject(fid);
-	if (file && file->type == FILE_TYPE) {
-	  //write in file
-	  numwrite = file->Write(buffer,size);
-	  g_syscall_error->SetMsg((char*)"",NO_ERROR);
-	}
-	else {
-	  numwrite = ERROR;
-	  sprintf(msg,"%" PRId64 "",f);
-	  g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
-	}
-      } 
-      // write at the console
-      else {
-	if (f==CONSOLE_OUTPUT) {
-	  g_console_driver->PutString(buffer,size);
-	  numwrite = size;
-	  g_syscall_error->SetMsg((char*)"",NO_ERROR);
-	}
-	else {
-	  numwrite = ERROR;
-	  sprintf(msg,"%" PRId64 "",f);
-	  g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
-	}
-      }         
-      g_machine->WriteIntRegister(10,numwrite); 
-      break;
-    }
-        
-    case SC_SEEK:{
-      // Seek to a given position in an opened file
-      DEBUG('e', (char*)"Filesystem: Seek call.\n");
-      int offset;
-      int64_t f;
-      int error=NO_ERROR;
-      
-      // Get the offset into the file
-      offset = g_machine->ReadIntRegister(10);
-      // Get the openfile number or 1 (console)
-      f = g_machine->ReadIntRegister(11);
-      
-      // Seek into a file
-      if (f > CONSOLE_OUTPUT) {
-	int64_t fid = f;
-	OpenFile *file = (OpenFile *)g_object_addrs->SearchObject(fid);
-	if (file && file->type == FILE_TYPE)
-	  {
-	    file->Seek(offset);
-	    g_syscall_error->SetMsg((char*)"",NO_ERROR);
-	  }
-	else
-	  {
-	    error = ERROR;
-	    sprintf(msg,"%" PRId64 "",f);
-	    g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
-	  }
-	g_machine->WriteIntRegister(10,error);
-      } 
-      else {
-	g_machine->WriteIntRegister(10,ERROR);
-	sprintf(msg,"%" PRId64 "",f);
-	g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
-      }
-      break;
-    }
-
-    case SC_CLOSE: {
-      // The close system call
-      // Close a file
-      DEBUG('e', (char*)"Filesystem: Close call.\n");	
-      // Get the openfile number
-      int64_t fid = g_machine->ReadIntRegister(10);
-      OpenFile *file = (OpenFile *)g_object_addrs->SearchObject(fid);
-      if (file && file->type == FILE_TYPE) {
-	g_open_file_table->Close(file->GetName());
-	g_object_addrs->RemoveObject(fid);
-	delete file;
-	g_machine->WriteIntRegister(10,NO_ERROR);
-	g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      }
-      else { 
-	g_machine->WriteIntRegister(10,ERROR);
-	sprintf(msg,"%" PRId64 "",fid);
-	g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
-      }
-      break;
-    }
-      
-    case SC_REMOVE: {
-      // The Remove system call
-      // Remove a file from the file system
-      DEBUG('e', (char*)"Filesystem: Remove call.\n");
-      int ret;
-      int addr;
-      int sizep;
-      // Get the name of the file to be removes
-      addr = g_machine->ReadIntRegister(10);
-      sizep = GetLengthParam(addr);
-      char *ch = new char[sizep];
-      GetStringParam(addr,ch,sizep);
-      // Actually remove it
-      int err=g_open_file_table->Remove(ch);
-      if (err == NO_ERROR) {
-	ret = 0; 
-	g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      }
-      else {
-	ret = ERROR;
-	g_syscall_error->SetMsg(ch,err);
-      }
-      g_machine->WriteIntRegister(10,ret);
-      break;
-    }
-
-    case SC_MKDIR:{
-      // the Mkdir system call
-      // make a new directory in the file system 
-      DEBUG('e', (char*)"Filesystem: Mkdir call.\n");    
-      int addr;
-      int sizep;	  
-      addr = g_machine->ReadIntRegister(10);
-      sizep = GetLengthParam(addr);
-      char name[sizep];
-      GetStringParam(addr,name,sizep);         
-      // name is the name of the new directory
-      int good=g_file_system->Mkdir(name);
-      if (good != NO_ERROR) {
-	g_machine->WriteIntRegister(10,ERROR);
-	if (good == OUT_OF_DISK) g_syscall_error->SetMsg((char*)"",good);
-	else g_syscall_error->SetMsg(name,good);
-      }
-      else {
-	g_machine->WriteIntRegister(10,((int)good));
-	g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      }
-      break;
-    }
-      
-    case SC_RMDIR:{
-      // the Rmdir system call
-      // remove a directory from the file system
-      DEBUG('e', (char*)"Filesystem: Rmdir call.\n");      
-      int addr;
-      int sizep; 
-      addr = g_machine->ReadIntRegister(10);
-      sizep = GetLengthParam(addr);
-      char name[sizep];
-      GetStringParam(addr,name,sizep);
-      int good=g_file_system->Rmdir(name);
-      if (good != NO_ERROR) {
-	g_machine->WriteIntRegister(10,ERROR);
-	g_syscall_error->SetMsg(name,good);
-      }
-      else {
-	g_machine->WriteIntRegister(10,good);
-	g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      }
-      break;
-    }
-
-    case SC_FSLIST: {
-      // The FSList system call
-      // Lists all the file and directories in the filesystem
-      g_file_system->List();
-      g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      break;
-    }
-           
-    case SC_TTY_SEND:{
-      // the TtySend system call	
-      // Sends some char by the serial line emulated
-      DEBUG('e', (char*)"ACIA: Send call.\n");
-      if (g_cfg->ACIA != ACIA_NONE) {
-	int result;
-	uint64_t c;
-	int i;
-	uint64_t addr=g_machine->ReadIntRegister(10);
-	char buff[MAXSTRLEN];
-	for(i=0;;i++)
-	  {
-	    g_machine->mmu->ReadMem(addr+i,1,&c);
-	    buff[i]=(char) c;
-	    if (buff[i] == '\0') break;
-	  }
-	result=g_acia_driver->TtySend(buff);
-	g_machine->WriteIntRegister(10,result);
-	g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      }	
-      else {
-	g_machine->WriteIntRegister(10,ERROR);
-	g_syscall_error->SetMsg((char*)"",NO_ACIA);
-      }
-      break;
-    }
-	
-    case SC_TTY_RECEIVE:{
-      // the TtyReceive system call	
-      // read some char on the serial line
-      DEBUG('e', (char*)"ACIA: Receive call.\n");
-      if (g_cfg->ACIA != ACIA_NONE) {    
-	int result;
-	int i=0;	 
-	int addr=g_machine->ReadIntRegister(10);
-	int length=g_machine->ReadIntRegister(11);
-	char buff[length+1];
-	result=g_acia_driver->TtyReceive(buff,length);
-	while ((i <= length)) {
-	  g_machine->mmu->WriteMem(addr,1,buff[i]);
-	  addr++;
-	  i++;
-	}
-	g_machine->mmu->WriteMem(addr,1,0);
-	g_machine->WriteIntRegister(10,result);
-	g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      }	
-      else {
-	g_machine->WriteIntRegister(10,ERROR);
-	g_syscall_error->SetMsg((char*)"",NO_ACIA);
-      }
-      break;
-    }
-      
-    case SC_MMAP:{
-      // Map a file in memory
-      DEBUG('e', (char*)"Filesystem: Mmap call.\n");
-      int32_t fid = g_machine->ReadIntRegister(10);
-      OpenFile *file = (OpenFile *)g_object_addrs->SearchObject(fid);
-      if (file) {
-	int size = g_machine->ReadIntRegister(11); 
-	AddrSpace *ap = g_current_thread->GetProcessOwner()->addrspace;
-	int addr=ap->Mmap(file,size);
-	g_machine->WriteIntRegister(10,((int)addr));
-	g_syscall_error->SetMsg((char*)"",NO_ERROR);
-      }
-      else { 
-	g_machine->WriteIntRegister(10,ERROR);
-	sprintf(msg,"%p",file);
-	g_syscall_error->SetMsg(msg,INVALID_FILE_ID);
-      }
-      break;
+    // Trace (see systable.h) and time the call, unless fast
+    // forwarding to a region of interest (see roi.h)
+    Time start = g_stats->getTotalTicks();
+    bool detailed = g_stats->detailed;
+    bool trace = detailed && DebugIsEnabled('y');
+    g_current_thread->hpmEvents[HPM_SYSCALLS]++;
+    g_stats->hpmEvents[HPM_SYSCALLS]++;
+    char call[MAXSTRLEN];
+    if (trace) {
+      FormatSyscall(type,call,MAXSTRLEN);
+      // These do not return
+      if (type == SC_HALT || type == SC_EXIT)
+	DEBUG('y', (char*)"[%s] %s = ?\n", g_current_thread->GetName(), call);
     }
 
-    case SC_DEBUG:{
-      // Map a file in memory
-      DEBUG('e', (char*)"Nachos: debug system call.\n");
-      printf("Debug system call: parameter %llx\n",g_machine->ReadIntRegister(10));
-      break;
-    }
-	    
-    default:
+    // System calls
+    // -------------
+    if (type < 0 || type >= NUM_SYSCALLS
+	|| g_syscall_table[type].handler == NULL) {
       printf("Invalid system call number : %d %x\n", type,type);
       exit(ERROR);
-      break;
     }
+    g_syscall_table[type].handler(type);
 
+    Time duration = g_stats->getTotalTicks() - start;
+    if (detailed)
+      g_stats->AddSyscall(type,duration);
+    if (trace)
+      DEBUG('y', (char*)"[%s] %s = %" PRId64 " <%" PRIu64 " cycles>\n",
+	    g_current_thread->GetName(), call,
+	    (int64_t)g_machine->ReadIntRegister(10), (uint64_t)duration);
     break;
   } 
 
@@ -707,14 +2236,34 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
     g_machine->interrupt->Halt(ERROR);
     break;
  
-  case PAGEFAULT_EXCEPTION:
+  case PAGEFAULT_EXCEPTION: {
+    // Where the page fault manager will get the page from, for the
+    // page fault profiler (see faultprof.h)
+    int vpn = vaddr / g_cfg->PageSize;
+    AddrSpace *space = g_current_thread->GetProcessOwner()->addrspace;
+    TranslationTable *table = g_machine->mmu->translationTable;
+    FaultType fault;
+    if (table->getBitSwap(vpn))
+      fault = FAULT_SWAP_IN;
+    else if (table->getAddrDisk(vpn) != INVALID_SECTOR)
+      fault = FAULT_FILE;
+    else
+      fault = FAULT_FIRST_TOUCH;
+    // pc is already past the instruction, unless it is being fetched
+    uint64_t pc = g_machine->mmu->fetching ? g_machine->pc : g_machine->pc - 4;
+    Time start = g_stats->getTotalTicks();
+
     ExceptionType e;
-    e = g_page_fault_manager->PageFault(vaddr / g_cfg->PageSize);
+    e = g_page_fault_manager->PageFault(vpn);
     if (e!=NO_EXCEPTION) {
       printf("\t*** Page fault handling failed, ... exiting\n");
       g_machine->interrupt->Halt(ERROR);
     }
+    if (g_stats->detailed)
+      g_fault_profiler->Record(space->FaultRegion(vpn), vpn, pc, fault,
+			       g_stats->getTotalTicks() - start);
     break;
+  }
     
   default:
     printf("Unknown exception %d\n", exceptiontype);
@@ -722,4 +2271,8 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
     break;
   }
 
+  // Publish the counters updated by the exception
+  if (g_current_thread->GetProcessOwner()->addrspace != NULL)
+    g_current_thread->GetProcessOwner()->addrspace->UpdateInfoPage(g_current_thread);
+
  }
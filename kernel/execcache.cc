@@ -0,0 +1,287 @@
+/*! \file execcache.cc
+//  \brief Routines to keep parsed executable files in memory
+//
+//	A miss may block on disk reads. Another thread may then write
+//	to the file being parsed: the parsed image is not cached in
+//	this case (Invalidate has been called in the meantime), and is
+//	only used by the address space which loaded it.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "kernel/execcache.h"
+#include "kernel/msgerror.h"
+#include "kernel/elf.h"
+#include "filesys/openfile.h"
+#include "utility/config.h"
+
+//----------------------------------------------------------------------
+// ExecImage::ExecImage
+//!	Initialize an empty image
+//----------------------------------------------------------------------
+ExecImage::ExecImage()
+{
+  sector = -1;
+  length = 0;
+  entry = 0;
+  topAddr = 0;
+  numSections = 0;
+  sections = NULL;
+  is32Bits = 0;
+  refs = 0;
+  cached = false;
+}
+
+//----------------------------------------------------------------------
+// ExecImage::~ExecImage
+//!	Deallocate the sections of an image
+//----------------------------------------------------------------------
+ExecImage::~ExecImage()
+{
+  for (int i = 0; i < numSections; i++) {
+    delete [] sections[i].name;
+    delete [] sections[i].image;
+  }
+  delete [] sections;
+}
+
+//----------------------------------------------------------------------
+// ExecCache::ExecCache
+//!	Initialize an empty cache
+//----------------------------------------------------------------------
+ExecCache::ExecCache()
+{
+  numImages = 0;
+  generation = 0;
+  numInvalidations = 0;
+  numHits = 0;
+  numMisses = 0;
+}
+
+//----------------------------------------------------------------------
+// ExecCache::~ExecCache
+//!	Deallocate the cached images
+//----------------------------------------------------------------------
+ExecCache::~ExecCache()
+{
+  ExecImage *image;
+  while ((image = lru.Remove()) != NULL)
+    delete image;
+}
+
+//----------------------------------------------------------------------
+// ExecCache::Get
+/*!	Return the parsed image of an executable file, from the cache
+//	if the file has already been parsed since it was last written.
+//
+//	\param file the executable file
+//	\param err NO_ERROR, or the reason why the file cannot be
+//	       executed when NULL is returned
+//	\return the image, to be given back with Release, or NULL
+*/
+//----------------------------------------------------------------------
+ExecImage *
+ExecCache::Get(OpenFile *file, int *err)
+{
+  int sector = file->GetSector();
+  *err = NO_ERROR;
+
+  for (ExecImage *image = lru.First(); image != NULL; image = lru.Next(image))
+    if (image->sector == sector && image->length == file->Length()) {
+      // Most recently used images are kept at the front
+      lru.RemoveItem(image);
+      lru.Prepend(image);
+      image->refs++;
+      numHits++;
+      DEBUG('a', (char *)"Exec cache hit for %s (sector %d)\n",
+	    file->GetName(), sector);
+      return image;
+    }
+
+  numMisses++;
+  uint32_t gen = generation;
+  ExecImage *image = Load(file, err);
+  if (image == NULL)
+    return NULL;
+  image->refs = 1;
+
+  // Do not cache the image if a file was written while it was read
+  if (gen != generation)
+    return image;
+
+  // Make room for the new image, forgetting the least recently used
+  // ones
+  while (numImages >= EXEC_CACHE_SIZE) {
+    ExecImage *last = lru.First();
+    while (lru.Next(last) != NULL)
+      last = lru.Next(last);
+    Drop(last);
+  }
+  image->cached = true;
+  lru.Prepend(image);
+  numImages++;
+  return image;
+}
+
+//----------------------------------------------------------------------
+// ExecCache::Release
+/*!	The caller no longer uses an image obtained by Get. Images
+//	which have left the cache meanwhile are deleted.
+//
+//	\param image the image returned by Get
+*/
+//----------------------------------------------------------------------
+void
+ExecCache::Release(ExecImage *image)
+{
+  ASSERT(image->refs > 0);
+  image->refs--;
+  if (image->refs == 0 && !image->cached)
+    delete image;
+}
+
+//----------------------------------------------------------------------
+// ExecCache::Invalidate
+/*!	The file whose header is at sector has been written to or
+//	removed: forget its image.
+//
+//	\param sector the sector of the file header
+*/
+//----------------------------------------------------------------------
+void
+ExecCache::Invalidate(int sector)
+{
+  generation++;
+  ExecImage *image = lru.First();
+  while (image != NULL) {
+    ExecImage *next = lru.Next(image);
+    if (image->sector == sector) {
+      DEBUG('a', (char *)"Exec cache: invalidate sector %d\n", sector);
+      numInvalidations++;
+      Drop(image);
+    }
+    image = next;
+  }
+}
+
+//----------------------------------------------------------------------
+// ExecCache::Print
+//!	Print the number of hits, misses and invalidations
+//----------------------------------------------------------------------
+void
+ExecCache::Print()
+{
+  printf("Exec cache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64
+	 " invalidations\n", numHits, numMisses, numInvalidations);
+}
+
+//----------------------------------------------------------------------
+// ExecCache::Drop
+/*!	Take an image out of the cache. It is deleted at once if no
+//	address space is being loaded from it, else by the last Release.
+//
+//	\param image a cached image
+*/
+//----------------------------------------------------------------------
+void
+ExecCache::Drop(ExecImage *image)
+{
+  lru.RemoveItem(image);
+  image->cached = false;
+  numImages--;
+  if (image->refs == 0)
+    delete image;
+}
+
+//----------------------------------------------------------------------
+// ExecCache::Load
+/*!	Parse the ELF header and section table of an executable file,
+//	and read the contents of the sections to be loaded in memory.
+//
+//	\param file the executable file
+//	\param err NO_ERROR or an error code (see msgerror.h)
+//	\return the new image, not cached yet, or NULL
+*/
+//----------------------------------------------------------------------
+ExecImage *
+ExecCache::Load(OpenFile *file, int *err)
+{
+  char eident[16];
+  char is32Bits = 0;
+
+  // Read the 16 first bytes of the Header to check if the
+  // file is 32 or 64 bits
+  file->ReadAt((char *) &eident, 16, 0);
+  if (eident[EI_CLASS] == ELFCLASS32)
+    is32Bits = 1;
+  else if (eident[EI_CLASS] == ELFCLASS64)
+    is32Bits = 0;
+  else {
+    *err = EXEC_FILE_FORMAT_ERROR;
+    return NULL;
+  }
+
+  // Read elf header and check file format
+  ElfFile elff(file, is32Bits, err);
+  if (*err != NO_ERROR)
+    return NULL;
+
+  ExecImage *image = new ExecImage();
+  image->sector = file->GetSector();
+  image->length = file->Length();
+  image->entry = elff.getEntry();
+  image->is32Bits = is32Bits;
+
+  // Count the sections to be loaded in memory
+  for (int i = 0 ; i < elff.getShNum() ; i++)
+    if (elff.getShSize(i) > 0 && (elff.getShFlags(i) & SHF_ALLOC))
+      image->numSections++;
+  image->sections = new ExecSection[image->numSections];
+
+  int s = 0;
+  for (int i = 0 ; i < elff.getShNum() ; i++) {
+    DEBUG('a', (char*)"Section %d : size=0x%x name=\"%s\"\n",
+	  i, elff.getShSize(i), elff.getShName(i));
+
+    // Ignore empty sections and the sections not to be loaded
+    if (elff.getShSize(i) <= 0 || !(elff.getShFlags(i) & SHF_ALLOC))
+      continue;
+
+    ExecSection *section = &image->sections[s++];
+    section->name = new char[strlen(elff.getShName(i)) + 1];
+    strcpy(section->name, elff.getShName(i));
+    section->addr = elff.getShAddr(i);
+    section->size = elff.getShSize(i);
+    section->offset = elff.getShOffset(i);
+    section->flags = elff.getShFlags(i);
+    section->image = NULL;
+
+    uint64_t section_topaddr = section->addr + section->size;
+    if (section_topaddr > image->topAddr)
+      image->topAddr = section_topaddr;
+
+    // The SHT_NOBITS flag indicates if the section has an image
+    // in the executable file (text or data section) or not
+    // (bss section)
+    if (elff.getShType(i) != SHT_NOBITS) {
+      int len = divRoundUp(section->size, g_cfg->PageSize) * g_cfg->PageSize;
+      section->image = new char[len];
+      memset(section->image, 0, len);
+      file->ReadAt(section->image, len, section->offset);
+    }
+  }
+
+  return image;
+}
@@ -0,0 +1,124 @@
+/*! \file execcache.h
+    \brief Cache of parsed executable files
+
+    Programs such as the shell execute the same binaries again and
+    again. The exec cache keeps, for the last executed files, the
+    layout of their sections, their entry point and a copy of the
+    contents of their sections, so that executing the file again
+    neither parses its ELF header nor reads it from the disk.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef EXECCACHE_H
+#define EXECCACHE_H
+
+#include "kernel/copyright.h"
+#include "kernel/system.h"
+#include "utility/queue.h"
+
+class OpenFile;
+
+//! Maximum number of executable files kept in the cache
+#define EXEC_CACHE_SIZE 8
+
+/*! \brief A section of an executable file to be loaded in memory
+ */
+typedef struct {
+  char *name;         //!< Section name
+  uint64_t addr;      //!< Virtual address of the section
+  uint64_t size;      //!< Size of the section (bytes)
+  uint64_t offset;    //!< Offset of the section in the file
+  uint64_t flags;     //!< ELF section flags (SHF_WRITE, SHF_EXECINSTR)
+  char *image;        /*!< Contents of the section, rounded up to a
+			multiple of the page size, or NULL when the
+			section has no image in the file (SHT_NOBITS) */
+} ExecSection;
+
+/*! \brief A parsed executable file
+//
+// Only the sections to be loaded in memory (SHF_ALLOC, non-empty)
+// are kept. The page images are never modified: they are copied
+// into the physical pages of each address space loading the file.
+*/
+class ExecImage {
+public:
+  ExecImage();
+  ~ExecImage();
+
+  int sector;              //!< Sector of the file header (cache key)
+  int length;              //!< Length of the file when it was parsed
+  uint64_t entry;          //!< Program start address
+  uint64_t topAddr;        //!< Highest virtual address of the sections
+  int numSections;         //!< Number of sections to load
+  ExecSection *sections;   //!< Sections to load
+  char is32Bits;           //!< 1 for an RV32 program (ELF class), 0 for RV64
+
+  int refs;                //!< Number of address spaces being loaded from it
+  bool cached;             //!< true while the image is in the cache
+  QueueLink lruLink;       //!< Link in the cache, most recently used first
+};
+
+/*! \brief Defines the cache of executable files
+//
+// Entries are looked up by the sector of the file header. An entry
+// is invalidated as soon as the file is written to (see
+// OpenFile::WriteAt) or removed (the header sector may then be given
+// to another file), so a cached image is always that of the current
+// contents of the file.
+//
+//	Get(file) -- return the parsed image of file, parsing and
+//	        reading the file on a miss
+//
+//	Release(image) -- the image obtained by Get is no longer used
+//
+//	Invalidate(sector) -- the file whose header is at sector has
+//	        been modified or removed
+*/
+class ExecCache {
+public:
+  ExecCache();
+  ~ExecCache();
+
+  //! Return the parsed image of an executable file (NULL if not an
+  //  executable file, err then gives the reason)
+  ExecImage *Get(OpenFile *file, int *err);
+
+  //! Release an image obtained by Get
+  void Release(ExecImage *image);
+
+  //! Forget the image of the file whose header is at sector
+  void Invalidate(int sector);
+
+  //! Print the cache statistics
+  void Print();
+
+private:
+  //! Parse an executable file and read the contents of its sections
+  ExecImage *Load(OpenFile *file, int *err);
+
+  //! Take an image out of the cache, deleting it if unused
+  void Drop(ExecImage *image);
+
+  Queue<ExecImage, &ExecImage::lruLink> lru; //!< Cached images
+  int numImages;                //!< Number of cached images
+  uint32_t generation;          //!< Number of calls to Invalidate
+  uint64_t numInvalidations;    //!< Number of invalidated images
+  uint64_t numHits;             //!< Number of Get served by the cache
+  uint64_t numMisses;           //!< Number of Get which read the file
+};
+
+#endif // EXECCACHE_H
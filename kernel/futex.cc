@@ -0,0 +1,166 @@
+/*! \file futex.cc
+//  \brief Routines to block and wake up threads on user memory words
+//
+//	Atomicity with respect to the other threads is obtained as in
+//	synch.cc, by disabling interrupts: the value of the futex word
+//	is checked and the thread is queued without any possible
+//	context switch in between, so a Wake issued after the user
+//	program has modified the word cannot be lost.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "kernel/futex.h"
+#include "kernel/msgerror.h"
+#include "kernel/scheduler.h"
+#include "kernel/thread.h"
+#include "machine/machine.h"
+#include "vm/physMem.h"
+#include "utility/config.h"
+
+//----------------------------------------------------------------------
+// FutexTable::Hash
+/*!	Index of the wait queue of a futex word.
+//
+//	\param space address space of the futex word
+//	\param addr user virtual address of the futex word
+*/
+//----------------------------------------------------------------------
+int
+FutexTable::Hash(AddrSpace *space, uint64_t addr)
+{
+  uint64_t key = (addr >> 2) ^ ((uint64_t)space >> 4);
+  return (int)((key ^ (key >> 6)) % FUTEX_HASH_SIZE);
+}
+
+//----------------------------------------------------------------------
+// FutexTable::GetKey
+/*!	Identify the futex word at a virtual address of the current
+//	process. A word of a shared memory segment (a page without
+//	owner, see AddrSpace::MapShared) is identified by its physical
+//	address, so that the processes sharing the segment may wait and
+//	wake each other. Other words are private to their address space.
+//	Called with interrupts disabled.
+//
+//	\param addr user virtual address of the futex word
+//	\param space where to store the address space of the word, NULL
+//	       for a shared word
+//	\param key where to store the virtual address of the word, or its
+//	       physical address for a shared word
+*/
+//----------------------------------------------------------------------
+void
+FutexTable::GetKey(uint64_t addr, AddrSpace **space, uint64_t *key)
+{
+  AddrSpace *as = g_current_thread->GetProcessOwner()->addrspace;
+  TranslationTable *table = as->translationTable;
+  uint64_t vpn = addr / g_cfg->PageSize;
+
+  *space = as;
+  *key = addr;
+  if (vpn < (uint64_t)table->getMaxNumPages() && table->getBitValid(vpn)) {
+    int pp = table->getPhysicalPage(vpn);
+    if (g_physical_mem_manager->IsShared(pp)) {
+      *space = NULL;
+      *key = (uint64_t)pp * g_cfg->PageSize + addr % g_cfg->PageSize;
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+// FutexTable::Wait
+/*!	Put the current thread to sleep on the futex word at addr,
+//	unless this word no longer contains the value expected by
+//	the caller.  The thread is woken up by a Wake on the same
+//	address in the same address space, or by a Wake from any process
+//	on the same word of a shared memory segment.
+//
+//	Returning does not mean the word has changed: the caller must
+//	check its condition again (as with a condition variable).
+//
+//	\param addr user virtual address of the futex word (32-bit
+//	       aligned)
+//	\param expected value the word is expected to contain
+//	\return NO_ERROR, or ERROR if addr is not 32-bit aligned
+*/
+//----------------------------------------------------------------------
+int
+FutexTable::Wait(uint64_t addr, int32_t expected)
+{
+  FutexWaiter waiter;
+  uint64_t value;
+
+  if (addr % sizeof(int32_t) != 0)
+    return ERROR;
+
+  // Touch the word with interrupts enabled: if its page is not in
+  // memory, the page fault handler may have to block.
+  g_machine->mmu->ReadMem(addr, sizeof(int32_t), &value);
+
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+
+  // Check the value and queue the thread atomically
+  if (g_machine->mmu->ReadMem(addr, sizeof(int32_t), &value)
+      && (int32_t)value == expected) {
+    GetKey(addr, &waiter.space, &waiter.addr);
+    waiter.thread = g_current_thread;
+    DEBUG('s', (char *)"Thread \"%s\" waits on futex 0x%" PRIx64 "\n",
+	  g_current_thread->GetName(), addr);
+    queues[Hash(waiter.space, waiter.addr)].Append(&waiter);
+    g_current_thread->Sleep();
+  }
+
+  g_machine->interrupt->SetStatus(oldLevel);
+  return NO_ERROR;
+}
+
+//----------------------------------------------------------------------
+// FutexTable::Wake
+/*!	Wake up threads blocked on the futex word at addr, in the
+//	order they called Wait.
+//
+//	\param addr user virtual address of the futex word
+//	\param count maximum number of threads to wake up
+//	\return the number of threads woken up
+*/
+//----------------------------------------------------------------------
+int
+FutexTable::Wake(uint64_t addr, int count)
+{
+  AddrSpace *space;
+  uint64_t key;
+  int woken = 0;
+
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+
+  GetKey(addr, &space, &key);
+  FutexQueue *queue = &queues[Hash(space, key)];
+
+  FutexWaiter *waiter = queue->First();
+  while (waiter != NULL && woken < count) {
+    FutexWaiter *next = queue->Next(waiter);
+    if (waiter->space == space && waiter->addr == key) {
+      queue->RemoveItem(waiter);
+      g_scheduler->ReadyToRun(waiter->thread);
+      woken++;
+    }
+    waiter = next;
+  }
+
+  g_machine->interrupt->SetStatus(oldLevel);
+  DEBUG('s', (char *)"Futex 0x%" PRIx64 ": %d thread(s) woken up\n",
+	addr, woken);
+  return woken;
+}
@@ -0,0 +1,85 @@
+/*! \file futex.h
+    \brief Wait queues keyed on user virtual addresses (futexes)
+
+    A futex lets user programs build their synchronization tools in
+    user space (see userlib/libnachos.c) and call the kernel only
+    when a thread really has to block or to wake another thread up.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include "kernel/copyright.h"
+#include "kernel/system.h"
+#include "utility/queue.h"
+
+class AddrSpace;
+class Thread;
+
+//! Number of wait queues of the futex table
+#define FUTEX_HASH_SIZE 64
+
+/*! \brief A thread blocked on a futex
+
+    Allocated on the kernel stack of the blocked thread, for the
+    time it waits.
+*/
+typedef struct {
+  AddrSpace *space;   //!< Address space of the futex word, NULL if shared
+  uint64_t addr;      //!< User virtual address of the futex word, or
+                      //!< physical address if shared (see GetKey)
+  Thread *thread;     //!< The blocked thread
+  QueueLink link;     //!< Link in the wait queue
+} FutexWaiter;
+
+//! Wait queue of the futex table
+typedef Queue<FutexWaiter, &FutexWaiter::link> FutexQueue;
+
+/*! \brief Defines the table of futex wait queues
+//
+// Threads are queued in a hash table indexed by the pair (address
+// space, user virtual address of the futex word), so that two
+// processes using the same virtual address do not wake each other.
+// Words of shared memory segments are indexed by their physical
+// address instead, so that they synchronize the processes sharing
+// them.
+//
+//	Wait(addr, val) -- block the calling thread, unless the word
+//	        at addr no longer contains val
+//
+//	Wake(addr, n) -- wake up at most n threads blocked on addr
+*/
+class FutexTable {
+public:
+  //! Block the current thread if the 32-bit word at addr equals expected
+  int Wait(uint64_t addr, int32_t expected);
+
+  //! Wake up at most count threads blocked on addr
+  int Wake(uint64_t addr, int count);
+
+private:
+  //! Identify the futex word at addr in the current process
+  void GetKey(uint64_t addr, AddrSpace **space, uint64_t *key);
+
+  //! Index of the wait queue of a futex word
+  int Hash(AddrSpace *space, uint64_t addr);
+
+  FutexQueue queues[FUTEX_HASH_SIZE]; //!< Wait queues
+};
+
+#endif // FUTEX_H
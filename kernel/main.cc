@@ -131,7 +131,7 @@ main(int argc, char **argv)
     }
     g_machine->mmu->translationTable = p->addrspace->translationTable;
     Thread * t = new Thread(startfilename);
-    g_object_addrs->AddObject(t);
+    t->SetId(g_object_addrs->AddObject(t,THREAD_TYPE));
     err = t->Start(p, p->addrspace->getCodeStartAddress64(), -1);
     if (err != NO_ERROR) {
       fprintf(stderr,"Unable to start initial process: %s\n",startfilename);
@@ -47,15 +47,29 @@ SyscallError::SyscallError() {
   msgs[NOT_A_DIRECTORY] = (char*)"%s is not a directory\n";
   msgs[DIRECTORY_NOT_EMPTY] = (char*)"directory %s is not empty\n";
   msgs[INVALID_COUNTER] = (char*)"negative semaphore counter\n";
+  msgs[INVALID_SIZE] = (char*)"invalid size or offset %s\n";
 
   msgs[INVALID_SEMAPHORE_ID] = (char*)"invalid semaphore identifier %s\n";
   msgs[INVALID_LOCK_ID] = (char*)"invalid lock identifier %s\n";
   msgs[INVALID_CONDITION_ID] = (char*)"invalid condition identifier %s\n";
   msgs[INVALID_FILE_ID] = (char*)"invalid file identifier %s\n";
   msgs[INVALID_THREAD_ID] = (char*)"invalid thread identifier %s\n";
+  msgs[INVALID_AIO_ID] = (char*)"invalid asynchronous I/O identifier %s\n";
+  msgs[INVALID_PORT_ID] = (char*)"invalid port identifier %s\n";
+  msgs[INVALID_SHM_ID] = (char*)"invalid shared memory segment identifier %s\n";
+  msgs[INVALID_PRIORITY] = (char*)"invalid priority %s\n";
+  msgs[INVALID_RWLOCK_ID] = (char*)"invalid reader-writer lock identifier %s\n";
+  msgs[INVALID_BARRIER_ID] = (char*)"invalid barrier identifier %s\n";
+  msgs[INVALID_THREAD_COUNT] = (char*)"invalid number of threads %s\n";
+  msgs[INVALID_WAIT_ID] = (char*)"cannot wait for object %s\n";
   msgs[WRONG_FILE_ENDIANESS] = (char*)"Incorrect code endianess\n";
 
   msgs[NO_ACIA] = (char*)"no ACIA driver installed %s\n";
+  msgs[INVALID_USER_ADDRESS] = (char*)"invalid user address %s\n";
+  msgs[BROKEN_PIPE] = (char*)"no process reads pipe %s\n";
+  msgs[TOO_MANY_ROIS] = (char*)"too many regions of interest, cannot begin %s\n";
+  msgs[NO_ACTIVE_ROI] = (char*)"no region of interest to end %s\n";
+  msgs[OBJECT_BUSY] = (char*)"object %s is in use, cannot destroy it\n";
 }
 
 
@@ -51,6 +51,7 @@ enum
   NOT_A_DIRECTORY,
   DIRECTORY_NOT_EMPTY,
   INVALID_COUNTER,
+  INVALID_SIZE,
 
   /* Invalid typeId fields: */
   INVALID_SEMAPHORE_ID,
@@ -58,10 +59,23 @@ enum
   INVALID_CONDITION_ID,
   INVALID_FILE_ID,
   INVALID_THREAD_ID,
+  INVALID_AIO_ID,
+  INVALID_PORT_ID,
+  INVALID_SHM_ID,
+  INVALID_PRIORITY,
+  INVALID_RWLOCK_ID,
+  INVALID_BARRIER_ID,
+  INVALID_THREAD_COUNT,
+  INVALID_WAIT_ID,
 
   /* Other messages */
   WRONG_FILE_ENDIANESS,
   NO_ACIA,
+  INVALID_USER_ADDRESS,
+  BROKEN_PIPE,
+  TOO_MANY_ROIS,
+  NO_ACTIVE_ROI,
+  OBJECT_BUSY,
 
   NUMMSGERROR /* Must always be last */
 };
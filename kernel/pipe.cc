@@ -0,0 +1,177 @@
+/*! \file pipe.cc
+//  \brief Routines to manage pipes
+//
+//	As in synch.cc, atomicity is obtained by disabling interrupts:
+//	a condition is checked and the thread put to sleep without any
+//	possible context switch in between.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "kernel/pipe.h"
+#include "kernel/msgerror.h"
+#include "kernel/synch.h"
+#include "machine/machine.h"
+#include "utility/config.h"
+
+//----------------------------------------------------------------------
+// Pipe::Pipe
+//!	Initialize an empty pipe, without any reference on its ends
+//----------------------------------------------------------------------
+Pipe::Pipe()
+{
+  size = g_cfg->PageSize;
+  buffer = new char[size];
+  head = 0;
+  count = 0;
+  readers = 0;
+  writers = 0;
+  notEmpty = new Condition((char *)"pipe not empty");
+  notFull = new Condition((char *)"pipe not full");
+}
+
+//----------------------------------------------------------------------
+// Pipe::~Pipe
+//!	Deallocate a pipe, once no end is referenced
+//----------------------------------------------------------------------
+Pipe::~Pipe()
+{
+  ASSERT(readers == 0 && writers == 0);
+  WaitSet::Notify(&readWatchers);
+  delete [] buffer;
+  delete notEmpty;
+  delete notFull;
+}
+
+//----------------------------------------------------------------------
+// Pipe::Read
+/*!	Read the bytes available in the pipe, blocking while it is
+//	empty and may still be written to.
+//
+//	\param into where to put the bytes read
+//	\param numBytes maximum number of bytes to read
+//	\return the number of bytes read, 0 at end of file
+*/
+//----------------------------------------------------------------------
+int
+Pipe::Read(char *into, int numBytes)
+{
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+
+  while (count == 0 && writers > 0 && numBytes > 0)
+    notEmpty->Wait();
+
+  int n = (numBytes < count) ? numBytes : count;
+  for (int i = 0; i < n; i++)
+    into[i] = buffer[(head + i) % size];
+  head = (head + n) % size;
+  count -= n;
+  if (n > 0)
+    notFull->Broadcast();
+
+  g_machine->interrupt->SetStatus(oldLevel);
+  DEBUG('f', (char *)"Pipe: %d bytes read\n", n);
+  return n;
+}
+
+//----------------------------------------------------------------------
+// Pipe::Write
+/*!	Write bytes into the pipe, blocking while it is full. Gives up
+//	if the read end is closed meanwhile.
+//
+//	\param from the bytes to write
+//	\param numBytes number of bytes to write
+//	\return the number of bytes written, ERROR if nothing could be
+//	       written because the read end is closed
+*/
+//----------------------------------------------------------------------
+int
+Pipe::Write(char *from, int numBytes)
+{
+  int written = 0;
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+
+  while (written < numBytes && readers > 0) {
+    while (count == size && readers > 0)
+      notFull->Wait();
+    int n = size - count;
+    if (n > numBytes - written)
+      n = numBytes - written;
+    for (int i = 0; i < n; i++)
+      buffer[(head + count + i) % size] = from[written + i];
+    count += n;
+    written += n;
+    if (n > 0) {
+      notEmpty->Broadcast();
+      WaitSet::Notify(&readWatchers);
+    }
+  }
+
+  g_machine->interrupt->SetStatus(oldLevel);
+  DEBUG('f', (char *)"Pipe: %d bytes written\n", written);
+  if (written == 0 && numBytes > 0)
+    return ERROR;
+  return written;
+}
+
+//----------------------------------------------------------------------
+// Pipe::Open
+/*!	Take a reference on an end of the pipe
+//
+//	\param end PIPE_READ_END or PIPE_WRITE_END
+*/
+//----------------------------------------------------------------------
+void
+Pipe::Open(int end)
+{
+  if (end == PIPE_READ_END)
+    readers++;
+  else
+    writers++;
+}
+
+//----------------------------------------------------------------------
+// Pipe::Release
+/*!	Drop a reference on an end of a pipe. The threads blocked at
+//	the other end are woken up when the last reference goes, so
+//	that they see the end of file or the broken pipe.
+//
+//	\param pipe the pipe, deleted if no end is referenced any more
+//	\param end PIPE_READ_END or PIPE_WRITE_END
+*/
+//----------------------------------------------------------------------
+void
+Pipe::Release(Pipe *pipe, int end)
+{
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  if (end == PIPE_READ_END) {
+    ASSERT(pipe->readers > 0);
+    if (--pipe->readers == 0)
+      pipe->notFull->Broadcast();
+  } else {
+    ASSERT(pipe->writers > 0);
+    if (--pipe->writers == 0) {
+      pipe->notEmpty->Broadcast();
+      WaitSet::Notify(&pipe->readWatchers);
+    }
+  }
+  // Decide before interrupts are enabled again, so that only the
+  // thread dropping the last reference deletes the pipe
+  bool last = (pipe->readers == 0 && pipe->writers == 0);
+  g_machine->interrupt->SetStatus(oldLevel);
+
+  if (last)
+    delete pipe;
+}
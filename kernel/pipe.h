@@ -0,0 +1,91 @@
+/*! \file pipe.h
+    \brief Pipes between processes
+
+    A pipe is a page-sized circular buffer in kernel memory: the
+    bytes written at one end can be read at the other end without
+    going through the file system. A pipe end is used with the Read
+    and Write system calls, and can become the standard input or
+    output of a process (see Redirect in exception.cc).
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef PIPE_H
+#define PIPE_H
+
+#include "kernel/copyright.h"
+#include "kernel/system.h"
+#include "kernel/waitany.h"
+
+class Condition;
+
+//! The two ends of a pipe
+#define PIPE_READ_END  0
+#define PIPE_WRITE_END 1
+
+/*! \brief Defines a pipe
+//
+// Each end is reference counted: an end is referenced by its
+// identifier in the object table, by the processes using it as
+// standard input or output, and by the threads reading or writing
+// it, so that the pipe outlives a blocked call. Reading an empty pipe blocks until
+// something is written, or returns 0 (end of file) once no write end
+// is left. Writing to a full pipe blocks until something is read.
+//
+//	Read(into, n) -- read at most n bytes, at least one unless
+//	        at end of file
+//
+//	Write(from, n) -- write n bytes, ERROR if no read end is left
+//
+//	Open(end) / Release(pipe, end) -- take / drop a reference on
+//	        an end, the pipe being deleted with its last end
+*/
+class Pipe {
+public:
+  Pipe();
+  ~Pipe();
+
+  //! Read at most numBytes bytes (0 at end of file)
+  int Read(char *into, int numBytes);
+
+  //! Write numBytes bytes (ERROR if nobody can read them)
+  int Write(char *from, int numBytes);
+
+  //! Take a reference on an end (PIPE_READ_END or PIPE_WRITE_END)
+  void Open(int end);
+
+  //! Drop a reference on an end, deleting the pipe if no end is left
+  static void Release(Pipe *pipe, int end);
+
+  //! Return true if Read would not block (interrupts disabled)
+  bool CanRead() { return count > 0 || writers == 0; }
+
+  //! Threads in WaitAny, notified when Read may not block any more
+  WaitList *GetReadWatchers() { return &readWatchers; }
+
+private:
+  char *buffer;         //!< Circular buffer
+  int size;             //!< Size of the buffer (one page)
+  int head;             //!< Index of the first byte to read
+  int count;            //!< Number of bytes in the buffer
+  int readers;          //!< References on the read end
+  int writers;          //!< References on the write end
+  Condition *notEmpty;  //!< Signalled when bytes are written
+  Condition *notFull;   //!< Signalled when bytes are read
+  WaitList readWatchers; //!< Threads waiting for the read end in WaitAny
+};
+
+#endif // PIPE_H
@@ -0,0 +1,221 @@
+/*! \file port.cc
+//  \brief Routines to send pages from an address space to another
+//
+//	As in synch.cc, atomicity is obtained by disabling interrupts.
+//	Page table updates never block, so a message is moved out of
+//	or into an address space without any context switch.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "kernel/port.h"
+#include "vm/physMem.h"
+#include "kernel/addrspace.h"
+#include "kernel/msgerror.h"
+#include "kernel/synch.h"
+#include "machine/machine.h"
+#include "utility/config.h"
+
+//! Existing ports
+static Queue<Port, &Port::portLink> ports;
+
+//----------------------------------------------------------------------
+// PortMessage::PortMessage
+/*!	Initialize a message of numPages pages
+//
+//	\param msgPages number of pages
+//	\param msgSize size of the message (bytes)
+*/
+//----------------------------------------------------------------------
+PortMessage::PortMessage(int msgPages, int msgSize)
+{
+  numPages = msgPages;
+  size = msgSize;
+  frames = new int[numPages];
+}
+
+//----------------------------------------------------------------------
+// PortMessage::~PortMessage
+//!	Deallocate a message (its pages have been mapped or freed)
+//----------------------------------------------------------------------
+PortMessage::~PortMessage()
+{
+  delete [] frames;
+}
+
+//----------------------------------------------------------------------
+// Port::Port
+/*!	Create an empty port
+//
+//	\param debugName name of the port
+*/
+//----------------------------------------------------------------------
+Port::Port(char *debugName)
+{
+  name = new char[strlen(debugName) + 1];
+  strcpy(name, debugName);
+  numMessages = 0;
+  refs = 0;
+  notEmpty = new Condition((char *)"port not empty");
+  notFull = new Condition((char *)"port not full");
+  ports.Append(this);
+}
+
+//----------------------------------------------------------------------
+// Port::~Port
+//!	Delete a port. The pages of the messages not received are freed.
+//----------------------------------------------------------------------
+Port::~Port()
+{
+  PortMessage *message;
+  while ((message = messages.Remove()) != NULL) {
+    for (int i = 0; i < message->numPages; i++)
+      g_physical_mem_manager->RemovePhysicalToVirtualMapping(message->frames[i]);
+    delete message;
+  }
+  ports.RemoveItem(this);
+  delete notEmpty;
+  delete notFull;
+  delete [] name;
+}
+
+//----------------------------------------------------------------------
+// Port::Find
+/*!	Look for a port by name
+//
+//	\param portName name of the port
+//	\return the port, NULL if there is none with this name
+*/
+//----------------------------------------------------------------------
+Port *
+Port::Find(char *portName)
+{
+  for (Port *port = ports.First(); port != NULL; port = ports.Next(port))
+    if (strcmp(port->name, portName) == 0)
+      return port;
+  return NULL;
+}
+
+//----------------------------------------------------------------------
+// Port::Release
+/*!	Drop a reference on a port
+//
+//	\param port the port, deleted if no reference is left
+*/
+//----------------------------------------------------------------------
+void
+Port::Release(Port *port)
+{
+  ASSERT(port->refs > 0);
+  if (--port->refs == 0)
+    delete port;
+}
+
+//----------------------------------------------------------------------
+// Port::Send
+/*!	Move the pages of a buffer out of an address space, into a new
+//	message. The buffer then reads as zeroes in the sender.
+//
+//	\param space the address space of the sender
+//	\param addr virtual address of the buffer (page-aligned)
+//	\param size size of the buffer (bytes)
+//	\return NO_ERROR, or an error code (see msgerror.h)
+*/
+//----------------------------------------------------------------------
+int
+Port::Send(AddrSpace *space, uint64_t addr, int size)
+{
+  int numPages = divRoundUp(size, g_cfg->PageSize);
+  uint64_t vpn = addr / g_cfg->PageSize;
+
+  if (size <= 0)
+    return INVALID_SIZE;
+  if (addr % g_cfg->PageSize != 0)
+    return INVALID_USER_ADDRESS;
+
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  while (numMessages == PORT_MAX_MESSAGES)
+    notFull->Wait();
+
+  if (!space->CanMovePages(vpn, numPages)) {
+    g_machine->interrupt->SetStatus(oldLevel);
+    return INVALID_USER_ADDRESS;
+  }
+  PortMessage *message = new PortMessage(numPages, size);
+  int err = space->DetachPages(vpn, numPages, message->frames);
+  if (err != NO_ERROR) {
+    delete message;
+    g_machine->interrupt->SetStatus(oldLevel);
+    return err;
+  }
+  messages.Append(message);
+  numMessages++;
+  notEmpty->Signal();
+
+  g_machine->interrupt->SetStatus(oldLevel);
+  DEBUG('a', (char *)"Port %s: %d pages sent\n", name, numPages);
+  return NO_ERROR;
+}
+
+//----------------------------------------------------------------------
+// Port::Receive
+/*!	Wait for a message, and map its pages in an address space in
+//	place of the pages of a buffer. Pages of the buffer beyond the
+//	message are left unchanged.
+//
+//	\param space the address space of the receiver
+//	\param addr virtual address of the buffer (page-aligned)
+//	\param maxSize size of the buffer (bytes)
+//	\param err NO_ERROR, or an error code when ERROR is returned
+//	\return the size of the message, ERROR on error (the message is
+//	       then left on the port)
+*/
+//----------------------------------------------------------------------
+int
+Port::Receive(AddrSpace *space, uint64_t addr, int maxSize, int *err)
+{
+  uint64_t vpn = addr / g_cfg->PageSize;
+  *err = NO_ERROR;
+
+  if (addr % g_cfg->PageSize != 0) {
+    *err = INVALID_USER_ADDRESS;
+    return ERROR;
+  }
+
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  while (numMessages == 0)
+    notEmpty->Wait();
+
+  PortMessage *message = messages.First();
+  if (maxSize < 0 || message->numPages * g_cfg->PageSize > (uint32_t)maxSize)
+    *err = INVALID_SIZE;
+  else if (!space->CanMovePages(vpn, message->numPages))
+    *err = INVALID_USER_ADDRESS;
+  if (*err != NO_ERROR) {
+    g_machine->interrupt->SetStatus(oldLevel);
+    return ERROR;
+  }
+
+  messages.RemoveItem(message);
+  numMessages--;
+  space->AttachPages(vpn, message->numPages, message->frames);
+  notFull->Signal();
+
+  g_machine->interrupt->SetStatus(oldLevel);
+  DEBUG('a', (char *)"Port %s: %d pages received\n", name, message->numPages);
+  int size = message->size;
+  delete message;
+  return size;
+}
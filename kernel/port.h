@@ -0,0 +1,100 @@
+/*! \file port.h
+    \brief Message ports moving whole pages between address spaces
+
+    A message sent on a port is a page-aligned buffer of the sender.
+    Instead of copying it, the kernel takes its physical pages out of
+    the sender address space and maps them in the receiver address
+    space, at the address given to Receive: the cost of a message is
+    a few page table updates, whatever its size.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef PORT_H
+#define PORT_H
+
+#include "kernel/copyright.h"
+#include "kernel/system.h"
+#include "utility/queue.h"
+
+class AddrSpace;
+class Condition;
+
+//! Maximum number of messages queued on a port
+#define PORT_MAX_MESSAGES 8
+
+/*! \brief A message in transit: physical pages owned by no address space
+ */
+class PortMessage {
+public:
+  PortMessage(int numPages, int size);
+  ~PortMessage();
+
+  int numPages;      //!< Number of pages of the message
+  int size;          //!< Size of the message (bytes)
+  int *frames;       //!< Physical pages of the message
+  QueueLink link;    //!< Link in the queue of the port
+};
+
+/*! \brief Defines a message port
+//
+// Ports are named, so that unrelated processes can find them.
+//
+//	Send(space, addr, size) -- move the pages of [addr, addr+size[
+//	        out of space into a new message, blocking while the
+//	        port is full
+//
+//	Receive(space, addr, maxSize) -- block until a message is
+//	        queued, and map its pages at addr in space
+*/
+class Port {
+public:
+  //! Create a port (see Find for an existing one)
+  Port(char *debugName);
+
+  //! Delete a port, freeing the pages of the queued messages
+  ~Port();
+
+  //! Return the port called name, NULL if none
+  static Port *Find(char *name);
+
+  char *GetName() { return name; }
+
+  //! Take a reference on the port (one per object identifier, and
+  //  one per thread in Send or Receive)
+  void Open() { refs++; }
+
+  //! Drop a reference, deleting the port with its last one
+  static void Release(Port *port);
+
+  //! Send the pages of a buffer (return NO_ERROR or an error code)
+  int Send(AddrSpace *space, uint64_t addr, int size);
+
+  //! Receive a message in a buffer (return its size, ERROR on error)
+  int Receive(AddrSpace *space, uint64_t addr, int maxSize, int *err);
+
+  QueueLink portLink;  //!< Link in the list of ports
+
+private:
+  char *name;          //!< Name of the port
+  Queue<PortMessage, &PortMessage::link> messages; //!< Queued messages
+  int numMessages;     //!< Number of queued messages
+  int refs;            //!< Number of references (see Open)
+  Condition *notEmpty; //!< Signalled when a message is queued
+  Condition *notFull;  //!< Signalled when a message is received
+};
+
+#endif // PORT_H
@@ -19,6 +19,7 @@
 #include "kernel/system.h"
 #include "kernel/msgerror.h"
 #include "kernel/process.h"
+#include "kernel/pipe.h"
 
 //----------------------------------------------------------------------
 // Process::Process
@@ -34,6 +35,10 @@ Process::Process(char *filename, int *err)
 {
   numThreads=0;
   *err = NO_ERROR;
+  ringAddr = ringSqes = ringCqes = 0;
+  ringEntries = 0;
+  ringCqTail = ringCqReserved = 0;
+  stdinPipe = stdoutPipe = NULL;
   if (filename == NULL)
     {
       DEBUG('t', (char *)"Create empty process\n");
@@ -91,6 +96,9 @@ Process::~Process()
 {
   ASSERT(numThreads==0);
 
+  // Release the pipes used as standard input and output
+  Redirect(NULL, NULL);
+
   // Delete the address space. Done for all processes, even the one created
   // for startup, for which there is no executable file attached
   delete addrspace;
@@ -105,3 +113,28 @@ Process::~Process()
     // be displayed after the end of the process
   } 
 }
+
+//----------------------------------------------------------------------
+// Process::Redirect
+/*!   Redirect the standard input and output of the process. A
+//    reference is taken on the new pipes, and released on the
+//    previous ones.
+//
+//    \param in pipe read by Read on CONSOLE_INPUT, NULL for the console
+//    \param out pipe written by Write on CONSOLE_OUTPUT, NULL for
+//           the console
+*/
+//----------------------------------------------------------------------
+void Process::Redirect(Pipe *in, Pipe *out)
+{
+  if (in != NULL)
+    in->Open(PIPE_READ_END);
+  if (out != NULL)
+    out->Open(PIPE_WRITE_END);
+  if (stdinPipe != NULL)
+    Pipe::Release(stdinPipe, PIPE_READ_END);
+  if (stdoutPipe != NULL)
+    Pipe::Release(stdoutPipe, PIPE_WRITE_END);
+  stdinPipe = in;
+  stdoutPipe = out;
+}
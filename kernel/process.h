@@ -32,6 +32,7 @@
 class AddrSpace;
 class Thread;
 class Semaphore;
+class Pipe;
 
 /*! \brief Defines the data structures to keep track of the execution
  environment of a user program */
@@ -59,6 +60,31 @@ public:
 
   char * getName() {return(name);}    /*!< Returns the process name */
 
+  // Syscall ring registered by RingSetup (see exception.cc)
+  uint64_t ringAddr;                  /*!< Address of the Nachos_Ring,
+                                        0 if none */
+  uint64_t ringSqes;                  /*!< Address of the submission
+                                        queue entries */
+  uint64_t ringCqes;                  /*!< Address of the completion
+                                        queue entries */
+  uint32_t ringEntries;               /*!< Number of entries of each
+                                        queue */
+  uint32_t ringCqTail;                /*!< Tail of the completion queue,
+                                        only written by the kernel */
+  uint32_t ringCqReserved;            /*!< Completion slots reserved by
+                                        requests being executed */
+
+  // Standard input and output, inherited by the processes it creates
+  Pipe *stdinPipe;                    /*!< Pipe read by Read on
+                                        CONSOLE_INPUT, NULL for the
+                                        console */
+  Pipe *stdoutPipe;                   /*!< Pipe written by Write on
+                                        CONSOLE_OUTPUT, NULL for the
+                                        console */
+
+  /*! Redirect the standard input and output (NULL for the console) */
+  void Redirect(Pipe *in, Pipe *out);
+
 private:
   char *name;
 };
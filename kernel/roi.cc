@@ -0,0 +1,143 @@
+/*! \file roi.cc
+//  \brief Routines to account for the regions of interest
+//
+//	A region only costs two snapshots of the machine counters, one
+//	when it begins and one when it ends.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "kernel/roi.h"
+#include "kernel/msgerror.h"
+#include "utility/stats.h"
+
+//----------------------------------------------------------------------
+// RoiManager::RoiManager
+//!	Initialize without any region
+//----------------------------------------------------------------------
+RoiManager::RoiManager()
+{
+  memset(regions, 0, sizeof(regions));
+  numRegions = 0;
+  active = -1;
+  beginTicks = 0;
+  memset(beginEvents, 0, sizeof(beginEvents));
+}
+
+//----------------------------------------------------------------------
+// RoiManager::~RoiManager
+//!	Nothing is allocated
+//----------------------------------------------------------------------
+RoiManager::~RoiManager()
+{
+}
+
+//----------------------------------------------------------------------
+// RoiManager::Begin
+/*!	Start a region, ending the active one if any, and enable the
+//	detailed instrumentation
+//
+//	\param name name of the region
+//	\return NO_ERROR, or TOO_MANY_ROIS if there are already ROI_MAX
+//	       regions with other names
+*/
+//----------------------------------------------------------------------
+int
+RoiManager::Begin(char *name)
+{
+  if (active != -1)
+    Close();
+
+  int r;
+  for (r = 0; r < numRegions; r++)
+    if (strncmp(regions[r].name, name, ROI_NAME_LEN - 1) == 0)
+      break;
+  if (r == numRegions) {
+    if (numRegions == ROI_MAX)
+      return TOO_MANY_ROIS;
+    strncpy(regions[r].name, name, ROI_NAME_LEN - 1);
+    regions[r].name[ROI_NAME_LEN - 1] = '\0';
+    numRegions++;
+  }
+
+  DEBUG('e', (char *)"Region of interest \"%s\" begins\n", regions[r].name);
+  active = r;
+  regions[r].numEntries++;
+  beginTicks = g_stats->getTotalTicks();
+  memcpy(beginEvents, g_stats->hpmEvents, sizeof(beginEvents));
+  g_stats->detailed = true;
+  return NO_ERROR;
+}
+
+//----------------------------------------------------------------------
+// RoiManager::End
+/*!	End the active region, and go back to the fast mode if
+//	FastForward is set
+//
+//	\return NO_ERROR, or NO_ACTIVE_ROI if no region is active
+*/
+//----------------------------------------------------------------------
+int
+RoiManager::End()
+{
+  if (active == -1)
+    return NO_ACTIVE_ROI;
+  DEBUG('e', (char *)"Region of interest \"%s\" ends\n", regions[active].name);
+  Close();
+  g_stats->detailed = !g_cfg->FastForward;
+  return NO_ERROR;
+}
+
+//----------------------------------------------------------------------
+// RoiManager::Close
+//!	Account for the time and the events since the active region
+//	began, and leave it
+//----------------------------------------------------------------------
+void
+RoiManager::Close()
+{
+  RoiStat *r = &regions[active];
+  r->ticks += g_stats->getTotalTicks() - beginTicks;
+  for (int e = 0; e < NUM_HPM_EVENTS; e++)
+    r->events[e] += g_stats->hpmEvents[e] - beginEvents[e];
+  active = -1;
+}
+
+//----------------------------------------------------------------------
+// RoiManager::Print
+//!	Print the counters of each region, a region still active being
+//	ended first
+//----------------------------------------------------------------------
+void
+RoiManager::Print()
+{
+  if (active != -1)
+    Close();
+  if (numRegions == 0)
+    return;
+
+  printf("Regions of interest:\n");
+  printf("  %-20s %6s %12s %12s %12s %8s %8s %8s\n", "name", "runs",
+	 "cycles", "instructions", "mem accesses", "faults", "syscalls",
+	 "switches");
+  for (int i = 0; i < numRegions; i++) {
+    RoiStat *r = &regions[i];
+    printf("  %-20s %6" PRIu64 " %12" PRIu64 " %12" PRIu64 " %12" PRIu64
+	   " %8" PRIu64 " %8" PRIu64 " %8" PRIu64 "\n", r->name,
+	   r->numEntries, (uint64_t)r->ticks, r->events[HPM_INSTRUCTIONS],
+	   r->events[HPM_MEMORY_ACCESSES], r->events[HPM_PAGE_FAULTS],
+	   r->events[HPM_SYSCALLS], r->events[HPM_CONTEXT_SWITCHES]);
+  }
+}
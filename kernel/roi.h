@@ -0,0 +1,90 @@
+/*! \file roi.h
+    \brief Regions of interest of user programs
+
+    A program brackets the phase it wants to measure with RoiBegin
+    and RoiEnd. The counters of the machine (cycles, instructions,
+    memory accesses...) are accumulated per named region, and
+    reported separately at halt.
+
+    With FastForward set in the configuration file, the detailed
+    instrumentation (instruction and system call traces, system call
+    timing, page fault profile, interrupts-off measurement) is only
+    enabled inside the regions: the setup phases of a long program
+    then run in a fast functional mode.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef ROI_H
+#define ROI_H
+
+#include "kernel/copyright.h"
+#include "kernel/system.h"
+#include "utility/config.h"
+
+//! Maximum number of distinct regions
+#define ROI_MAX 16
+
+//! Length of the names kept for the regions
+#define ROI_NAME_LEN 32
+
+/*! \brief Counters accumulated over the executions of a region
+ */
+typedef struct {
+  char name[ROI_NAME_LEN];          //!< Name given to RoiBegin
+  uint64_t numEntries;              //!< Number of times the region was entered
+  Time ticks;                       //!< Time spent in the region
+  uint64_t events[NUM_HPM_EVENTS];  //!< Machine events in the region (HPM_*)
+} RoiStat;
+
+/*! \brief Defines the regions of interest
+//
+// At most one region is active at a time, for the whole machine:
+// beginning a region ends the active one. Regions with the same name
+// are accumulated.
+//
+//	Begin(name) -- end the active region if any, and start the
+//	        region name, switching to detailed instrumentation
+//
+//	End() -- end the active region, going back to the fast mode
+//	        if FastForward is set
+*/
+class RoiManager {
+public:
+  RoiManager();
+  ~RoiManager();
+
+  //! Start a region (NO_ERROR, or TOO_MANY_ROIS)
+  int Begin(char *name);
+
+  //! End the active region (NO_ERROR, or NO_ACTIVE_ROI)
+  int End();
+
+  //! Print the counters of each region
+  void Print();
+
+private:
+  //! Add the counters since the region began to the active region
+  void Close();
+
+  RoiStat regions[ROI_MAX];   //!< Regions, in the order of their first entry
+  int numRegions;             //!< Number of regions used
+  int active;                 //!< Index of the active region, -1 if none
+  Time beginTicks;            //!< Date the active region began
+  uint64_t beginEvents[NUM_HPM_EVENTS]; //!< Machine events at that date
+};
+
+#endif // ROI_H
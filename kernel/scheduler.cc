@@ -31,6 +31,27 @@
 #include "kernel/system.h"
 #include "kernel/thread.h"
 
+//----------------------------------------------------------------------
+// SchedStats
+/*!	Gather the statistics a scheduling event of a thread is
+//	recorded in: those of the thread, of its process and of Nachos.
+//
+//	\param thread the thread concerned by the event
+//	\param stats array filled with the statistics
+//	\return the number of statistics in stats
+*/
+//----------------------------------------------------------------------
+static int
+SchedStats(Thread *thread, SchedStat *stats[3])
+{
+  int n = 0;
+  stats[n++] = &thread->schedStat;
+  if (thread->GetProcessOwner() != NULL)
+    stats[n++] = &thread->GetProcessOwner()->stat->schedStat;
+  stats[n++] = &g_stats->schedStat;
+  return n;
+}
+
 //----------------------------------------------------------------------
 //  Scheduler::Scheduler
 /*! 	Constructor. Initialize the list of ready but not 
@@ -39,7 +60,8 @@
 //----------------------------------------------------------------------
 Scheduler::Scheduler()
 { 
-    readyList = new Listint; 
+    readyList = new ThreadQueue; 
+    preempting = false;
 } 
 
 //----------------------------------------------------------------------
@@ -64,25 +86,63 @@ void
 Scheduler::ReadyToRun (Thread *thread)
 {
     DEBUG('t', (char *)"Putting thread %s in ready list.\n", thread->GetName());
-    readyList->Append((void *)thread);
+    Time now = g_stats->getTotalTicks();
+
+    // A thread other than the running one was blocked (or has just
+    // been created)
+    if (thread != g_current_thread) {
+      SchedStat *stats[3];
+      int n = SchedStats(thread, stats);
+      for (int i = 0; i < n; i++)
+	stats[i]->blockedTicks += now - thread->blockDate;
+    }
+    thread->readyDate = now;
+    EnqueueByPriority(readyList, thread);
+
+    // An interrupt handler cannot switch threads: ask for it on return
+    if (thread->GetPriority() > g_current_thread->GetPriority()
+	&& g_machine->interrupt->InHandler())
+      g_machine->interrupt->YieldOnReturn();
 }
 
 //----------------------------------------------------------------------
 // Scheduler::FindNextToRun
-/*! 	Return the next thread to be scheduled onto the CPU.
+/*! 	Return the next thread to be scheduled onto the CPU: the
+//	first of the ready list, which is sorted by priority.
 //	If there are no ready threads, return NULL.
 // Side effect:
 //	Thread is removed from the ready list.
+// \param minPriority return NULL if the next thread has a lower priority
 // \return Thread to be scheduled on the CPU
 */
 //----------------------------------------------------------------------
 Thread *
-Scheduler::FindNextToRun ()
+Scheduler::FindNextToRun (int minPriority)
 {
-  Thread * thread=(Thread*)readyList->Remove();
+  Thread *thread = readyList->First();
+  if (thread == NULL || thread->GetPriority() < minPriority)
+    return NULL;
+  readyList->RemoveItem(thread);
   return thread;
 }
 
+//----------------------------------------------------------------------
+// Scheduler::CountBoost
+/*! 	Record that a thread inherited a higher priority through a
+//	lock (see Thread::UpdatePriority)
+//
+//	\param thread the boosted thread
+*/
+//----------------------------------------------------------------------
+void
+Scheduler::CountBoost (Thread *thread)
+{
+    SchedStat *stats[3];
+    int n = SchedStats(thread, stats);
+    for (int i = 0; i < n; i++)
+      stats[i]->numPriorityBoosts++;
+}
+
 //----------------------------------------------------------------------
 // Scheduler::SwitchTo
 /*! 	Dispatch the CPU to nextThread.  Save the state of the old thread,
@@ -107,9 +167,40 @@ Thread *oldThread = g_current_thread;
     DEBUG('t', (char *)"Switching from thread \"%s\" to thread \"%s\" time %llu\n",
 	  g_current_thread->GetName(), nextThread->GetName(),g_stats->getTotalTicks());
     
+    // Account for the time the old thread held the CPU, and for the
+    // time the new one waited on the ready list
+    Time now = g_stats->getTotalTicks();
+    SchedStat *stats[3];
+    int n = SchedStats(oldThread, stats);
+    bool preempted = preempting && readyList->IsQueued(oldThread);
+    // The new thread may not resume in Preempt
+    preempting = false;
+    for (int i = 0; i < n; i++) {
+      stats[i]->runTicks += now - oldThread->runDate;
+      if (preempted)
+	stats[i]->numInvoluntarySwitches++;
+      else
+	stats[i]->numVoluntarySwitches++;
+    }
+    if (!readyList->IsQueued(oldThread))
+      oldThread->blockDate = now;
+    oldThread->hpmEvents[HPM_CONTEXT_SWITCHES]++;
+    g_stats->hpmEvents[HPM_CONTEXT_SWITCHES]++;
+    n = SchedStats(nextThread, stats);
+    for (int i = 0; i < n; i++)
+      stats[i]->AddReadyLatency(now - nextThread->readyDate);
+    nextThread->runDate = now;
+    if (nextThread->GetProcessOwner() != NULL
+	&& nextThread->GetProcessOwner()->addrspace != NULL)
+      nextThread->GetProcessOwner()->addrspace->UpdateInfoPage(nextThread);
+
     // Modify the current thread
     g_current_thread = nextThread;
 
+    // A load-reserved of the old thread must not be matched by a
+    // store-conditional of the new one
+    g_machine->reservationValid = false;
+
     // Save the context of old thread
     oldThread->SaveProcessorState();
     oldThread->SaveSimulatorState();
@@ -138,6 +229,21 @@ Thread *oldThread = g_current_thread;
 
 }
 
+//----------------------------------------------------------------------
+// Scheduler::Preempt
+/*! 	Called on return from the timer interrupt handler: give the
+//	CPU to another ready thread, if any. Unlike a call to Yield by
+//	the thread itself, the switch is recorded as involuntary.
+*/
+//----------------------------------------------------------------------
+void
+Scheduler::Preempt()
+{
+    preempting = true;
+    g_current_thread->Yield();
+    preempting = false;
+}
+
 //----------------------------------------------------------------------
 // Scheduler::Print
 /*! 	Print the scheduler state -- in other words, the contents of
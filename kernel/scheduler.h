@@ -28,9 +28,7 @@
 #define SCHEDULER_H
 
 #include "kernel/copyright.h"
-#include "utility/list.h"
-
-class Thread;
+#include "kernel/thread.h"
 
 class Scheduler {
 public:
@@ -44,18 +42,28 @@ public:
   //! Inserts a thread in the ready list
   void ReadyToRun(Thread* thread);
     
-  //! Dequeue first thread of the ready list, if any, and return thread. 
-  Thread* FindNextToRun();
+  //! Dequeue the most urgent thread of the ready list, if its priority
+  //! is at least minPriority, and return it.
+  Thread* FindNextToRun(int minPriority = MIN_PRIORITY);
     		
   //! Causes a context switch to nextThread
   void SwitchTo(Thread* nextThread);
+
+  //! Preempt the current thread at the end of its quantum
+  void Preempt();
     
+  //! Record a priority boost of a thread in the statistics
+  void CountBoost(Thread* thread);
+
   //! Print contents of ready list.  
   void Print();
 
 protected:  
   //! Queue of threads that are ready to run, but not running.
-  Listint *readyList;
+  ThreadQueue *readyList;
+
+  //! true while the current thread is being preempted
+  bool preempting;
 };
 
 #endif // SCHEDULER_H
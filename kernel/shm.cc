@@ -0,0 +1,114 @@
+/*! \file shm.cc
+//  \brief Routines to manage shared memory segments
+//
+//	The pages of a segment have one reference for the segment, and
+//	one for each address space where it is mapped (see
+//	AddrSpace::MapShared).
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "kernel/shm.h"
+#include "vm/physMem.h"
+#include "kernel/msgerror.h"
+#include "machine/machine.h"
+#include "utility/config.h"
+
+//! Existing segments
+static Queue<ShmSegment, &ShmSegment::shmLink> segments;
+
+//----------------------------------------------------------------------
+// ShmSegment::ShmSegment
+/*!	Create a segment, and allocate its pages filled with zeroes
+//
+//	\param debugName name of the segment
+//	\param segSize size of the segment (bytes)
+//	\param err NO_ERROR, INVALID_SIZE or OUT_OF_MEMORY. The segment
+//	       must be deleted on error.
+*/
+//----------------------------------------------------------------------
+ShmSegment::ShmSegment(char *debugName, int segSize, int *err)
+{
+  name = new char[strlen(debugName) + 1];
+  strcpy(name, debugName);
+  size = segSize;
+  numPages = 0;
+  frames = NULL;
+  refs = 0;
+  segments.Append(this);
+
+  *err = NO_ERROR;
+  if (size <= 0) {
+    *err = INVALID_SIZE;
+    return;
+  }
+  frames = new int[divRoundUp(size, g_cfg->PageSize)];
+  while (numPages < (int)divRoundUp(size, g_cfg->PageSize)) {
+    int pp = g_physical_mem_manager->AllocSharedFrame();
+    if (pp == INVALID_PAGE) {
+      *err = OUT_OF_MEMORY;
+      return;
+    }
+    frames[numPages++] = pp;
+  }
+  DEBUG('a', (char *)"Shared memory segment %s: %d pages\n", name, numPages);
+}
+
+//----------------------------------------------------------------------
+// ShmSegment::~ShmSegment
+/*!	Delete a segment. Its pages are freed once unmapped from all the
+//	address spaces.
+*/
+//----------------------------------------------------------------------
+ShmSegment::~ShmSegment()
+{
+  for (int i = 0; i < numPages; i++)
+    g_physical_mem_manager->RemovePhysicalToVirtualMapping(frames[i]);
+  segments.RemoveItem(this);
+  delete [] frames;
+  delete [] name;
+}
+
+//----------------------------------------------------------------------
+// ShmSegment::Find
+/*!	Look for a segment by name
+//
+//	\param segName name of the segment
+//	\return the segment, NULL if there is none with this name
+*/
+//----------------------------------------------------------------------
+ShmSegment *
+ShmSegment::Find(char *segName)
+{
+  for (ShmSegment *seg = segments.First(); seg != NULL; seg = segments.Next(seg))
+    if (strcmp(seg->name, segName) == 0)
+      return seg;
+  return NULL;
+}
+
+//----------------------------------------------------------------------
+// ShmSegment::Release
+/*!	Drop a reference on a segment
+//
+//	\param segment the segment, deleted if no reference is left
+*/
+//----------------------------------------------------------------------
+void
+ShmSegment::Release(ShmSegment *segment)
+{
+  ASSERT(segment->refs > 0);
+  if (--segment->refs == 0)
+    delete segment;
+}
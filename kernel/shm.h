@@ -0,0 +1,74 @@
+/*! \file shm.h
+    \brief Shared memory segments between processes
+
+    A segment is a set of physical pages that several address spaces
+    map at once: what a process writes in the segment is seen at once
+    by the others, without any system call. Access to the segment is
+    synchronized with the other system calls (semaphores, or futexes
+    on words of the segment, keyed by their physical address so that
+    a wake in one process reaches the waiters of the others).
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef SHM_H
+#define SHM_H
+
+#include "kernel/copyright.h"
+#include "kernel/system.h"
+#include "utility/queue.h"
+
+/*! \brief Defines a shared memory segment
+//
+// Segments are named, so that unrelated processes can find them.
+// A segment is referenced by its object identifiers: it is deleted
+// with the last one. Its physical pages are reference counted by
+// the physical memory manager, so they stay mapped in the address
+// spaces where the segment is attached after it is deleted.
+*/
+class ShmSegment {
+public:
+  //! Create a zeroed segment of size bytes (see Find for an existing one)
+  ShmSegment(char *debugName, int size, int *err);
+
+  //! Drop the reference of the segment on its pages
+  ~ShmSegment();
+
+  //! Return the segment called name, NULL if none
+  static ShmSegment *Find(char *name);
+
+  char *GetName() { return name; }
+  int GetSize() { return size; }
+  int GetNumPages() { return numPages; }
+  int *GetFrames() { return frames; }
+
+  //! Take a reference on the segment (one per object identifier)
+  void Open() { refs++; }
+
+  //! Drop a reference, deleting the segment with its last one
+  static void Release(ShmSegment *segment);
+
+  QueueLink shmLink;   //!< Link in the list of segments
+
+private:
+  char *name;          //!< Name of the segment
+  int size;            //!< Size of the segment (bytes)
+  int numPages;        //!< Number of pages of the segment
+  int *frames;         //!< Physical pages of the segment
+  int refs;            //!< Number of object identifiers of the segment
+};
+
+#endif // SHM_H
@@ -0,0 +1,137 @@
+/*! \file softirq.cc
+//  \brief Routines to execute the work deferred by interrupt handlers
+//
+//	The thread disables interrupts only to take a work from its
+//	queue: the work itself runs with interrupts enabled, and takes
+//	the locks and disables interrupts as any other kernel code.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "kernel/softirq.h"
+#include "kernel/msgerror.h"
+#include "kernel/scheduler.h"
+#include "kernel/thread.h"
+#include "machine/machine.h"
+#include "utility/stats.h"
+
+//----------------------------------------------------------------------
+// DeferredWork::DeferredWork
+/*!	Initialize a work, not queued
+//
+//	\param workFunc function executing the work
+//	\param workArg its argument
+*/
+//----------------------------------------------------------------------
+DeferredWork::DeferredWork(VoidFunctionPtr workFunc, int64_t workArg)
+{
+  func = workFunc;
+  arg = workArg;
+  queued = false;
+  raisedAt = 0;
+}
+
+//----------------------------------------------------------------------
+// SoftIrq::SoftIrq
+/*!	Create the thread executing the deferred work. It has the
+//	highest priority, so that it runs as soon as the handler which
+//	raised a work returns.
+//
+//	\param owner the process of the thread
+*/
+//----------------------------------------------------------------------
+SoftIrq::SoftIrq(Process *owner)
+{
+  idle = false;
+  numRaised = 0;
+  numRuns = 0;
+  maxDelay = 0;
+  worker = new Thread((char *)"softirq");
+  worker->SetPriority(MAX_PRIORITY);
+  if (worker->StartKernel(owner, Worker, (int64_t)this) != NO_ERROR) {
+    fprintf(stderr, "Nachos boot error: cannot start the softirq thread\n");
+    exit(ERROR);
+  }
+}
+
+//----------------------------------------------------------------------
+// SoftIrq::Raise
+/*!	Queue a work for the thread, unless it is already queued. Called
+//	by interrupt handlers, with interrupts disabled.
+//
+//	\param work the work
+*/
+//----------------------------------------------------------------------
+void
+SoftIrq::Raise(DeferredWork *work)
+{
+  ASSERT(g_machine->interrupt->GetStatus() == INTERRUPTS_OFF);
+  numRaised++;
+  if (work->queued)
+    return;
+  work->queued = true;
+  work->raisedAt = g_stats->getTotalTicks();
+  pending.Append(work);
+  if (idle) {
+    idle = false;
+    g_scheduler->ReadyToRun(worker);
+  }
+}
+
+//----------------------------------------------------------------------
+// SoftIrq::Print
+//!	Print the number of works executed and their longest delay
+//----------------------------------------------------------------------
+void
+SoftIrq::Print()
+{
+  printf("Deferred work: %" PRIu64 " raised, %" PRIu64
+	 " executed, longest delay %" PRIu64 " cycles\n",
+	 numRaised, numRuns, (uint64_t)maxDelay);
+}
+
+//----------------------------------------------------------------------
+// SoftIrq::Worker
+/*!	Body of the thread: execute the works in the order they were
+//	raised, forever.
+//
+//	\param arg the SoftIrq
+*/
+//----------------------------------------------------------------------
+void
+SoftIrq::Worker(int64_t arg)
+{
+  SoftIrq *softirq = (SoftIrq *)arg;
+
+  for (;;) {
+    IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+    DeferredWork *work;
+    while ((work = softirq->pending.Remove()) == NULL) {
+      softirq->idle = true;
+      g_current_thread->Sleep();
+    }
+    // The work may be raised again from now on
+    work->queued = false;
+    Time delay = g_stats->getTotalTicks() - work->raisedAt;
+    if (delay > softirq->maxDelay)
+      softirq->maxDelay = delay;
+    softirq->numRuns++;
+    g_machine->interrupt->SetStatus(oldLevel);
+
+    DEBUG('i', (char *)"Softirq: deferred work after %" PRIu64 " cycles\n",
+	  (uint64_t)delay);
+    (*work->func)(work->arg);
+  }
+}
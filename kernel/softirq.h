@@ -0,0 +1,84 @@
+/*! \file softirq.h
+    \brief Work deferred by the interrupt handlers
+
+    Interrupt handlers run with interrupts disabled: the longer they
+    run, the longer the other devices wait for their own interrupt.
+    A handler with real work to do only records what happened and
+    raises a DeferredWork, which a kernel thread of the highest
+    priority then executes with interrupts enabled, as soon as the
+    handler returns.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef SOFTIRQ_H
+#define SOFTIRQ_H
+
+#include "kernel/copyright.h"
+#include "kernel/system.h"
+#include "utility/queue.h"
+
+class Process;
+class Thread;
+
+/*! \brief A piece of work deferred by an interrupt handler
+//
+// Usually embedded in the object of the device. A work raised again
+// before it was executed is executed only once: func must handle
+// everything that happened since its previous execution.
+*/
+class DeferredWork {
+public:
+  DeferredWork(VoidFunctionPtr func, int64_t arg);
+
+  VoidFunctionPtr func; //!< Function executing the work
+  int64_t arg;          //!< Its argument
+  bool queued;          //!< true while waiting to be executed
+  Time raisedAt;        //!< Date it was raised (while queued)
+  QueueLink link;       //!< Link in the queue of the SoftIrq
+};
+
+/*! \brief Defines the thread executing the deferred work
+//
+//	Raise(work) -- queue work, called by an interrupt handler
+//
+//	Print() -- print the number of executions and the longest
+//	        delay between Raise and the execution
+*/
+class SoftIrq {
+public:
+  //! Start the thread, attached to process owner
+  SoftIrq(Process *owner);
+
+  //! Queue a work (interrupts must be disabled)
+  void Raise(DeferredWork *work);
+
+  //! Print the number of works executed and their delays
+  void Print();
+
+private:
+  //! Body of the thread
+  static void Worker(int64_t arg);
+
+  Queue<DeferredWork, &DeferredWork::link> pending; //!< Works to execute
+  Thread *worker;         //!< The thread
+  bool idle;              //!< true while the thread waits for work
+  uint64_t numRaised;     //!< Number of calls to Raise
+  uint64_t numRuns;       //!< Number of works executed
+  Time maxDelay;          //!< Longest time between Raise and execution
+};
+
+#endif // SOFTIRQ_H
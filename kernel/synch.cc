@@ -1,304 +1,867 @@
-/*! \file synch.cc 
-//  \brief Routines for synchronizing threads.  
-//
-//      Three kinds of synchronization routines are defined here: 
-//      semaphores, locks and condition variables.
-//
-// Any implementation of a synchronization routine needs some
-// primitive atomic operation. We assume Nachos is running on
-// a uniprocessor, and thus atomicity can be provided by
-// turning off interrupts. While interrupts are disabled, no
-// context switch can occur, and thus the current thread is guaranteed
-// to hold the CPU throughout, until interrupts are reenabled.
-//
-// Because some of these routines might be called with interrupts
-// already disabled (Semaphore::V for one), instead of turning
-// on interrupts at the end of the atomic operation, we always simply
-// re-set the interrupt state back to its original value (whether
-// that be disabled or enabled).
- * -----------------------------------------------------
- * This file is part of the Nachos-RiscV distribution
- * Copyright (c) 2022 University of Rennes 1.
- * 
- * This program is free software: you can redistribute it and/or modify  
- * it under the terms of the GNU General Public License as published by  
- * the Free Software Foundation, version 3.
- *
- * This program is distributed in the hope that it will be useful, but 
- * WITHOUT ANY WARRANTY; without even the implied warranty of 
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
- * General Public License for more details 
- * (see see <http://www.gnu.org/licenses/>).
- * -----------------------------------------------------
-*/
-
-#include "kernel/msgerror.h"
-#include "kernel/system.h" 
-#include "kernel/scheduler.h"
-#include "kernel/synch.h"
-#include "machine/interrupt.h"
-
-//----------------------------------------------------------------------
-// Semaphore::Semaphore
-/*! 	Initializes a semaphore, so that it can be used for synchronization.
-//
-// \param debugName is an arbitrary name, useful for debugging only.
-// \param initialValue is the initial value of the semaphore.
-*/
-//----------------------------------------------------------------------
-Semaphore::Semaphore(char* debugName, uint32_t initialCount)
-{
-  name = new char[strlen(debugName)+1];
-  strcpy(name,debugName);
-  counter = initialCount;
-  waiting_queue = new Listint;
-  type = SEMAPHORE_TYPE;
-}
-
-//----------------------------------------------------------------------
-// Semaphore::Semaphore
-/*! 	De-allocates a semaphore, when no longer needed.  Assume no one
-//	is still waiting on the semaphore!
-*/
-//----------------------------------------------------------------------
-Semaphore::~Semaphore()
-{
-  type = INVALID_TYPE;
-  if (!waiting_queue->IsEmpty()) {
-    DEBUG('s', (char *)"Destructor of semaphore \"%s\", queue is not empty!!\n",name);
-    Thread *t =  (Thread *)waiting_queue->Remove();
-    DEBUG('s', (char *)"Queue contents %s\n",t->GetName());
-    waiting_queue->Append((void *)t);
-  }
-  ASSERT(waiting_queue->IsEmpty());
-  delete [] name;
-  delete waiting_queue;
-}
-
-//----------------------------------------------------------------------
-// Semaphore::P
-/*!
-//      Decrement the value, and wait if it becomes < 0. Checking the
-//	value and decrementing must be done atomically, so we
-//	need to disable interrupts before checking the value.
-//
-//	Note that Thread::Sleep assumes that interrupts are disabled
-//	when it is called.
-*/
-//----------------------------------------------------------------------
-
-void Semaphore::P() {
-  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
-
-  // Decrement the semaphore counter
-  counter--;
-
-  // If the counter is negative, put the calling thread to sleep
-  if (counter < 0) {
-    waiting_queue->Append((void *)g_current_thread);
-    g_current_thread->Sleep();
-  }
-
-  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
-}
-
-
-//----------------------------------------------------------------------
-// Semaphore::V
-/*! 	Increment semaphore value, waking up a waiting thread if any.
-//	As with P(), this operation must be atomic, so we need to disable
-//	interrupts.  Scheduler::ReadyToRun() assumes that interrupts
-//	are disabled when it is called.
-*/
-//----------------------------------------------------------------------
-void Semaphore::V() {
-  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
-
-  // Increment the semaphore counter
-  counter++;
-
-  // If there are threads waiting, wake up the first one
-  if (counter <= 0) {
-    Thread *t = (Thread *)waiting_queue->Remove();
-    g_scheduler->ReadyToRun(t);
-  }
-
-  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
-}
-
-
-//----------------------------------------------------------------------
-// Lock::Lock
-/*! 	Initialize a Lock, so that it can be used for synchronization.
-//      The lock is initialy free
-//  \param "debugName" is an arbitrary name, useful for debugging.
-*/
-//----------------------------------------------------------------------
-Lock::Lock(char* debugName) {
-  name = new char[strlen(debugName)+1];
-  strcpy(name,debugName);
-  waiting_queue = new Listint;
-  free = true;
-  owner = NULL;
-  type = LOCK_TYPE;
-}
-
-
-//----------------------------------------------------------------------
-// Lock::~Lock
-/*! 	De-allocate lock, when no longer needed. Assumes that no thread
-//      is waiting on the lock.
-*/
-//----------------------------------------------------------------------
-Lock::~Lock() {
-  type = INVALID_TYPE;
-  ASSERT(waiting_queue->IsEmpty());
-  delete [] name;
-  delete waiting_queue;
-}
-
-//----------------------------------------------------------------------
-// Lock::Acquire
-/*! 	Wait until the lock become free.  Checking the
-//	state of the lock (free or busy) and modify it must be done
-//	atomically, so we need to disable interrupts before checking
-//	the value of free.
-//
-//	Note that Thread::Sleep assumes that interrupts are disabled
-//	when it is called.
-*/
-//----------------------------------------------------------------------
-void Lock::Acquire() {
-  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
-
-  // Wait until the lock becomes free
-  while (!free) {
-    waiting_queue->Append((void *)g_current_thread);
-    g_current_thread->Sleep();
-  }
-
-  // Acquire the lock
-  free = false;
-  owner = g_current_thread;
-
-  g_machine->interrupt->SetStatus(oldlevel);  // Restore interrupt state
-}
-
-
-//----------------------------------------------------------------------
-// Lock::Release
-/*! 	Wake up a waiter if necessary, or release it if no thread is waiting.
-//      We check that the lock is held by the g_current_thread.
-//	As with Acquire, this operation must be atomic, so we need to disable
-//	interrupts.  Scheduler::ReadyToRun() assumes that threads
-//	are disabled when it is called.
-*/
-//----------------------------------------------------------------------
-void Lock::Release() {
-  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
-
-  // Check if the lock is held by the current thread
-  ASSERT(isHeldByCurrentThread());
-
-  // If there are waiting threads, wake up the first one
-  if (!waiting_queue->IsEmpty()) {
-    Thread *t = (Thread *)waiting_queue->Remove();
-    g_scheduler->ReadyToRun(t);
-  } else {
-    // Release the lock
-    free = true;
-    owner = NULL;
-  }
-
-  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
-}
-
-
-//----------------------------------------------------------------------
-// Lock::isHeldByCurrentThread
-/*! To check if current thread hold the lock
-*/
-//----------------------------------------------------------------------
-bool Lock::isHeldByCurrentThread() {return (g_current_thread == owner);}	
-
-//----------------------------------------------------------------------
-// Condition::Condition
-/*! 	Initializes a Condition, so that it can be used for synchronization.
-//
-//    \param  "debugName" is an arbitrary name, useful for debugging.
-*/
-//----------------------------------------------------------------------
-Condition::Condition(char* debugName) { 
-  name = new char[strlen(debugName)+1];
-  strcpy(name,debugName);
-  waiting_queue = new Listint;
-  type = CONDITION_TYPE;
-}
-
-//----------------------------------------------------------------------
-// Condition::~Condition
-/*! 	De-allocate condition, when no longer needed.
-//      Assumes that nobody is waiting on the condition.
-*/
-//----------------------------------------------------------------------
-Condition::~Condition() {
-  type = INVALID_TYPE;
-  ASSERT(waiting_queue->IsEmpty());
-  delete [] name;
-  delete waiting_queue;
-}
-
-//----------------------------------------------------------------------
-// Condition::Wait
-/*! Block the calling thread (put it in the wait queue).
-//  This operation must be atomic, so we need to disable interrupts.
-*/	
-//----------------------------------------------------------------------
-void Condition::Wait() {
-  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
-
-  // Move the current thread to the condition's wait queue and put it to sleep
-  waiting_queue->Append((void *)g_current_thread);
-  g_current_thread->Sleep();
-
-  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
-}
-
-
-//----------------------------------------------------------------------
-// Condition::Signal
-/*! Wake up the first thread of the wait queue (if any). 
-// This operation must be atomic, so we need to disable interrupts.
-*/
-//----------------------------------------------------------------------
-void Condition::Signal() {
-  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
-
-  // If there are waiting threads, wake up the first one
-  if (!waiting_queue->IsEmpty()) {
-    Thread *t = (Thread *)waiting_queue->Remove();
-    g_scheduler->ReadyToRun(t);
-  }
-
-  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
-}
-
-
-//----------------------------------------------------------------------
-// Condition::Broadcast
-/*! Wake up all threads waiting in the waitqueue of the condition
-// This operation must be atomic, so we need to disable interrupts.
-*/
-//----------------------------------------------------------------------
-void Condition::Broadcast() {
-  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
-
-  // Wake up all threads in the wait queue
-  while (!waiting_queue->IsEmpty()) {
-    Thread *t = (Thread *)waiting_queue->Remove();
-    g_scheduler->ReadyToRun(t);
-  }
-
-  g_machine->interrupt->SetStatus(oldlevel);  // Restore interrupt state
-}
-
+/*! \file synch.cc 
+//  \brief Routines for synchronizing threads.  
+//
+//      Three kinds of synchronization routines are defined here: 
+//      semaphores, locks and condition variables.
+//
+// Any implementation of a synchronization routine needs some
+// primitive atomic operation. We assume Nachos is running on
+// a uniprocessor, and thus atomicity can be provided by
+// turning off interrupts. While interrupts are disabled, no
+// context switch can occur, and thus the current thread is guaranteed
+// to hold the CPU throughout, until interrupts are reenabled.
+//
+// Because some of these routines might be called with interrupts
+// already disabled (Semaphore::V for one), instead of turning
+// on interrupts at the end of the atomic operation, we always simply
+// re-set the interrupt state back to its original value (whether
+// that be disabled or enabled).
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ * 
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details 
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "kernel/msgerror.h"
+#include "kernel/system.h" 
+#include "kernel/scheduler.h"
+#include "kernel/synch.h"
+#include "kernel/alarm.h"
+#include "machine/interrupt.h"
+
+//----------------------------------------------------------------------
+// YieldToWoken
+/*!	Give the CPU at once to a thread just woken up, if it is more
+//	urgent than the current thread. Not done if the caller disabled
+//	interrupts itself: it expects no context switch until it enables
+//	them again.
+//
+//	\param woken the thread woken up, NULL if none
+//	\param oldlevel the interrupt level at the call of the operation
+*/
+//----------------------------------------------------------------------
+static void YieldToWoken(Thread *woken, IntStatus oldlevel)
+{
+  if (woken != NULL && oldlevel == INTERRUPTS_ON
+      && woken->GetPriority() > g_current_thread->GetPriority())
+    g_current_thread->Yield();
+}
+
+//----------------------------------------------------------------------
+// CopyName
+/*!	Copy a name for the contention report, truncated if needed
+//
+//	\param dest buffer of SYNCH_NAME_LEN characters
+//	\param name the name, NULL if unknown
+*/
+//----------------------------------------------------------------------
+static void
+CopyName(char *dest, const char *name)
+{
+  strncpy(dest, (name != NULL) ? name : "-", SYNCH_NAME_LEN - 1);
+  dest[SYNCH_NAME_LEN - 1] = '\0';
+}
+
+//! Statistics of the live synchronization objects
+static Queue<SynchStat, &SynchStat::link> liveStats;
+
+//! Most contended deleted objects, the least contended first
+static SynchProfile retiredStats[SYNCH_TOP_N];
+
+//! Number of entries used in retiredStats
+static int numRetired = 0;
+
+//----------------------------------------------------------------------
+// InsertTop
+/*!	Insert figures in a table of the most contended objects, sorted
+//	by increasing waitTicks, if they rank in it
+//
+//	\param top the table, of SYNCH_TOP_N entries
+//	\param num number of entries used, updated
+//	\param profile the figures
+*/
+//----------------------------------------------------------------------
+static void
+InsertTop(const SynchProfile **top, int *num, const SynchProfile *profile)
+{
+  int i;
+  if (*num < SYNCH_TOP_N)
+    i = (*num)++;
+  else if (profile->waitTicks > top[0]->waitTicks)
+    i = 0;
+  else
+    return;
+  // Move the entry up to its place
+  top[i] = profile;
+  while (i + 1 < *num && top[i]->waitTicks > top[i + 1]->waitTicks) {
+    const SynchProfile *tmp = top[i];
+    top[i] = top[i + 1];
+    top[i + 1] = tmp;
+    i++;
+  }
+  while (i > 0 && top[i]->waitTicks < top[i - 1]->waitTicks) {
+    const SynchProfile *tmp = top[i];
+    top[i] = top[i - 1];
+    top[i - 1] = tmp;
+    i--;
+  }
+}
+
+//----------------------------------------------------------------------
+// SynchStat::SynchStat
+/*!	Initialize the statistics of an object, and register them
+//
+//	\param kind kind of the object ("semaphore", "lock"...)
+//	\param name debug name of the object
+*/
+//----------------------------------------------------------------------
+SynchStat::SynchStat(const char *kind, const char *name)
+{
+  profile.kind = kind;
+  CopyName(profile.name, name);
+  profile.numAcquires = 0;
+  profile.numWaits = 0;
+  profile.waitTicks = 0;
+  profile.maxWait = 0;
+  profile.maxWaiter[0] = '\0';
+  profile.maxHolder[0] = '\0';
+  liveStats.Append(this);
+}
+
+//----------------------------------------------------------------------
+// SynchStat::~SynchStat
+/*!	Unregister the statistics of a deleted object, keeping a copy
+//	if the object ranks among the most contended deleted ones
+*/
+//----------------------------------------------------------------------
+SynchStat::~SynchStat()
+{
+  liveStats.RemoveItem(this);
+  if (profile.numWaits == 0)
+    return;
+
+  // retiredStats is sorted: replace its first entry, then sort again
+  int i;
+  if (numRetired < SYNCH_TOP_N)
+    i = numRetired++;
+  else if (profile.waitTicks > retiredStats[0].waitTicks)
+    i = 0;
+  else
+    return;
+  retiredStats[i] = profile;
+  while (i + 1 < numRetired
+	 && retiredStats[i].waitTicks > retiredStats[i + 1].waitTicks) {
+    SynchProfile tmp = retiredStats[i];
+    retiredStats[i] = retiredStats[i + 1];
+    retiredStats[i + 1] = tmp;
+    i++;
+  }
+  while (i > 0 && retiredStats[i].waitTicks < retiredStats[i - 1].waitTicks) {
+    SynchProfile tmp = retiredStats[i];
+    retiredStats[i] = retiredStats[i - 1];
+    retiredStats[i - 1] = tmp;
+    i--;
+  }
+}
+
+//----------------------------------------------------------------------
+// SynchStat::AddWait
+/*!	Record an acquisition during which the thread blocked. The names
+//	are only copied when the wait is the longest so far.
+//
+//	\param ticks time spent blocked (cycles)
+//	\param holder name of the thread holding the object when the
+//	       wait began (copied by the caller), NULL if unknown
+*/
+//----------------------------------------------------------------------
+void
+SynchStat::AddWait(Time ticks, const char *holder)
+{
+  profile.numAcquires++;
+  profile.numWaits++;
+  profile.waitTicks += ticks;
+  if (ticks > profile.maxWait) {
+    profile.maxWait = ticks;
+    CopyName(profile.maxWaiter, g_current_thread->GetName());
+    CopyName(profile.maxHolder, holder);
+  }
+}
+
+//----------------------------------------------------------------------
+// SynchStat::PrintTop
+/*!	Print the SYNCH_TOP_N objects, live or deleted, in which threads
+//	spent the most time blocked
+*/
+//----------------------------------------------------------------------
+void
+SynchStat::PrintTop()
+{
+  const SynchProfile *top[SYNCH_TOP_N];
+  int num = 0;
+
+  for (SynchStat *s = liveStats.First(); s != NULL; s = liveStats.Next(s))
+    if (s->profile.numWaits != 0)
+      InsertTop(top, &num, &s->profile);
+  for (int i = 0; i < numRetired; i++)
+    InsertTop(top, &num, &retiredStats[i]);
+
+  printf("Contention (most blocked synchronization objects first):\n");
+  for (int i = num - 1; i >= 0; i--)
+    printf("  %-9s %-20s %8" PRIu64 " acquires, %8" PRIu64 " blocked, %10"
+	   PRIu64 " cycles, max %" PRIu64 " (%s waiting for %s)\n",
+	   top[i]->kind, top[i]->name, top[i]->numAcquires, top[i]->numWaits,
+	   (uint64_t)top[i]->waitTicks, (uint64_t)top[i]->maxWait,
+	   top[i]->maxWaiter, top[i]->maxHolder);
+}
+
+//! Cache of the semaphores
+SlabCache Semaphore::slabCache("Semaphore", sizeof(Semaphore));
+
+//----------------------------------------------------------------------
+// Semaphore::Semaphore
+/*! 	Initializes a semaphore, so that it can be used for synchronization.
+//
+// \param debugName is an arbitrary name, useful for debugging only.
+// \param initialValue is the initial value of the semaphore.
+*/
+//----------------------------------------------------------------------
+Semaphore::Semaphore(char* debugName, uint32_t initialCount)
+  : stat("semaphore", debugName)
+{
+  name = new char[strlen(debugName)+1];
+  strcpy(name,debugName);
+  counter = initialCount;
+  waiting_queue = new ThreadQueue;
+  type = SEMAPHORE_TYPE;
+}
+
+//----------------------------------------------------------------------
+// Semaphore::Semaphore
+/*! 	De-allocates a semaphore, when no longer needed.  Assume no one
+//	is still waiting on the semaphore!
+*/
+//----------------------------------------------------------------------
+Semaphore::~Semaphore()
+{
+  type = INVALID_TYPE;
+  DEBUG('s', (char *)"Semaphore \"%s\": %" PRIu64 " waits, %" PRIu64 " cycles blocked\n",
+	name, stat.profile.numWaits, stat.profile.waitTicks);
+  if (!waiting_queue->IsEmpty()) {
+    DEBUG('s', (char *)"Destructor of semaphore \"%s\", queue is not empty!!\n",name);
+    Thread *t = waiting_queue->First();
+    DEBUG('s', (char *)"Queue contents %s\n",t->GetName());
+  }
+  ASSERT(waiting_queue->IsEmpty());
+  WaitSet::Notify(&watchers);
+  delete [] name;
+  delete waiting_queue;
+}
+
+//----------------------------------------------------------------------
+// Semaphore::P
+/*!
+//      Decrement the value, and wait if it becomes < 0. Checking the
+//	value and decrementing must be done atomically, so we
+//	need to disable interrupts before checking the value.
+//
+//	Note that Thread::Sleep assumes that interrupts are disabled
+//	when it is called.
+*/
+//----------------------------------------------------------------------
+
+void Semaphore::P() {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
+
+  // Decrement the semaphore counter
+  counter--;
+
+  // If the counter is negative, put the calling thread to sleep
+  if (counter < 0) {
+    Time start = g_stats->getTotalTicks();
+    EnqueueByPriority(waiting_queue, g_current_thread);
+    g_current_thread->Sleep();
+    stat.AddWait(g_stats->getTotalTicks() - start, NULL);
+  }
+  else
+    stat.AddAcquire();
+
+  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
+}
+
+
+//----------------------------------------------------------------------
+// Semaphore::TimedP
+/*! 	Same as P, but the thread gives up waiting at date deadline
+//	(see Alarm). The semaphore is then left unchanged.
+//
+//	\param deadline date (in cycles) to give up at
+//	\return true if the semaphore was decremented, false if the
+//	       deadline was reached first
+*/
+//----------------------------------------------------------------------
+bool Semaphore::TimedP(Time deadline) {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
+  bool acquired = true;
+
+  if (counter > 0) {
+    counter--;
+    stat.AddAcquire();
+  }
+  else if (deadline <= g_stats->getTotalTicks())
+    acquired = false;
+  else {
+    AlarmWaiter waiter;
+    Time start = g_stats->getTotalTicks();
+    counter--;
+    EnqueueByPriority(waiting_queue, g_current_thread);
+    waiter.thread = g_current_thread;
+    waiter.when = deadline;
+    waiter.sema = this;
+    g_alarm->Add(&waiter);
+    g_current_thread->Sleep();
+    // Woken up either by V or by the alarm (which called Cancel)
+    g_alarm->Remove(&waiter);
+    acquired = !waiter.expired;
+    stat.AddWait(g_stats->getTotalTicks() - start, NULL);
+  }
+
+  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
+  return acquired;
+}
+
+//----------------------------------------------------------------------
+// Semaphore::Cancel
+/*! 	Remove a thread blocked in TimedP from the waiting queue, as
+//	if it had not called it. Called with interrupts disabled.
+//
+//	\param thread the thread to remove
+//	\return true if the thread was waiting, false if it has already
+//	       been woken up by V
+*/
+//----------------------------------------------------------------------
+bool Semaphore::Cancel(Thread *thread) {
+  for (Thread *t = waiting_queue->First(); t != NULL; t = waiting_queue->Next(t))
+    if (t == thread) {
+      waiting_queue->RemoveItem(t);
+      counter++;
+      if (counter > 0)
+	WaitSet::Notify(&watchers);
+      return true;
+    }
+  return false;
+}
+
+//----------------------------------------------------------------------
+// Semaphore::TryP
+/*! 	Decrement the value if P would not block, else leave it
+//	unchanged. Used by WaitAny, which waits for several semaphores
+//	at once through their watch lists instead of their queues.
+//
+//	\return true if the semaphore was decremented
+*/
+//----------------------------------------------------------------------
+bool Semaphore::TryP() {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  bool acquired = (counter > 0);
+  if (acquired) {
+    counter--;
+    stat.AddAcquire();
+  }
+  g_machine->interrupt->SetStatus(oldlevel);
+  return acquired;
+}
+
+//----------------------------------------------------------------------
+// Semaphore::V
+/*! 	Increment semaphore value, waking up a waiting thread if any.
+//	As with P(), this operation must be atomic, so we need to disable
+//	interrupts.  Scheduler::ReadyToRun() assumes that interrupts
+//	are disabled when it is called.
+*/
+//----------------------------------------------------------------------
+void Semaphore::V() {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
+
+  // Increment the semaphore counter
+  counter++;
+
+  // If there are threads waiting, wake up the most urgent one
+  Thread *t = NULL;
+  if (counter <= 0) {
+    t = waiting_queue->Remove();
+    g_scheduler->ReadyToRun(t);
+  }
+  else
+    WaitSet::Notify(&watchers);
+
+  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
+  YieldToWoken(t, oldlevel);
+}
+
+
+//! Cache of the locks
+SlabCache Lock::slabCache("Lock", sizeof(Lock));
+
+//----------------------------------------------------------------------
+// Lock::Lock
+/*! 	Initialize a Lock, so that it can be used for synchronization.
+//      The lock is initialy free
+//  \param "debugName" is an arbitrary name, useful for debugging.
+*/
+//----------------------------------------------------------------------
+Lock::Lock(char* debugName) : stat("lock", debugName) {
+  name = new char[strlen(debugName)+1];
+  strcpy(name,debugName);
+  waiting_queue = new ThreadQueue;
+  free = true;
+  owner = NULL;
+  nextHeld = NULL;
+  type = LOCK_TYPE;
+}
+
+
+//----------------------------------------------------------------------
+// Lock::~Lock
+/*! 	De-allocate lock, when no longer needed. Assumes that no thread
+//      is waiting on the lock.
+*/
+//----------------------------------------------------------------------
+Lock::~Lock() {
+  type = INVALID_TYPE;
+  DEBUG('s', (char *)"Lock \"%s\": %" PRIu64 " waits, %" PRIu64 " cycles blocked\n",
+	name, stat.profile.numWaits, stat.profile.waitTicks);
+  ASSERT(waiting_queue->IsEmpty());
+  // A lock deleted while held is no longer held
+  if (owner != NULL) {
+    Lock **l = &owner->heldLocks;
+    while (*l != this)
+      l = &(*l)->nextHeld;
+    *l = nextHeld;
+  }
+  delete [] name;
+  delete waiting_queue;
+}
+
+//----------------------------------------------------------------------
+// Lock::Acquire
+/*! 	Wait until the lock become free.  Checking the
+//	state of the lock (free or busy) and modify it must be done
+//	atomically, so we need to disable interrupts before checking
+//	the value of free.
+//
+//	While the thread waits, the owner inherits its priority if it
+//	is higher (see Thread::UpdatePriority). Release hands the lock
+//	over to the most urgent waiter, so the lock is held on return
+//	from Sleep.
+//
+//	Note that Thread::Sleep assumes that interrupts are disabled
+//	when it is called.
+*/
+//----------------------------------------------------------------------
+void Lock::Acquire() {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
+
+  if (free) {
+    // Acquire the lock
+    free = false;
+    owner = g_current_thread;
+    nextHeld = owner->heldLocks;
+    owner->heldLocks = this;
+    stat.AddAcquire();
+  } else {
+    // Wait until the lock is handed over, boosting its owner
+    Time start = g_stats->getTotalTicks();
+    char holder[SYNCH_NAME_LEN];
+    CopyName(holder, owner->GetName());
+    EnqueueByPriority(waiting_queue, g_current_thread);
+    g_current_thread->waitingLock = this;
+    owner->UpdatePriority();
+    g_current_thread->Sleep();
+    ASSERT(owner == g_current_thread);
+    stat.AddWait(g_stats->getTotalTicks() - start, holder);
+  }
+
+  g_machine->interrupt->SetStatus(oldlevel);  // Restore interrupt state
+}
+
+
+//----------------------------------------------------------------------
+// Lock::Release
+/*! 	Hand the lock over to the most urgent waiter if necessary, or
+//      release it if no thread is waiting. The current thread then
+//      gets back the priority it had without this lock.
+//      We check that the lock is held by the g_current_thread.
+//	As with Acquire, this operation must be atomic, so we need to disable
+//	interrupts.  Scheduler::ReadyToRun() assumes that threads
+//	are disabled when it is called.
+*/
+//----------------------------------------------------------------------
+void Lock::Release() {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
+
+  // Check if the lock is held by the current thread
+  ASSERT(isHeldByCurrentThread());
+
+  // Remove the lock from those held by the current thread
+  Lock **l = &owner->heldLocks;
+  while (*l != this)
+    l = &(*l)->nextHeld;
+  *l = nextHeld;
+
+  // If there are waiting threads, hand the lock over to the first one
+  Thread *t = waiting_queue->Remove();
+  if (t != NULL) {
+    t->waitingLock = NULL;
+    owner = t;
+    nextHeld = t->heldLocks;
+    t->heldLocks = this;
+    g_scheduler->ReadyToRun(t);
+    // The new owner inherits from the remaining waiters
+    t->UpdatePriority();
+  } else {
+    // Release the lock
+    free = true;
+    owner = NULL;
+  }
+  g_current_thread->UpdatePriority();
+
+  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
+  YieldToWoken(t, oldlevel);
+}
+
+//----------------------------------------------------------------------
+// Lock::GetWaiterPriority
+/*! 	\return the priority of the most urgent thread waiting for the
+//	lock (the first one, the queue being sorted by priority), or
+//	MIN_PRIORITY - 1 if no thread is waiting
+*/
+//----------------------------------------------------------------------
+int Lock::GetWaiterPriority() {
+  Thread *t = waiting_queue->First();
+  return (t != NULL) ? t->GetPriority() : MIN_PRIORITY - 1;
+}
+
+
+//----------------------------------------------------------------------
+// Lock::isHeldByCurrentThread
+/*! To check if current thread hold the lock
+*/
+//----------------------------------------------------------------------
+bool Lock::isHeldByCurrentThread() {return (g_current_thread == owner);}	
+
+//----------------------------------------------------------------------
+// Condition::Condition
+/*! 	Initializes a Condition, so that it can be used for synchronization.
+//
+//    \param  "debugName" is an arbitrary name, useful for debugging.
+*/
+//----------------------------------------------------------------------
+Condition::Condition(char* debugName) : stat("condition", debugName) {
+  name = new char[strlen(debugName)+1];
+  strcpy(name,debugName);
+  waiting_queue = new ThreadQueue;
+  type = CONDITION_TYPE;
+}
+
+//----------------------------------------------------------------------
+// Condition::~Condition
+/*! 	De-allocate condition, when no longer needed.
+//      Assumes that nobody is waiting on the condition.
+*/
+//----------------------------------------------------------------------
+Condition::~Condition() {
+  type = INVALID_TYPE;
+  DEBUG('s', (char *)"Condition \"%s\": %" PRIu64 " waits, %" PRIu64 " cycles blocked\n",
+	name, stat.profile.numWaits, stat.profile.waitTicks);
+  ASSERT(waiting_queue->IsEmpty());
+  delete [] name;
+  delete waiting_queue;
+}
+
+//----------------------------------------------------------------------
+// Condition::Wait
+/*! Block the calling thread (put it in the wait queue).
+//  This operation must be atomic, so we need to disable interrupts.
+*/	
+//----------------------------------------------------------------------
+void Condition::Wait() {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
+
+  // Move the current thread to the condition's wait queue and put it to sleep
+  Time start = g_stats->getTotalTicks();
+  EnqueueByPriority(waiting_queue, g_current_thread);
+  g_current_thread->Sleep();
+  stat.AddWait(g_stats->getTotalTicks() - start, NULL);
+
+  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
+}
+
+
+//----------------------------------------------------------------------
+// Condition::Signal
+/*! Wake up the first thread of the wait queue (if any). 
+// This operation must be atomic, so we need to disable interrupts.
+*/
+//----------------------------------------------------------------------
+void Condition::Signal() {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
+
+  // If there are waiting threads, wake up the first one
+  if (!waiting_queue->IsEmpty()) {
+    Thread *t = waiting_queue->Remove();
+    g_scheduler->ReadyToRun(t);
+  }
+
+  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
+}
+
+
+//----------------------------------------------------------------------
+// Condition::Broadcast
+/*! Wake up all threads waiting in the waitqueue of the condition
+// This operation must be atomic, so we need to disable interrupts.
+*/
+//----------------------------------------------------------------------
+void Condition::Broadcast() {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
+
+  // Wake up all threads in the wait queue
+  while (!waiting_queue->IsEmpty()) {
+    Thread *t = waiting_queue->Remove();
+    g_scheduler->ReadyToRun(t);
+  }
+
+  g_machine->interrupt->SetStatus(oldlevel);  // Restore interrupt state
+}
+
+
+//----------------------------------------------------------------------
+// RWLock::RWLock
+/*! 	Initialize a reader-writer lock, initially free
+//
+//  \param debugName is an arbitrary name, useful for debugging.
+//  \param writerPref true to give priority to the waiting writers
+*/
+//----------------------------------------------------------------------
+RWLock::RWLock(char* debugName, bool writerPref)
+  : stat("rwlock", debugName) {
+  name = new char[strlen(debugName)+1];
+  strcpy(name,debugName);
+  writerPreference = writerPref;
+  numReaders = 0;
+  readers = new List<int>;
+  writer = NULL;
+  readers_queue = new ThreadQueue;
+  writers_queue = new ThreadQueue;
+}
+
+//----------------------------------------------------------------------
+// RWLock::~RWLock
+/*! 	De-allocate a reader-writer lock. Assumes that no thread
+//      holds the lock or is waiting on it.
+*/
+//----------------------------------------------------------------------
+RWLock::~RWLock() {
+  DEBUG('s', (char *)"RWLock \"%s\": %" PRIu64 " waits, %" PRIu64 " cycles blocked\n",
+	name, stat.profile.numWaits, stat.profile.waitTicks);
+  ASSERT(!isBusy());
+  delete [] name;
+  delete readers;
+  delete readers_queue;
+  delete writers_queue;
+}
+
+//----------------------------------------------------------------------
+// RWLock::AcquireRead
+/*! 	Wait until no writer holds the lock (nor waits for it, with
+//	writer preference), then hold it for reading. The lock is
+//	handed over by Release, so it is held on return from Sleep.
+*/
+//----------------------------------------------------------------------
+void RWLock::AcquireRead() {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
+
+  if (writer == NULL && !(writerPreference && !writers_queue->IsEmpty())) {
+    numReaders++;
+    readers->Append(g_current_thread);
+    stat.AddAcquire();
+  } else {
+    Time start = g_stats->getTotalTicks();
+    char holder[SYNCH_NAME_LEN];
+    CopyName(holder, (writer != NULL) ? writer->GetName() : NULL);
+    EnqueueByPriority(readers_queue, g_current_thread);
+    g_current_thread->Sleep();
+    stat.AddWait(g_stats->getTotalTicks() - start, holder);
+  }
+
+  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
+}
+
+//----------------------------------------------------------------------
+// RWLock::AcquireWrite
+/*! 	Wait until nobody holds the lock, then hold it for writing.
+//	As in AcquireRead, the lock is handed over by Release.
+*/
+//----------------------------------------------------------------------
+void RWLock::AcquireWrite() {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
+
+  if (writer == NULL && numReaders == 0) {
+    writer = g_current_thread;
+    stat.AddAcquire();
+  } else {
+    Time start = g_stats->getTotalTicks();
+    char holder[SYNCH_NAME_LEN];
+    CopyName(holder, (writer != NULL) ? writer->GetName() : NULL);
+    EnqueueByPriority(writers_queue, g_current_thread);
+    g_current_thread->Sleep();
+    ASSERT(writer == g_current_thread);
+    stat.AddWait(g_stats->getTotalTicks() - start, holder);
+  }
+
+  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
+}
+
+//----------------------------------------------------------------------
+// RWLock::Release
+/*! 	Release the lock, held for writing if the current thread is
+//	the writer, for reading otherwise. The current thread must hold
+//	the lock (see isHeld). The last thread to release the lock hands
+//	it over to the threads waiting for it.
+*/
+//----------------------------------------------------------------------
+void RWLock::Release() {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
+
+  ASSERT(isHeld());
+  if (writer == g_current_thread)
+    writer = NULL;
+  else {
+    readers->RemoveItem(g_current_thread);
+    numReaders--;
+  }
+  if (numReaders == 0)
+    HandOver();
+
+  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
+}
+
+//----------------------------------------------------------------------
+// RWLock::HandOver
+/*! 	Give the free lock to the first waiting writer if writers have
+//	the preference or no reader is waiting, else to all the waiting
+//	readers. Called with interrupts disabled.
+*/
+//----------------------------------------------------------------------
+void RWLock::HandOver() {
+  ASSERT(writer == NULL && numReaders == 0);
+  if (!writers_queue->IsEmpty()
+      && (writerPreference || readers_queue->IsEmpty())) {
+    writer = writers_queue->Remove();
+    g_scheduler->ReadyToRun(writer);
+  } else {
+    Thread *t;
+    while ((t = readers_queue->Remove()) != NULL) {
+      numReaders++;
+      readers->Append(t);
+      g_scheduler->ReadyToRun(t);
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+// RWLock::isHeld
+/*! 	\return true if the current thread holds the lock, for writing
+//	or for reading
+*/
+//----------------------------------------------------------------------
+bool RWLock::isHeld() {
+  return (writer == g_current_thread) || readers->Search(g_current_thread);
+}
+
+//----------------------------------------------------------------------
+// RWLock::isBusy
+/*! 	\return true if a thread holds the lock or waits for it. A
+//	waiting thread woken up by HandOver holds the lock.
+*/
+//----------------------------------------------------------------------
+bool RWLock::isBusy() {
+  return (writer != NULL || numReaders > 0
+	  || !readers_queue->IsEmpty() || !writers_queue->IsEmpty());
+}
+
+//----------------------------------------------------------------------
+// Barrier::Barrier
+/*! 	Initialize a barrier, with no thread arrived
+//
+//  \param debugName is an arbitrary name, useful for debugging.
+//  \param threadCount number of threads to wait for (at least 1)
+*/
+//----------------------------------------------------------------------
+Barrier::Barrier(char* debugName, int threadCount)
+  : stat("barrier", debugName) {
+  name = new char[strlen(debugName)+1];
+  strcpy(name,debugName);
+  count = threadCount;
+  arrived = 0;
+  numInside = 0;
+  waiting_queue = new ThreadQueue;
+  numPhases = 0;
+}
+
+//----------------------------------------------------------------------
+// Barrier::~Barrier
+/*! 	De-allocate a barrier. Assumes that no thread is in Wait,
+//	not even a woken up one which has not run yet.
+*/
+//----------------------------------------------------------------------
+Barrier::~Barrier() {
+  DEBUG('s', (char *)"Barrier \"%s\": %" PRIu64 " phases, %" PRIu64 " cycles blocked\n",
+	name, numPhases, stat.profile.waitTicks);
+  ASSERT(!isBusy());
+  delete [] name;
+  delete waiting_queue;
+}
+
+//----------------------------------------------------------------------
+// Barrier::Wait
+/*! 	Block until count threads have called Wait. The last one to
+//	arrive wakes the others up, and the barrier is ready for the
+//	next phase at once.
+//
+//	\return true in the last thread to arrive, false in the others
+*/
+//----------------------------------------------------------------------
+bool Barrier::Wait() {
+  IntStatus oldlevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF); // Disable interrupts
+  numInside++;
+  bool last = (++arrived == count);
+
+  if (last) {
+    Thread *t;
+    while ((t = waiting_queue->Remove()) != NULL)
+      g_scheduler->ReadyToRun(t);
+    arrived = 0;
+    numPhases++;
+    stat.AddAcquire();
+  } else {
+    Time start = g_stats->getTotalTicks();
+    EnqueueByPriority(waiting_queue, g_current_thread);
+    g_current_thread->Sleep();
+    stat.AddWait(g_stats->getTotalTicks() - start, NULL);
+  }
+  numInside--;
+
+  g_machine->interrupt->SetStatus(oldlevel); // Restore interrupt state
+  return last;
+}
@@ -32,6 +32,56 @@
 #include "kernel/thread.h"
 #include "utility/list.h"
 
+//! Number of objects in the contention report (see SynchStat::PrintTop)
+#define SYNCH_TOP_N 10
+
+//! Length of the names kept by the contention report
+#define SYNCH_NAME_LEN 32
+
+/*! \brief Contention figures of a synchronization object, kept after
+//  the object is deleted
+*/
+typedef struct {
+  const char *kind;             //!< "semaphore", "lock", ...
+  char name[SYNCH_NAME_LEN];    //!< Debug name of the object
+  uint64_t numAcquires;         //!< Calls to P, Acquire, Wait...
+  uint64_t numWaits;            //!< Calls which blocked
+  Time waitTicks;               //!< Total time spent blocked
+  Time maxWait;                 //!< Longest time spent blocked
+  char maxWaiter[SYNCH_NAME_LEN]; //!< Thread which waited maxWait
+  char maxHolder[SYNCH_NAME_LEN]; //!< Thread it waited for, if known
+} SynchProfile;
+
+/*! \brief Contention statistics of a synchronization object
+//
+// Embedded in each Semaphore, Lock, Condition, RWLock and Barrier.
+// An acquisition which does not block costs one increment; a
+// blocking one reads the clock twice. The statistics of the live
+// objects are on a list, and those of the deleted objects are kept
+// if they rank among the SYNCH_TOP_N most contended ones, so that
+// PrintTop can report the bottlenecks at halt.
+*/
+class SynchStat {
+public:
+  //! Register the statistics of an object of kind kind
+  SynchStat(const char *kind, const char *name);
+
+  //! Keep the figures if they rank in the report, and unregister
+  ~SynchStat();
+
+  //! Record an acquisition which did not block
+  void AddAcquire() { profile.numAcquires++; }
+
+  //! Record an acquisition which blocked ticks cycles, waiting for holder
+  void AddWait(Time ticks, const char *holder);
+
+  //! Print the most contended objects, by time spent blocked
+  static void PrintTop();
+
+  SynchProfile profile; //!< The figures
+  QueueLink link;       //!< Link in the list of live objects
+};
+
 /*! \brief Defines the "semaphore" synchronization tool
 //
 // The semaphore has only two operations P() and V():
@@ -55,17 +105,39 @@ public:
   
   //! Delete semaphore
   ~Semaphore();  
+
+  //! Allocated from a cache (see slab.h)
+  void *operator new(size_t size) { return slabCache.Alloc(size); }
+  void operator delete(void *obj) { slabCache.Free(obj); }
+  static SlabCache slabCache;
   
   //! debugging assist
   char* getName() { return name;}
     
   void P();	 // these are the only operations on a semaphore
   void V();	 // they are both *atomic*
+
+  //! P, giving up at date deadline: return false if it was reached
+  bool TimedP(Time deadline);
+
+  //! Stop a thread waiting in TimedP (used by the alarm)
+  bool Cancel(Thread *thread);
+
+  //! Decrement the value if it is > 0, without blocking (see WaitAny)
+  bool TryP();
+
+  //! Return true if P would not block (interrupts disabled)
+  bool IsAvailable() { return counter > 0; }
+
+  //! Threads in WaitAny, notified when the value becomes > 0
+  WaitList *GetWatchers() { return &watchers; }
     
 private:
   char *name;             //!< useful for debugging
   int counter;            //!< semaphore counter
-  Listint *waiting_queue;  //!< threads waiting in P() for the value to be > 0
+  ThreadQueue *waiting_queue;  //!< threads waiting in P() for the value to be > 0
+  SynchStat stat;         //!< contention statistics of P()
+  WaitList watchers;      //!< threads waiting for it in WaitAny
 
 public:
   //! Object type, for validity checks during system calls (must be the first public field)
@@ -85,6 +157,12 @@ public:
 // In addition, by convention, only the thread that acquired the lock
 // may release it.  As with semaphores, you can't read the lock value
 // (because the value might change immediately after you read it).  
+//
+// The owner of a lock inherits the priority of the most urgent thread
+// waiting for it, until Release: a thread of low priority holding a
+// lock cannot delay a more urgent thread behind threads of medium
+// priority. The owner may itself wait for another lock, whose owner
+// then inherits the priority as well.
 */
 class Lock {
 public:
@@ -94,6 +172,11 @@ public:
   //! Delete a lock
   ~Lock();
 
+  //! Allocated from a cache (see slab.h)
+  void *operator new(size_t size) { return slabCache.Alloc(size); }
+  void operator delete(void *obj) { slabCache.Free(obj); }
+  static SlabCache slabCache;
+
   //! For debugging 
   char* getName() { return name; }
   
@@ -106,10 +189,20 @@ public:
   //! true if the current thread holds this lock.  Useful for checking
   //! in Release, and in Condition variable operations below.
   bool isHeldByCurrentThread();	 
+
+  //! Thread holding the lock, NULL if it is free
+  Thread *GetOwner() { return owner; }
+
+  //! Priority of the most urgent waiting thread, below MIN_PRIORITY if none
+  int GetWaiterPriority();
+
+  //! Next lock held by the owner (see Thread::heldLocks)
+  Lock *nextHeld;
   
 private:
   char* name;             //!< for debugging
-  Listint *waiting_queue; //!< threads waiting to acquire the lock
+  ThreadQueue *waiting_queue; //!< threads waiting to acquire the lock
+  SynchStat stat;         //!< contention statistics of Acquire()
   bool free;              //!< to know if the lock is free
   Thread * owner;         //!< Thread who has acquired the lock
 
@@ -156,11 +249,104 @@ public:
 
 private:
   char* name;           //!< For debbuging
-  Listint *waiting_queue;  //!< Threads asked to wait
+  ThreadQueue *waiting_queue;  //!< Threads asked to wait
+  SynchStat stat;       //!< statistics of Wait()
 
 public:
   //! Object type, for validity checks during system calls (must be the first public field)
   ObjectType type;
 };
 
+/*! \brief Defines the "reader-writer lock" synchronization tool
+//
+// A reader-writer lock is held either by any number of readers, or
+// by a single writer:
+//
+//	AcquireRead -- wait until no writer holds the lock
+//
+//	AcquireWrite -- wait until nobody holds the lock
+//
+//	Release -- release the lock, held for reading or writing
+//
+// With writer preference, a reader also waits while writers are
+// waiting, so that a steady flow of readers cannot starve the
+// writers. Without it, readers are let in as long as no writer holds
+// the lock. The lock is handed over on Release: to the most urgent
+// writer, or to all the waiting readers at once.
+*/
+class RWLock {
+public:
+  //! Create a free lock
+  RWLock(char* debugName, bool writerPref);
+
+  //! Delete a lock (nobody may hold it or be waiting, see isBusy)
+  ~RWLock();
+
+  //! For debugging
+  char* getName() { return name; }
+
+  //! Acquire the lock for reading
+  void AcquireRead();
+
+  //! Acquire the lock for writing
+  void AcquireWrite();
+
+  //! Release the lock, held for reading or writing
+  void Release();
+
+  //! true if the current thread holds the lock
+  bool isHeld();
+
+  //! true if the lock is held or waited for
+  bool isBusy();
+
+private:
+  //! Hand the free lock over to waiting threads
+  void HandOver();
+
+  char* name;                  //!< for debugging
+  bool writerPreference;       //!< readers wait behind waiting writers
+  int numReaders;              //!< readers holding the lock
+  List<int> *readers;          //!< threads holding the lock for reading,
+                               //!< once per AcquireRead
+  Thread *writer;              //!< writer holding the lock, NULL if none
+  ThreadQueue *readers_queue;  //!< readers waiting for the lock
+  ThreadQueue *writers_queue;  //!< writers waiting for the lock
+  SynchStat stat;              //!< contention statistics of both modes
+};
+
+/*! \brief Defines the "barrier" synchronization tool
+//
+// A barrier makes a fixed number of threads wait for each other:
+//
+//	Wait -- block until count threads have called Wait, then
+//	        wake them all up and get ready for the next phase
+*/
+class Barrier {
+public:
+  //! Create a barrier for count threads
+  Barrier(char* debugName, int count);
+
+  //! Delete a barrier (nobody may be waiting, see isBusy)
+  ~Barrier();
+
+  //! For debugging
+  char* getName() { return name; }
+
+  //! Wait for the other threads: return true in the last one to arrive
+  bool Wait();
+
+  //! true if threads are in Wait
+  bool isBusy() { return (numInside > 0); }
+
+private:
+  char* name;                  //!< for debugging
+  int count;                   //!< number of threads to wait for
+  int arrived;                 //!< threads arrived in the current phase
+  int numInside;               //!< threads in Wait, woken up or not
+  ThreadQueue *waiting_queue;  //!< threads waiting for the others
+  uint64_t numPhases;          //!< number of completed phases
+  SynchStat stat;              //!< statistics of Wait()
+};
+
 #endif // SYNCH_H
@@ -0,0 +1,59 @@
+/*! \file systable.h
+    \brief Description of the system calls, for dispatch, tracing and
+    statistics
+
+    The table gives, for each system call number, the function of the
+    kernel handling it, the name of the user function and the kind of
+    each argument. ExceptionHandler dispatches the calls through it,
+    and uses it to print a call as the program wrote it (see the 'y'
+    debug flag). It also names the lines of the per-syscall statistics
+    (see Statistics::Print). The table and the handlers are defined in
+    exception.cc.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef SYSTABLE_H
+#define SYSTABLE_H
+
+#include "kernel/copyright.h"
+#include "userlib/syscall.h"
+
+/*! Function handling a system call: it reads the arguments in the
+    registers and writes the result in r10 (type is the system call
+    number, for the handlers shared by several calls) */
+typedef void (*SyscallHandler)(int type);
+
+/*! \brief Description of a system call
+//
+// Each character of args describes an argument, in the registers
+// r10 to r13: 'd' an integer or an object identifier, 'x' an address,
+// 's' the address of a string, printed with the string.
+*/
+typedef struct {
+  int number;         //!< System call number (SC_xxx)
+  const char *name;   //!< Name of the user function (see syscall.h)
+  const char *args;   //!< Kinds of the arguments
+  SyscallHandler handler; //!< Kernel function, NULL if not implemented
+} SyscallDesc;
+
+//! Descriptions of the system calls, indexed by number
+extern const SyscallDesc g_syscall_table[NUM_SYSCALLS];
+
+//! Return the name of a system call, "?" if the number is invalid
+extern const char *SyscallName(int number);
+
+#endif // SYSTABLE_H
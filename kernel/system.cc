@@ -22,14 +22,23 @@
 #include "kernel/scheduler.h"
 #include "kernel/msgerror.h"
 #include "drivers/drvConsole.h"
+#include "kernel/futex.h"
+#include "kernel/execcache.h"
+#include "kernel/aio.h"
+#include "kernel/softirq.h"
+#include "kernel/roi.h"
+#include "kernel/alarm.h"
+#include "kernel/synch.h"
 #include "drivers/drvDisk.h"
 #include "drivers/drvACIA.h"
 #include "utility/config.h"
 #include "utility/utility.h"
 #include "utility/stats.h"
+#include "utility/slab.h"
 #include "utility/objaddr.h"
 #include "vm/swapManager.h"
 #include "vm/pagefaultmanager.h"
+#include "vm/faultprof.h"
 #include "vm/physMem.h"
 #include "filesys/oftable.h"
 #include "filesys/filesys.h"
@@ -45,8 +54,10 @@ Machine* g_machine;	                //!< Machine (includes CPU and peripherals)
 // Thread management
 Thread *g_current_thread;		//!< The thread holding the CPU
 Thread *g_thread_to_be_destroyed;  	//!< The thread that just finished
-Listint *g_alive;                        //!< List of existing threads
+ThreadList *g_alive;                     //!< List of existing threads
 Scheduler *g_scheduler;			//!< Thread scheduler
+FutexTable *g_futex_table;		//!< Futex wait queues
+Alarm *g_alarm;				//!< Threads sleeping until a date
 
 // Device drivers
 DriverDisk *g_disk_driver;               //!< Disk driver
@@ -59,8 +70,13 @@ FileSystem  *g_file_system;                 //!< File system
 OpenFileTable *g_open_file_table;           //!< Open File Table
 SwapManager *g_swap_manager;                //!< Management of swap area
 PageFaultManager *g_page_fault_manager;     //!< Page fault handler (used in VMM)
+FaultProfiler *g_fault_profiler;            //!< Page fault statistics
 PhysicalMemManager *g_physical_mem_manager; //!< Physical memory manager
 SyscallError *g_syscall_error;              //!< Error management
+ExecCache *g_exec_cache;                    //!< Parsed executable files
+AioManager *g_aio;                          //!< Asynchronous file I/O
+SoftIrq *g_softirq;                         //!< Work deferred by interrupt handlers
+RoiManager *g_roi;                          //!< Regions of interest of user programs
 Config *g_cfg;                             //!< Configuration of Nachos
 Statistics *g_stats;			  //!< performance metrics
 ObjAddr *g_object_addrs;                   //!< addresses of kernel objets
@@ -168,14 +184,19 @@ Initialize(int argc, char **argv)
 
   // Create the different objects making the Nachos kernel
   g_scheduler = new Scheduler();		// Initialize the ready queue
+  g_futex_table = new FutexTable();
+  g_alarm = new Alarm();
   g_page_fault_manager = new PageFaultManager();
+  g_fault_profiler = new FaultProfiler();
   g_swap_manager = new SwapManager();
   g_swap_disk_driver = g_swap_manager->GetSwapDisk();
   g_physical_mem_manager = new PhysicalMemManager();  
   g_syscall_error = new SyscallError();
+  g_exec_cache = new ExecCache();
+  g_roi = new RoiManager();
 
   // Init the Nachos internal data structures
-  g_alive = new Listint();                // List of threads (initially empty)
+  g_alive = new ThreadList();             // List of threads (initially empty)
   g_object_addrs = new ObjAddr();
   g_thread_to_be_destroyed = NULL;
   g_open_file_table = new OpenFileTable;
@@ -206,6 +227,12 @@ Initialize(int argc, char **argv)
   // Remove g_current_thread from ready list (inserted by default)
   // because it is currently executing
   ASSERT(g_current_thread == g_scheduler->FindNextToRun());
+
+  // Start the thread finishing the work of the interrupt handlers
+  g_softirq = new SoftIrq(rootProcess);
+
+  // Start the asynchronous I/O thread, which will wait for requests
+  g_aio = new AioManager(rootProcess);
   
   // Enable interrupts
   g_machine->interrupt->SetStatus(INTERRUPTS_ON);
@@ -239,18 +266,33 @@ Cleanup()
   printf("\nCleaning up...\n");    
   if (g_cfg->PrintStat) {
     g_stats->Print();
+    g_exec_cache->Print();
+    SlabCache::PrintAll();
+    g_aio->Print();
+    g_softirq->Print();
+    g_machine->interrupt->PrintOffStats();
+    SynchStat::PrintTop();
+    g_fault_profiler->Print();
+    g_roi->Print();
   }
   delete g_disk_driver;
   delete g_console_driver;
   if (g_cfg->ACIA) delete g_acia_driver;
   delete g_syscall_error;
+  delete g_aio;
+  delete g_softirq;
+  delete g_roi;
   delete g_file_system;
+  delete g_exec_cache;
   delete g_open_file_table;
   delete g_swap_manager;
   delete g_scheduler;
+  delete g_futex_table;
+  delete g_alarm;
   delete g_stats;
   delete g_physical_mem_manager;
   delete g_page_fault_manager;
+  delete g_fault_profiler;
   delete g_cfg;
   delete g_alive;
   delete g_object_addrs;
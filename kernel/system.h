@@ -28,11 +28,10 @@
 using namespace std;
 
 #include "utility/list.h"
-#include "utility/objaddr.h"
 
 /*! Each syscall makes sure that the object that the user passes to it
- * are of the expected type, by checking the typeId field against
- * these identifiers
+ * are of the expected type, by checking the type recorded with the
+ * object identifier (see ObjAddr) against these identifiers
  */
 typedef enum {
   SEMAPHORE_TYPE = 0xdeefeaea,
@@ -40,9 +39,18 @@ typedef enum {
   CONDITION_TYPE = 0xdeefcdcd,
   FILE_TYPE = 0xdeadbeef,
   THREAD_TYPE = 0xbadcafe,
+  AIO_TYPE = 0xdeefa10,
+  PIPE_READ_TYPE = 0xdeef9e0,
+  PIPE_WRITE_TYPE = 0xdeef9e1,
+  PORT_TYPE = 0xdeef9047,
+  SHM_TYPE = 0xdeef5e9,
+  RWLOCK_TYPE = 0xdeef7e1,
+  BARRIER_TYPE = 0xdeefba1,
   INVALID_TYPE = 0xf0f0f0f
 } ObjectType;
 
+#include "utility/objaddr.h"
+
 // Forward declarations (ie in other files)
 class Config;
 class Statistics;
@@ -58,6 +66,13 @@ class DriverDisk;
 class DriverConsole;
 class DriverACIA;
 class Machine;
+class FutexTable;
+class ExecCache;
+class AioManager;
+class SoftIrq;
+class RoiManager;
+class FaultProfiler;
+class Alarm;
 
 // Initialization and cleanup routines
 extern void Initialize(int argc, char **argv); 	//!< Initialization,
@@ -74,8 +89,10 @@ extern Machine* g_machine;	                //!< Machine (includes CPU and periph
 // Thread management
 extern Thread *g_current_thread;		//!< The thread holding the CPU
 extern Thread *g_thread_to_be_destroyed;  	//!< The thread that just finished
-extern Listint *g_alive;                        //!< List of existing threads
+// g_alive (list of existing threads) is declared in thread.h
 extern Scheduler *g_scheduler;			//!< Thread scheduler
+extern FutexTable *g_futex_table;		//!< Futex wait queues
+extern Alarm *g_alarm;				//!< Threads sleeping until a date
 
 // Device drivers
 extern DriverDisk *g_disk_driver;               //!< Disk driver
@@ -88,8 +105,13 @@ extern FileSystem  *g_file_system;                 //!< File system
 extern OpenFileTable *g_open_file_table;           //!< Open File Table
 extern SwapManager *g_swap_manager;                //!< Management of swap area
 extern PageFaultManager *g_page_fault_manager;     //!< Page fault handler (used in VMM)
+extern FaultProfiler *g_fault_profiler;            //!< Page fault statistics
 extern PhysicalMemManager *g_physical_mem_manager;//!< Physical memory manager
 extern SyscallError *g_syscall_error;              //!< Error management
+extern ExecCache *g_exec_cache;                    //!< Parsed executable files
+extern AioManager *g_aio;                          //!< Asynchronous file I/O
+extern SoftIrq *g_softirq;                         //!< Work deferred by interrupt handlers
+extern RoiManager *g_roi;                          //!< Regions of interest of user programs
 extern Config *g_cfg;                             //!< Configuration of Nachos
 extern Statistics *g_stats;			  //!< performance metrics
 extern ObjAddr *g_object_addrs;                   //!< addresses of kernel objets
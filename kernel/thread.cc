@@ -37,6 +37,9 @@
 					// simulator stack, for detecting 
 					// stack overflows
 
+//! Cache of the threads
+SlabCache Thread::slabCache("Thread", sizeof(Thread));
+
 //----------------------------------------------------------------------
 // Thread::Thread
 /*! 	Constructor. Initialize an empty thread (just a name)
@@ -49,9 +52,23 @@ Thread::Thread(char *threadName)
   name = new char[strlen(threadName)+1];
   strcpy(name,threadName);
   type = THREAD_TYPE;
+  id = -1;
  
   // No process owner yet
   process = NULL;
+
+  readyDate = runDate = blockDate = g_stats->getTotalTicks();
+  memset(hpmEvents, 0, sizeof(hpmEvents));
+  fpState = FP_OFF;
+
+  // Executes a user program, unless started by StartKernel
+  kernelFunc = NULL;
+  kernelArg = 0;
+
+  basePriority = priority = DEFAULT_PRIORITY;
+  queue = NULL;
+  waitingLock = NULL;
+  heldLocks = NULL;
 }
 
 //----------------------------------------------------------------------
@@ -71,6 +88,13 @@ Thread::~Thread()
     DEBUG('t', (char *)"Deleting thread \"%s\"\n", name);
     type = INVALID_TYPE;
 
+    // Invalidate the identifier of the thread, so that a Join on it
+    // detects that it has terminated
+    g_object_addrs->RemoveObject(id);
+    g_alive->RemoveItem(this);
+    WaitSet::Notify(&exitWatchers);
+    g_machine->ReleaseFP(this);
+
     //CheckOverflow();
 
     // Delete the simulator stack In case this==g_current_thread, it
@@ -120,6 +144,41 @@ int Thread::Start(Process *owner,
 
 }
 
+//----------------------------------------------------------------------
+// Thread::StartKernel
+/*!  Start a kernel thread: instead of a user program, the thread
+//   executes func(arg) on its simulator stack. It is attached to a
+//   process only for the accounting of its time, and never uses the
+//   address space of this process.
+//
+//   \param owner process the time of the thread is accounted to
+//   \param func kernel function to execute
+//   \param arg argument of func
+//   \return NO_ERROR on success, an error code on error
+*/
+//----------------------------------------------------------------------
+int Thread::StartKernel(Process *owner, VoidFunctionPtr func, int64_t arg)
+{
+  ASSERT(process == NULL);
+
+  int8_t *stack = AllocBoundedArray(SIMULATORSTACKSIZE);
+  if (stack == NULL)
+    return OUT_OF_MEMORY;
+
+  process = owner;
+  kernelFunc = func;
+  kernelArg = arg;
+  InitThreadContext(0, 0, arg);
+  InitSimulatorContext(stack, SIMULATORSTACKSIZE);
+
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  process->numThreads++;
+  g_alive->Append(this);
+  g_scheduler->ReadyToRun(this);
+  g_machine->interrupt->SetStatus(oldLevel);
+  return NO_ERROR;
+}
+
 //----------------------------------------------------------------------
 // Thread::InitThreadContext
 /*!	Set the initial values for the thread contact
@@ -147,6 +206,29 @@ Thread::InitThreadContext(int64_t initialPCREG,int64_t initialSP, int64_t arg)
     thread_context.int_registers[STACK_REG] = initialSP;
 }
 
+//----------------------------------------------------------------------
+// EnqueueByPriority
+/*!	Put a thread on a ready list or a waiting queue, after the
+//	threads of higher or equal priority: the first thread of the
+//	queue is the most urgent, and threads of the same priority are
+//	served in FIFO order.
+//
+//	\param queue the queue
+//	\param thread the thread, not on any queue
+*/
+//----------------------------------------------------------------------
+void EnqueueByPriority(ThreadQueue *queue, Thread *thread)
+{
+  Thread *next = queue->First();
+  while (next != NULL && next->GetPriority() >= thread->GetPriority())
+    next = queue->Next(next);
+  if (next != NULL)
+    queue->InsertBefore(thread, next);
+  else
+    queue->Append(thread);
+  thread->queue = queue;
+}
+
 //----------------------------------------------------------------------
 // StartThreadExecution, ThreadPrint
 /*!	Dummy function because C++ does not allow a pointer to a member
@@ -161,6 +243,13 @@ void ThreadPrint(long arg)
 }
 
 void StartThreadExecution(void) {
+  // A kernel thread (see Thread::StartKernel) does not execute
+  // user code
+  if (g_current_thread->kernelFunc != NULL) {
+    g_machine->interrupt->SetStatus(INTERRUPTS_ON);
+    (*g_current_thread->kernelFunc)(g_current_thread->kernelArg);
+    g_current_thread->Finish();
+  }
   printf("****  Starting thread\n");
   g_machine->interrupt->SetStatus(INTERRUPTS_ON);
   g_machine->Run();
@@ -219,7 +308,12 @@ Thread::InitSimulatorContext(int8_t* base_stack_addr,
 void 
 Thread::Join(Thread *Idthread)
 { 
-    while (g_alive->Search(Idthread)) Yield();
+    // The identifier of a thread is released when it is deleted: check
+    // it first, so that a deleted thread is never dereferenced
+    int32_t tid = Idthread->GetId();
+    while (g_object_addrs->SearchObject(tid, THREAD_TYPE) == Idthread
+	   && g_alive->IsQueued(Idthread))
+      Yield();
 }
   
 //----------------------------------------------------------------------
@@ -274,10 +368,65 @@ Thread::Finish ()
 
  }
 
+//----------------------------------------------------------------------
+// Thread::SetPriority
+/*!	Change the base priority of the thread. Its effective priority
+//	stays at least that of the threads waiting for its locks.
+//
+//	\param newPriority between MIN_PRIORITY and MAX_PRIORITY
+*/
+//----------------------------------------------------------------------
+void
+Thread::SetPriority(int newPriority)
+{
+  ASSERT(newPriority >= MIN_PRIORITY && newPriority <= MAX_PRIORITY);
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  basePriority = newPriority;
+  UpdatePriority();
+  (void) g_machine->interrupt->SetStatus(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Thread::UpdatePriority
+/*!	Recompute the effective priority: the highest of the base
+//	priority and of the priorities of the threads waiting for the
+//	locks held (priority inheritance). The thread is moved in the
+//	queue it is on, and the change goes on along the chain of
+//	lock owners if the thread is itself waiting for a lock.
+//	Called with interrupts disabled.
+*/
+//----------------------------------------------------------------------
+void
+Thread::UpdatePriority()
+{
+  ASSERT(g_machine->interrupt->GetStatus() == INTERRUPTS_OFF);
+
+  int newPriority = basePriority;
+  for (Lock *lock = heldLocks; lock != NULL; lock = lock->nextHeld)
+    if (lock->GetWaiterPriority() > newPriority)
+      newPriority = lock->GetWaiterPriority();
+  if (newPriority == priority)
+    return;
+
+  DEBUG('t', (char *)"Thread \"%s\": priority %d -> %d\n",
+	name, priority, newPriority);
+  if (newPriority > priority && newPriority > basePriority)
+    g_scheduler->CountBoost(this);
+  priority = newPriority;
+
+  if (queue != NULL && queue->IsQueued(this)) {
+    queue->RemoveItem(this);
+    EnqueueByPriority(queue, this);
+  }
+  if (waitingLock != NULL)
+    waitingLock->GetOwner()->UpdatePriority();
+}
+
 //----------------------------------------------------------------------
 // Thread::Yield
-/*! 	Relinquish the CPU if any other thread is ready to run.
-//	If so, put the thread on the end of the ready list, so that
+/*! 	Relinquish the CPU if any other thread of higher or equal
+//	priority is ready to run. If so, put the thread after the
+//	threads of its priority on the ready list, so that
 //	it will eventually be re-scheduled.
 //
 //	NOTE: returns immediately if no other thread on the ready queue.
@@ -300,7 +449,8 @@ Thread::Yield ()
     
     DEBUG('t', (char *)"Yielding thread \"%s\"\n", GetName());
     
-    nextThread = g_scheduler->FindNextToRun();
+    // Threads of lower priority wait until this one blocks
+    nextThread = g_scheduler->FindNextToRun(priority);
     if (nextThread != NULL) {
 	g_scheduler->ReadyToRun(this);
 	g_scheduler->SwitchTo(nextThread);
@@ -356,7 +506,9 @@ Thread::Sleep ()
 
 //----------------------------------------------------------------------
 // Thread::SaveProcessorState
-/*!	Save the CPU state of a user program on a context switch
+/*!	Save the CPU state of a user program on a context switch.
+//	The FP registers are left to the machine, which saves them
+//	lazily (see Machine::UseFP).
 */
 //----------------------------------------------------------------------
 void
@@ -371,6 +523,8 @@ Thread::SaveProcessorState()
 //----------------------------------------------------------------------
 // Thread::RestoreProcessorState
 /*!	Restore the CPU state of a user program on a context switch.
+//	The FP registers are left to the machine, which loads them on
+//	the first FP instruction of the thread (see Machine::UseFP).
 */
 //----------------------------------------------------------------------
 
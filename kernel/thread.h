@@ -34,9 +34,11 @@ class Thread;
 #include "machine/machine.h"
 #include "kernel/copyright.h"
 #include "kernel/system.h"
-#include "kernel/process.h"
 #include "utility/utility.h"
 #include "utility/stats.h"
+#include "utility/queue.h"
+#include "utility/slab.h"
+#include "kernel/waitany.h"
 #include <ucontext.h> 
 
 // Size of the simulator's execution stack
@@ -46,8 +48,14 @@ class Thread;
 extern void ThreadPrint(long arg);	 
 
 class Semaphore;
+class Lock;
 class Process;
 
+//! Range of thread priorities (the higher, the more urgent)
+#define MIN_PRIORITY      0
+#define MAX_PRIORITY      31
+#define DEFAULT_PRIORITY  16
+
 /*! \brief Defines the context of the Nachos simulator
 */
 typedef struct {
@@ -83,9 +91,18 @@ public:
   //! Deallocate a Thread.
   ~Thread();			
 
+  //! Allocated from a cache (see slab.h)
+  void *operator new(size_t size) { return slabCache.Alloc(size); }
+  void operator delete(void *obj) { slabCache.Free(obj); }
+  static SlabCache slabCache;
+
   //! Start a thread, attaching it to a process (return NoError on success)
   int Start(Process *owner, int64_t func, int64_t arg);
 
+  //! Start a kernel thread executing func(arg), attached to a process
+  //  for accounting only (return NoError on success)
+  int StartKernel(Process *owner, VoidFunctionPtr func, int64_t arg);
+
   //! Wait for another thread to finish its execution
   void Join(Thread *Idthread);
 
@@ -126,6 +143,25 @@ public:
   char* GetName() { return (name); }
   Process* GetProcessOwner() { return process; }
 
+  //! Saved FP registers, loaded lazily by the machine (see Machine::UseFP)
+  int64_t *GetFPRegisters() { return thread_context.float_registers; }
+
+  //! Identifier of the thread in the object table (-1 if none)
+  int32_t GetId() { return id; }
+  void SetId(int32_t tid) { id = tid; }
+
+  //! Effective priority, raised above the base one by the threads
+  //  waiting for the locks held by the thread
+  int GetPriority() { return priority; }
+  int GetBasePriority() { return basePriority; }
+
+  //! Change the base priority of the thread
+  void SetPriority(int newPriority);
+
+  //! Recompute the effective priority after a change of the base
+  //  priority or of the waiters of the held locks
+  void UpdatePriority();
+
 protected:
   //! Thread name (for debugging)   
   char* name;
@@ -139,11 +175,70 @@ protected:
   //! Thread context
   threadContextT thread_context;
 
+  //! Object identifier returned to user programs
+  int32_t id;
+
 public:
   //! signature to make sure the thread is in the correct state
   ObjectType type;
 
   int stackPointer;
+
+  //! Link in the ready list or in the waiting queue the thread is
+  //  blocked on (a thread is never on both)
+  QueueLink queueLink;
+
+  //! Queue the thread was last put on through queueLink (see
+  //  EnqueueByPriority), meaningful only while it is on it
+  Queue<Thread, &Thread::queueLink> *queue;
+
+  Lock *waitingLock;  //!< Lock the thread is blocked on, NULL if none
+  Lock *heldLocks;    //!< Locks held by the thread (see Lock::nextHeld)
+
+  //! Link in the list of existing threads (g_alive)
+  QueueLink aliveLink;
+
+  //! Threads in WaitAny, notified when the thread is deleted
+  WaitList exitWatchers;
+
+  //! Scheduling statistics of the thread (see Scheduler::SwitchTo)
+  SchedStat schedStat;
+
+  //! Events counted for the performance counter CSRs, indexed by
+  //  HPM_* (see Machine::ReadCounter)
+  uint64_t hpmEvents[NUM_HPM_EVENTS];
+
+  //! State of the FP registers of the thread (see Machine::UseFP)
+  FPState fpState;
+
+  Time readyDate;   //!< Date the thread was last put on the ready list
+  Time runDate;     //!< Date the thread last got the CPU
+  Time blockDate;   //!< Date the thread last blocked
+
+  //! Kernel function executed by a kernel thread (see StartKernel),
+  //  NULL for a thread executing a user program
+  VoidFunctionPtr kernelFunc;
+  int64_t kernelArg;  //!< Argument of kernelFunc
+
+private:
+  int basePriority;   //!< Priority set by SetPriority
+  int priority;       //!< Effective priority
 };
 
+//! Ready list or waiting queue of a synchronization object
+typedef Queue<Thread, &Thread::queueLink> ThreadQueue;
+
+//! List of existing threads
+typedef Queue<Thread, &Thread::aliveLink> ThreadList;
+
+//! Put a thread on a ready list or waiting queue, after the threads
+//  of higher or equal priority
+extern void EnqueueByPriority(ThreadQueue *queue, Thread *thread);
+
+extern ThreadList *g_alive;                     //!< List of existing threads
+
+// Included last: the synchronization tools it includes use the thread
+// queues defined above
+#include "kernel/process.h"
+
 #endif // THREAD_H
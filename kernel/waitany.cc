@@ -0,0 +1,253 @@
+/*! \file waitany.cc
+//  \brief Routines to wait for any of several objects
+//
+//	An object is ready when an operation on it would not block:
+//	a semaphore with a positive counter (which WaitForAny then
+//	decrements), a terminated thread, a pipe or a console with
+//	input available. An identifier that no longer designates an
+//	object is ready as well, as Join returns at once for a thread
+//	already deleted.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "kernel/waitany.h"
+#include "kernel/pipe.h"
+#include "kernel/scheduler.h"
+#include "kernel/synch.h"
+#include "kernel/thread.h"
+#include "drivers/drvConsole.h"
+#include "machine/machine.h"
+#include "userlib/syscall.h"
+
+//----------------------------------------------------------------------
+// WaitSet::WaitSet
+//!	Initialize a set of the current thread, watching nothing
+//----------------------------------------------------------------------
+WaitSet::WaitSet()
+{
+  thread = g_current_thread;
+  notified = false;
+  sleeping = false;
+  numRecords = 0;
+}
+
+//----------------------------------------------------------------------
+// WaitSet::~WaitSet
+//!	Leave the watch lists still watched
+//----------------------------------------------------------------------
+WaitSet::~WaitSet()
+{
+  Unwatch();
+}
+
+//----------------------------------------------------------------------
+// WaitSet::Watch
+/*!	Register on the watch list of an object
+//
+//	\param list the watch list
+*/
+//----------------------------------------------------------------------
+void
+WaitSet::Watch(WaitList *list)
+{
+  ASSERT(g_machine->interrupt->GetStatus() == INTERRUPTS_OFF);
+  ASSERT(numRecords < WAIT_ANY_MAX);
+  WaitRecord *record = &records[numRecords];
+  record->set = this;
+  lists[numRecords] = list;
+  list->Append(record);
+  numRecords++;
+}
+
+//----------------------------------------------------------------------
+// WaitSet::Block
+/*!	Put the thread to sleep until a watched list is notified. The
+//	notification may already have come, from an interrupt handler
+//	run since the objects were checked.
+*/
+//----------------------------------------------------------------------
+void
+WaitSet::Block()
+{
+  ASSERT(g_machine->interrupt->GetStatus() == INTERRUPTS_OFF);
+  ASSERT(thread == g_current_thread);
+  if (!notified) {
+    sleeping = true;
+    thread->Sleep();
+    sleeping = false;
+  }
+  notified = false;
+}
+
+//----------------------------------------------------------------------
+// WaitSet::Unwatch
+//!	Leave the watch lists that were not notified
+//----------------------------------------------------------------------
+void
+WaitSet::Unwatch()
+{
+  for (int i = 0; i < numRecords; i++)
+    lists[i]->RemoveItem(&records[i]);
+  numRecords = 0;
+}
+
+//----------------------------------------------------------------------
+// WaitSet::Notify
+/*!	Wake up the threads watching a list, once each. The list is
+//	emptied: the woken threads register again if needed. Also
+//	called by the destructor of the object owning the list.
+//
+//	\param list the watch list
+*/
+//----------------------------------------------------------------------
+void
+WaitSet::Notify(WaitList *list)
+{
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  WaitRecord *record;
+  while ((record = list->Remove()) != NULL) {
+    WaitSet *set = record->set;
+    if (!set->notified) {
+      set->notified = true;
+      if (set->sleeping)
+	g_scheduler->ReadyToRun(set->thread);
+    }
+  }
+  (void) g_machine->interrupt->SetStatus(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// StdinPipe
+/*!	\return the pipe the current process reads as standard input,
+//	NULL if it reads the console
+*/
+//----------------------------------------------------------------------
+static Pipe *
+StdinPipe()
+{
+  return g_current_thread->GetProcessOwner()->stdinPipe;
+}
+
+//----------------------------------------------------------------------
+// IsReady
+/*!	Check whether an object is ready, taking the semaphores ready
+//
+//	\param id identifier of the object (CONSOLE_INPUT for the
+//	       standard input)
+//	\param list set to the watch list of the object if not ready
+//	\return true if the object is ready
+*/
+//----------------------------------------------------------------------
+static bool
+IsReady(int64_t id, WaitList **list)
+{
+  if (id == CONSOLE_INPUT) {
+    Pipe *pipe = StdinPipe();
+    if (pipe != NULL) {
+      *list = pipe->GetReadWatchers();
+      return pipe->CanRead();
+    }
+    *list = g_console_driver->GetInputWatchers();
+    return g_console_driver->InputReady();
+  }
+
+  switch (g_object_addrs->GetType(id)) {
+  case SEMAPHORE_TYPE: {
+    Semaphore *sema = (Semaphore *)g_object_addrs->SearchObject(id, SEMAPHORE_TYPE);
+    *list = sema->GetWatchers();
+    return sema->TryP();
+  }
+  case THREAD_TYPE: {
+    Thread *t = (Thread *)g_object_addrs->SearchObject(id, THREAD_TYPE);
+    *list = &t->exitWatchers;
+    return !g_alive->IsQueued(t);
+  }
+  case PIPE_READ_TYPE: {
+    Pipe *pipe = (Pipe *)g_object_addrs->SearchObject(id, PIPE_READ_TYPE);
+    *list = pipe->GetReadWatchers();
+    return pipe->CanRead();
+  }
+  default:
+    // The object is gone
+    return true;
+  }
+}
+
+//----------------------------------------------------------------------
+// CanWaitFor
+/*!	Check that WaitAny can wait for an object
+//
+//	\param id identifier of the object
+//	\return true for CONSOLE_INPUT, a semaphore, a thread or the
+//	       read end of a pipe
+*/
+//----------------------------------------------------------------------
+bool
+CanWaitFor(int64_t id)
+{
+  if (id == CONSOLE_INPUT)
+    return true;
+  ObjectType type = g_object_addrs->GetType(id);
+  return (type == SEMAPHORE_TYPE || type == THREAD_TYPE
+	  || type == PIPE_READ_TYPE);
+}
+
+//----------------------------------------------------------------------
+// WaitForAny
+/*!	Block until one of several objects is ready
+//
+//	\param ids identifiers of semaphores, threads, pipe read ends,
+//	       or CONSOLE_INPUT
+//	       (checked by the caller, see CanWaitFor)
+//	\param count number of identifiers (1 to WAIT_ANY_MAX)
+//	\return the index in ids of the first ready object
+*/
+//----------------------------------------------------------------------
+int
+WaitForAny(int64_t *ids, int count)
+{
+  ASSERT(count > 0 && count <= WAIT_ANY_MAX);
+  bool console = false;
+  for (int i = 0; i < count; i++)
+    if (ids[i] == CONSOLE_INPUT && StdinPipe() == NULL)
+      console = true;
+
+  // The console is only polled while somebody waits for it
+  if (console)
+    g_console_driver->StartPolling();
+
+  IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+  WaitSet set;
+  WaitList *lists[WAIT_ANY_MAX];
+  int ready = -1;
+  for (;;) {
+    for (int i = 0; i < count && ready < 0; i++)
+      if (IsReady(ids[i], &lists[i]))
+	ready = i;
+    if (ready >= 0)
+      break;
+    for (int i = 0; i < count; i++)
+      set.Watch(lists[i]);
+    set.Block();
+    set.Unwatch();
+  }
+  (void) g_machine->interrupt->SetStatus(oldLevel);
+
+  if (console)
+    g_console_driver->StopPolling();
+  DEBUG('e', (char *)"WaitAny: object %" PRId64 " ready\n", ids[ready]);
+  return ready;
+}
@@ -0,0 +1,96 @@
+/*! \file waitany.h
+    \brief Waiting for any of several objects at once
+
+    A thread serving several sources (console, pipes, worker threads,
+    semaphores) blocks on all of them in a single WaitAny system call
+    instead of dedicating a thread to each source. The thread puts a
+    record on the watch list of each object, and the objects notify
+    their watch list when they may have become ready.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef WAITANY_H
+#define WAITANY_H
+
+#include "kernel/copyright.h"
+#include "utility/queue.h"
+#include "userlib/syscall.h"
+
+class Thread;
+class WaitSet;
+
+/*! \brief Registration of a WaitSet on the watch list of an object
+ */
+class WaitRecord {
+public:
+  WaitSet *set;     //!< The set waiting for the object
+  QueueLink link;   //!< Link in the watch list of the object
+};
+
+//! Watch list of an object, notified when it may have become ready
+typedef Queue<WaitRecord, &WaitRecord::link> WaitList;
+
+/*! \brief Defines the objects a thread waits for
+//
+// All the operations are called with interrupts disabled, so that no
+// notification can be lost between the check of the objects and
+// Block. Notifications are one-shot: Notify empties the watch list,
+// and the woken thread checks its objects again, registering anew
+// if none is ready.
+//
+//	Watch(list) -- register on the watch list of an object
+//
+//	Block() -- sleep until one of the lists is notified
+//
+//	Unwatch() -- leave the lists still watched
+*/
+class WaitSet {
+public:
+  //! Initialize a set of the current thread, watching nothing
+  WaitSet();
+
+  //! Leave the watch lists, if still on some
+  ~WaitSet();
+
+  //! Register on the watch list of an object
+  void Watch(WaitList *list);
+
+  //! Sleep until a watched list is notified (at once if already done)
+  void Block();
+
+  //! Leave the watch lists not notified
+  void Unwatch();
+
+  //! Wake up the threads watching a list, and empty it
+  static void Notify(WaitList *list);
+
+private:
+  Thread *thread;                       //!< The waiting thread
+  bool notified;                        //!< A watched list was notified
+  bool sleeping;                        //!< The thread is in Block
+  int numRecords;                       //!< Number of records in use
+  WaitRecord records[WAIT_ANY_MAX];     //!< One record per watched list
+  WaitList *lists[WAIT_ANY_MAX];        //!< Watched list of each record
+};
+
+//! Return true if WaitAny can wait for the object id
+extern bool CanWaitFor(int64_t id);
+
+//! Block until one of the objects ids is ready (see WaitAny in syscall.h)
+extern int WaitForAny(int64_t *ids, int count);
+
+#endif // WAITANY_H
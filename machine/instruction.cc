@@ -31,6 +31,11 @@ const char * riscvNamesLD[8]   = {"lb", "lh", "lw", "ld", "lbu", "lhu", "lwu"};
 const char * riscvNamesST[8]   = {"sb", "sh", "sw", "sd"};
 const char * riscvNamesBR[8]   = {"beq", "bne", "", "", "blt", "bge", "bltu", "gbeu"};
 const char * riscvNamesMUL[8]  = {"mpylo", "mpyhi", "mpyhi", "mpyhi", "divhi", "divhi", "divlo", "divlo"};
+const char * riscvNamesATOM[32] = {"amoadd", "amoswap", "lr", "sc", "amoxor", "", "", "",
+				   "amoor", "", "", "", "amoand", "", "", "",
+				   "amomin", "", "", "", "amomax", "", "", "",
+				   "amominu", "", "", "", "amomaxu", "", "", ""};
+const char * riscvNamesSYSTEM[8] = {"ecall", "csrrw", "csrrs", "csrrc", "", "csrrwi", "csrrsi", "csrrci"};
 
 Instruction::Instruction(){}
 
@@ -207,7 +212,19 @@ std::string Instruction::printDecodedInstrRISCV(uint64_t pc)
       }
       break;
     case RISCV_SYSTEM:
-      stream << "ecall";
+      stream << riscvNamesSYSTEM[this->funct3];
+      if (this->funct3 != RISCV_SYSTEM_ENV) {
+        stream << " \tx" + std::to_string(this->rd) + " = csr " + std::to_string(this->imm12_I);
+        if (this->funct3 >= RISCV_SYSTEM_CSRRWI)
+          stream << ", " + std::to_string(this->rs1);
+        else
+          stream << ", x" + std::to_string(this->rs1);
+      }
+      break;
+    case RISCV_ATOM:
+      stream << riscvNamesATOM[this->funct7 >> 2];
+      stream << ((this->funct3 == RISCV_ATOM_W) ? ".w" : ".d");
+      stream << " \tx" + std::to_string(this->rd) + ",x" + std::to_string(this->rs2) + ",(x" + std::to_string(this->rs1) + ")";
       break;
     default:
       stream << "??? ";
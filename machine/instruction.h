@@ -117,6 +117,15 @@
 #define RISCV_SYSTEM_CSRRSI 0x6
 #define RISCV_SYSTEM_CSRRCI 0x7
 
+// User counter CSRs (read-only)
+#define RISCV_CSR_CYCLE 0xc00
+#define RISCV_CSR_TIME 0xc01
+#define RISCV_CSR_INSTRET 0xc02
+#define RISCV_CSR_HPMCOUNTER3 0xc03
+#define RISCV_CSR_HPMCOUNTER31 0xc1f
+// Upper 32 bits of the counters, for RV32 programs (cycleh...)
+#define RISCV_CSR_COUNTERH_OFFSET 0x80
+
 #define RISCV_FLW 0x07
 #define RISCV_FSW 0x27
 #define RISCV_FMADD 0x43
@@ -197,6 +206,9 @@
 #define RISCV_FENCE 0x0f
 
 #define RISCV_ATOM 0x2f
+#define RISCV_ATOM_W 0x2
+#define RISCV_ATOM_D 0x3
+
 #define RISCV_ATOM_LR 0x2
 #define RISCV_ATOM_SC 0x3
 #define RISCV_ATOM_SWAP 0x1
@@ -35,15 +35,20 @@
 #include "machine/machine.h"
 #include "kernel/system.h"
 #include "kernel/thread.h"
+#include "kernel/scheduler.h"
 #include "utility/stats.h"
 
 //! String definition for debugging messages
 static char *intLevelNames[] = { (char*)"off", (char*)"on"};
 //! String definition for debugging messages
 static char *intTypeNames[] = { (char*)"timer", (char*)"disk", (char*)"console write", 
-			(char*)"console read",(char*)"ACIA receive",(char*)"ACIA send"
+			(char*)"console read",(char*)"ACIA receive",(char*)"ACIA send",
+			(char*)"alarm"
 };
 
+//! Cache of the pending interrupts
+SlabCache PendingInterrupt::slabCache("PendingInterrupt", sizeof(PendingInterrupt));
+
 //----------------------------------------------------------------------
 // PendingInterrupt::PendingInterrupt
 /*! 	Initialize a hardware device interrupt that is to be scheduled 
@@ -76,6 +81,17 @@ Interrupt::Interrupt()
     pending = new ListTime;
     inHandler = false;
     yieldOnReturn = false;
+    offSince = 0;
+    offSinceTicks = 0;
+    numOffSpans = 0;
+    offNanos = 0;
+    maxOffNanos = 0;
+    maxOffTicks = 0;
+    for (int i = 0; i < NUM_INT_TYPES; i++) {
+	numHandlers[i] = 0;
+	handlerNanos[i] = 0;
+	maxHandlerNanos[i] = 0;
+    }
 }
 
 //----------------------------------------------------------------------
@@ -112,6 +128,11 @@ Interrupt::ChangeLevel(IntStatus old, IntStatus now)
 /*! 	Change interrupts to be enabled or disabled, and if interrupts
 //	are being enabled, advance simulated time by calling OneTick().
 //
+//	The kernel disables interrupts to make its operations atomic:
+//	the time until they are enabled again, possibly by another
+//	thread after a context switch, is the interrupt latency it
+//	imposes. It is measured here (see PrintOffStats).
+//
 //  \return
 //	The old interrupt status.
 // 
@@ -128,8 +149,23 @@ Interrupt::SetStatus(IntStatus now)
 						// interrupts
 
     ChangeLevel(old, now);			// change to new state
-    if ((now == INTERRUPTS_ON) && (old == INTERRUPTS_OFF))
+    // The host clock is only read in detailed mode (see roi.h)
+    if ((now == INTERRUPTS_OFF) && (old == INTERRUPTS_ON)) {
+	offSince = g_stats->detailed ? HostNanos() : 0;
+	offSinceTicks = g_stats->getTotalTicks();
+    }
+    if ((now == INTERRUPTS_ON) && (old == INTERRUPTS_OFF)) {
+	if (offSince != 0) {
+	    uint64_t span = HostNanos() - offSince;
+	    numOffSpans++;
+	    offNanos += span;
+	    if (span > maxOffNanos) {
+		maxOffNanos = span;
+		maxOffTicks = offSinceTicks;
+	    }
+	}
 	OneTick(SYSTEM_TICK);			// advance simulated time
+    }
     return old;
 }
 
@@ -157,6 +193,10 @@ Interrupt::OneTick(int nbcycles)
     } else {
       g_current_thread->GetProcessOwner()->stat->incrUserTicks(nbcycles);
     }
+    g_current_thread->hpmEvents[HPM_CYCLES] += nbcycles;
+    g_stats->hpmEvents[HPM_CYCLES] += nbcycles;
+    if (g_current_thread->GetProcessOwner()->addrspace != NULL)
+      g_current_thread->GetProcessOwner()->addrspace->UpdateInfoTime();
 
     // check any pending interrupts are now ready to fire
     ChangeLevel(INTERRUPTS_ON, INTERRUPTS_OFF);		// first, turn off interrupts
@@ -169,7 +209,7 @@ Interrupt::OneTick(int nbcycles)
 					// for a context switch, ok to do it now
 	yieldOnReturn = false;
  	g_machine->SetStatus(SYSTEM_MODE);		// yield is a kernel routine
-	g_current_thread->Yield();
+	g_scheduler->Preempt();
 	g_machine->SetStatus(old);
     }
 
@@ -217,6 +257,11 @@ Interrupt::Idle()
         yieldOnReturn = false;		// since there's nothing in the
 					// ready queue, the yield is automatic
         g_machine->SetStatus(SYSTEM_MODE);
+	// Waiting for a device is not a latency imposed by the kernel
+	if (offSince != 0) {
+	    offSince = HostNanos();
+	    offSinceTicks = g_stats->getTotalTicks();
+	}
 	return;				// return in case there's now
 					// a runnable thread
     }
@@ -331,7 +376,17 @@ Interrupt::CheckIfDue(bool advanceClock)
     g_machine->SetStatus(SYSTEM_MODE);		// whatever we were doing,
 						// we are now going to be
 						// running in the kernel
-    (*(toOccur->handler))(toOccur->arg);	// call the interrupt handler
+    numHandlers[toOccur->type]++;
+    if (g_stats->detailed) {
+	uint64_t start = HostNanos();
+	(*(toOccur->handler))(toOccur->arg);	// call the interrupt handler
+	uint64_t duration = HostNanos() - start;
+	handlerNanos[toOccur->type] += duration;
+	if (duration > maxHandlerNanos[toOccur->type])
+	    maxHandlerNanos[toOccur->type] = duration;
+    }
+    else
+	(*(toOccur->handler))(toOccur->arg);
     g_machine->SetStatus(old);			// restore the machine status
     inHandler = false;
     delete toOccur;
@@ -369,3 +424,25 @@ Interrupt::DumpState()
     printf("End of pending interrupts\n");
     fflush(stdout);
 }
+
+//----------------------------------------------------------------------
+// Interrupt::PrintOffStats
+/*! 	Print the number and the duration (in host time) of the spans
+//	the kernel ran with interrupts disabled, and of the interrupt
+//	handlers, per kind of interrupt. The longest ones are where
+//	work should be deferred (see kernel/softirq.h).
+*/
+//----------------------------------------------------------------------
+void
+Interrupt::PrintOffStats()
+{
+    printf("Interrupts off: %" PRIu64 " spans, %" PRIu64 " ns in total, "
+	   "longest %" PRIu64 " ns (from cycle %" PRIu64 ")\n",
+	   numOffSpans, offNanos, maxOffNanos, (uint64_t)maxOffTicks);
+    for (int i = 0; i < NUM_INT_TYPES; i++)
+	if (numHandlers[i] != 0)
+	    printf("  %s handler: %" PRIu64 " runs, %" PRIu64
+		   " ns in total, longest %" PRIu64 " ns\n",
+		   intTypeNames[i], numHandlers[i], handlerNanos[i],
+		   maxHandlerNanos[i]);
+}
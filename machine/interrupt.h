@@ -49,17 +49,23 @@
 
 #include "kernel/copyright.h"
 #include "utility/list.h"
+#include "utility/slab.h"
 
 //! Interrupts can be disabled (INT_OFF) or enabled (INT_ON)
 enum IntStatus {INTERRUPTS_OFF, INTERRUPTS_ON};
 
 /*! IntType records which hardware device generated an interrupt.
  In Nachos, we support a hardware timer device, a disk, a console
- display, a keyboard and an ACIA.
+ display, a keyboard and an ACIA. ALARM_INT is the one-shot timer
+ of the kernel alarm clock (see kernel/alarm.h).
 */
-enum IntType {TIMER_INT, DISK_INT, CONSOLE_WRITE_INT, CONSOLE_READ_INT, ACIA_RECEIVE_INT, ACIA_SEND_INT
+enum IntType {TIMER_INT, DISK_INT, CONSOLE_WRITE_INT, CONSOLE_READ_INT, ACIA_RECEIVE_INT, ACIA_SEND_INT,
+	      ALARM_INT
 };
 
+//! Number of kinds of interrupts (see IntType)
+#define NUM_INT_TYPES (ALARM_INT + 1)
+
 /*! \brief  Defines an interrupt that is scheduled
 //          to occur in the future.
 //  
@@ -78,6 +84,11 @@ class PendingInterrupt {
     int64_t arg;                    //!< The argument to the function.
     Time when;			//!< When the interrupt is supposed to fire
     IntType type;		//!< for debugging
+
+    //! Allocated from a cache, one per device event (see slab.h)
+    void *operator new(size_t size) { return slabCache.Alloc(size); }
+    void operator delete(void *obj) { slabCache.Free(obj); }
+    static SlabCache slabCache;
 };
 
 /*! \brief Defines a low level interrupt hardware
@@ -107,7 +118,13 @@ public:
   void YieldOnReturn();		//!< Cause a context switch on return 
 					//!< from an interrupt handler
 
+  bool InHandler() {return inHandler;}	//!< true while running an
+					//!< interrupt handler
+
   void DumpState();			//!< Print interrupt state
+
+  void PrintOffStats();			//!< Print the interrupts-off spans
+					//!< and the cost of each handler
     
 
   // NOTE: the following are internal to the hardware simulation code.
@@ -139,6 +156,18 @@ private:
 
   void ChangeLevel(IntStatus old, 	// setStatus, without advancing the
 	IntStatus now);  		// simulated time
+
+  // Measure of the interrupts-off spans, in host time: the simulated
+  // time does not advance while interrupts are disabled
+  uint64_t offSince;		//!< Host date interrupts were disabled, 0 if unknown
+  Time offSinceTicks;		//!< Simulated date of the same event
+  uint64_t numOffSpans;		//!< Number of interrupts-off spans
+  uint64_t offNanos;		//!< Total duration of the spans
+  uint64_t maxOffNanos;		//!< Duration of the longest span
+  Time maxOffTicks;		//!< Simulated date the longest span began
+  uint64_t numHandlers[NUM_INT_TYPES];	 //!< Handlers run, per kind
+  uint64_t handlerNanos[NUM_INT_TYPES];	 //!< Time spent in them
+  uint64_t maxHandlerNanos[NUM_INT_TYPES]; //!< Longest of them
 };
 
 #endif // INTERRRUPT_H
@@ -96,6 +96,13 @@ Machine::Machine(bool debug) {
   this->console = new Console(NULL,NULL,ConsoleGet,ConsolePut);
   if (g_cfg->ACIA) this->acia = new ACIA(this); else this->acia = NULL;
   
+  // No load-reserved pending
+  reservationValid = false;
+  reservationAddr = 0;
+
+  // No thread uses the FP registers yet
+  fpOwner = NULL;
+
   // Set the machine status
   status = SYSTEM_MODE;
 }
@@ -115,6 +122,103 @@ Machine::~Machine() {
   delete this->console;
 }
 
+//----------------------------------------------------------------------
+// Machine::UseFP
+/*!	Make sure float_registers holds the FP registers of the current
+//	thread, before it executes an FP instruction. The registers are
+//	switched lazily: a context switch does not touch them, and they
+//	are only saved and loaded when a thread executes an FP
+//	instruction while another thread owns them. The registers of the
+//	owner are only saved if it modified them (see FPState), so
+//	integer-only threads never cost any FP register traffic.
+//
+//	\param writes true if the instruction modifies an FP register
+*/
+//----------------------------------------------------------------------
+void
+Machine::UseFP(bool writes)
+{
+  Thread *thread = g_current_thread;
+
+  if (fpOwner != thread) {
+    if (fpOwner != NULL && fpOwner->fpState == FP_DIRTY) {
+      memcpy(fpOwner->GetFPRegisters(), float_registers, sizeof(float_registers));
+      fpOwner->fpState = FP_CLEAN;
+      g_stats->numFPSaves++;
+    }
+    if (thread->fpState == FP_CLEAN) {
+      memcpy(float_registers, thread->GetFPRegisters(), sizeof(float_registers));
+      g_stats->numFPRestores++;
+    }
+    else {
+      memset(float_registers, 0, sizeof(float_registers));
+      thread->fpState = FP_INITIAL;
+    }
+    DEBUG('m', (char *)"FP registers given to thread \"%s\"\n", thread->GetName());
+    fpOwner = thread;
+  }
+  if (writes)
+    thread->fpState = FP_DIRTY;
+}
+
+//----------------------------------------------------------------------
+// Machine::ReleaseFP
+/*!	Forget the owner of the FP registers when it is deleted
+//
+//	\param thread the thread being deleted
+*/
+//----------------------------------------------------------------------
+void
+Machine::ReleaseFP(Thread *thread)
+{
+  if (fpOwner == thread)
+    fpOwner = NULL;
+}
+
+//----------------------------------------------------------------------
+// Machine::ReadCounter
+/*!	Read a user counter CSR. cycle and instret count the cycles and
+//	instructions of the current thread, time the cycles since Nachos
+//	started, and hpmcounterN the event configured for it (see
+//	HpmEvents in config.h). The upper halves (cycleh...) are only
+//	available to RV32 programs, as given by the ELF class of the
+//	program of the current address space.
+//
+//	\param csr number of the CSR
+//	\param value where to store the value of the counter
+//	\return false if csr is not a user counter
+*/
+//----------------------------------------------------------------------
+bool
+Machine::ReadCounter(int csr, uint64_t *value)
+{
+  bool rv32 = g_current_thread->GetProcessOwner()->addrspace->is32Bits;
+  bool high = false;
+  if (rv32 && csr >= RISCV_CSR_CYCLE + RISCV_CSR_COUNTERH_OFFSET
+      && csr <= RISCV_CSR_HPMCOUNTER31 + RISCV_CSR_COUNTERH_OFFSET) {
+    high = true;
+    csr -= RISCV_CSR_COUNTERH_OFFSET;
+  }
+
+  uint64_t *events = g_current_thread->hpmEvents;
+  if (csr == RISCV_CSR_CYCLE)
+    *value = events[HPM_CYCLES];
+  else if (csr == RISCV_CSR_TIME)
+    *value = g_stats->getTotalTicks();
+  else if (csr == RISCV_CSR_INSTRET)
+    *value = events[HPM_INSTRUCTIONS];
+  else if (csr >= RISCV_CSR_HPMCOUNTER3 && csr <= RISCV_CSR_HPMCOUNTER31)
+    *value = events[g_cfg->HpmEvents[csr - RISCV_CSR_HPMCOUNTER3]];
+  else
+    return false;
+
+  if (high)
+    *value >>= 32;
+  else if (rv32)
+    *value = (int64_t)(int32_t)*value;
+  return true;
+}
+
 //----------------------------------------------------------------------
 // Machine::RaiseException
 /*! 	Transfer control to the Nachos kernel from user mode, because
@@ -327,7 +431,10 @@ int
 Machine::OneInstruction(Instruction *instr)
 {
   int execution_time;           // execution time of the instruction
-  if (!mmu->ReadMem(pc, 4, &(instr->value)))
+  mmu->fetching = true;
+  bool fetched = mmu->ReadMem(pc, 4, &(instr->value));
+  mmu->fetching = false;
+  if (!fetched)
     return 0;			// exception occurred
   instr->Decode();
 
@@ -336,9 +443,11 @@ Machine::OneInstruction(Instruction *instr)
 
   // Update statistics
   g_current_thread->GetProcessOwner()->stat->incrNumInstruction();
+  g_current_thread->hpmEvents[HPM_INSTRUCTIONS]++;
+  g_stats->hpmEvents[HPM_INSTRUCTIONS]++;
 
   // Print its textual representation if debug flag 'm' is set
-  if (DebugIsEnabled('m')) {
+  if (g_stats->detailed && DebugIsEnabled('m')) {
     printf("%s: \t[PC: 0x%" PRIx64 "] \t%s\n",g_current_thread->GetName(),
 	   pc,instr->printDecodedInstrRISCV(pc).c_str());
     //DumpState();
@@ -801,22 +910,113 @@ Machine::OneInstruction(Instruction *instr)
     //******************************************************************************************
     // Treatment for: SYSTEM INSTRUCTIONS
     case RISCV_SYSTEM:
-      if(SYSCALL_EXCEPTION <= 33 && SYSCALL_EXCEPTION >= 0){
-	      g_machine->RaiseException(SYSCALL_EXCEPTION, pc);
-      } else {
-        fprintf(stderr, "Unresolved system call %d\n", SYSCALL_EXCEPTION);
+      if (instr->funct3 == RISCV_SYSTEM_ENV) {
+	if(SYSCALL_EXCEPTION <= 33 && SYSCALL_EXCEPTION >= 0){
+	  g_machine->RaiseException(SYSCALL_EXCEPTION, pc);
+	} else {
+	  fprintf(stderr, "Unresolved system call %d\n", SYSCALL_EXCEPTION);
+	}
+	break;
+      }
+      // CSR instructions: only the reads of the user counters are
+      // supported. CSRRW(I) always writes; CSRRS(I) and CSRRC(I)
+      // write unless their source is x0 (or an immediate of 0).
+      {
+	uint64_t counter;
+	bool writes = (instr->funct3 == RISCV_SYSTEM_CSRRW
+		       || instr->funct3 == RISCV_SYSTEM_CSRRWI
+		       || instr->rs1 != 0);
+	if (writes || !ReadCounter(instr->imm12_I, &counter)) {
+	  RaiseException(ILLEGALINSTR_EXCEPTION, pc - 4);
+	  return 0;
+	}
+	int_registers[instr->rd] = counter;
       }
       break;
       
+    //******************************************************************************************
+    // Treatment for: ATOMIC INSTRUCTIONS (A extension)
+    // The machine has a single hart, so the read-modify-write sequences
+    // below are atomic as long as no context switch happens between an
+    // LR and the matching SC (the kernel invalidates the reservation
+    // on every context switch).
+    case RISCV_ATOM:
+      {
+	uint64_t addr = int_registers[instr->rs1];
+	int size = (instr->funct3 == RISCV_ATOM_W) ? 4 : 8;
+	int64_t src = int_registers[instr->rs2];
+	int64_t old, res = 0;
+
+	if ((instr->funct7 >> 2) == RISCV_ATOM_SC) {
+	  if (reservationValid && reservationAddr == addr) {
+	    if (!mmu->WriteMem(addr, size, src))
+	      return 0;
+	    int_registers[instr->rd] = 0;
+	  }
+	  else
+	    int_registers[instr->rd] = 1;
+	  reservationValid = false;
+	  break;
+	}
+
+	if (!mmu->ReadMem(addr, size, &value))
+	  return 0;
+	if (size == 4) {
+	  old = (int32_t)value;
+	  src = (int32_t)src;
+	}
+	else
+	  old = value;
+
+	switch (instr->funct7 >> 2) {
+	case RISCV_ATOM_LR:
+	  reservationValid = true;
+	  reservationAddr = addr;
+	  int_registers[instr->rd] = old;
+	  break;
+	case RISCV_ATOM_SWAP: res = src; break;
+	case RISCV_ATOM_ADD: res = old + src; break;
+	case RISCV_ATOM_XOR: res = old ^ src; break;
+	case RISCV_ATOM_AND: res = old & src; break;
+	case RISCV_ATOM_OR: res = old | src; break;
+	case RISCV_ATOM_MIN: res = MIN(old, src); break;
+	case RISCV_ATOM_MAX: res = MAX(old, src); break;
+	case RISCV_ATOM_MINU:
+	  if (size == 4)
+	    res = ((uint32_t)old < (uint32_t)src) ? old : src;
+	  else
+	    res = ((uint64_t)old < (uint64_t)src) ? old : src;
+	  break;
+	case RISCV_ATOM_MAXU:
+	  if (size == 4)
+	    res = ((uint32_t)old > (uint32_t)src) ? old : src;
+	  else
+	    res = ((uint64_t)old > (uint64_t)src) ? old : src;
+	  break;
+	default:
+	  printf("In ATOM switch case, this should never happen... Instr was %x\n", (int)instr->value);
+	  exit(ERROR);
+	  break;
+	}
+	if ((instr->funct7 >> 2) == RISCV_ATOM_LR)
+	  break;
+	if (!mmu->WriteMem(addr, size, res))
+	  return 0;
+	int_registers[instr->rd] = old;
+      }
+      break;
+
     //******************************************************************************************
     // Treatment for: floating point operations
     case RISCV_FLW:
+      UseFP(true);
       if (!mmu->ReadMem(int_registers[instr->rs1] + instr->imm12_I_signed, 4, &value))
 	  return 0;
       	float_registers[instr->rd] = value;
 	break;
 		
     case RISCV_FSW:
+      UseFP(false);
 
       if (!mmu->WriteMem((uint32_t)(int_registers[instr->rs1] + instr->imm12_S_signed), 4, float_registers[instr->rs2]))
 			return 0;
@@ -824,22 +1024,30 @@ Machine::OneInstruction(Instruction *instr)
 		break;
       
     case RISCV_FMADD:
+      UseFP(true);
       float_registers[instr->rd] = float_registers[instr->rs1] * float_registers[instr->rs2] + float_registers[instr->rs3];
       break;
 
     case RISCV_FMSUB:
+      UseFP(true);
       float_registers[instr->rd] = float_registers[instr->rs1] * float_registers[instr->rs2] - float_registers[instr->rs3];
       break;
 
     case RISCV_FNMSUB:
+      UseFP(true);
       float_registers[instr->rd] = -float_registers[instr->rs1] * float_registers[instr->rs2] + float_registers[instr->rs3];
       break;
 
     case RISCV_FNMADD:
+      UseFP(true);
       float_registers[instr->rd] = -float_registers[instr->rs1] * float_registers[instr->rs2] - float_registers[instr->rs3];
       break;
 
     case RISCV_FP:
+      // Comparisons, conversions to integers and moves to integer
+      // registers leave the FP registers unchanged
+      UseFP(instr->funct7 != RISCV_FP_FCMP && instr->funct7 != RISCV_FP_FCVTW
+	    && instr->funct7 != RISCV_FP_FMVXFCLASS);
       switch (instr->funct7) {
         case RISCV_FP_ADD:
           float_registers[instr->rd] = float_registers[instr->rs1] + float_registers[instr->rs2];
@@ -82,6 +82,7 @@ enum ExceptionType : short {
 // Possible exceptions recognized by the machine
 
 class Console;
+class Thread;
 
 /*! Nachos-RiscV can be running kernel code (SYSTEM_MODE), user code (USER_MODE),
  or there can be no runnable thread, because the ready list 
@@ -101,6 +102,16 @@ enum MachineStatus {IDLE_MODE, SYSTEM_MODE, USER_MODE};
 #define NUM_INT_REGS 	32      //!< Number of integer registers 
 #define NUM_FP_REGS     32      //!< Number of floating point registers
 
+/*! State of the floating point registers of a thread, as the FS
+//  field of the RISC-V mstatus register (see Machine::UseFP)
+*/
+enum FPState {
+  FP_OFF,       //!< Never used: the registers are all zero
+  FP_INITIAL,   //!< Used, but still all zero: no copy to keep
+  FP_CLEAN,     //!< The copy in the thread context is up to date
+  FP_DIRTY      //!< Modified since the last save (owner only)
+};
+
 
 
 /*! \brief Defines the simulated execution hardware
@@ -147,6 +158,17 @@ class Machine {
     				//!< Run one instruction of a user program.
                                 //!< Return the execution time of the instr (cycle)
 
+    void UseFP(bool writes);	//!< Give the FP registers to the current
+				//!< thread, before an FP instruction
+
+    void ReleaseFP(Thread *thread); //!< Forget the FP registers of a
+				//!< deleted thread
+
+    bool ReadCounter(int csr, uint64_t *value);
+				//!< Read a user counter CSR (cycle, time,
+				//!< instret, hpmcounterN) of the current
+				//!< thread, false if csr is not one
+
     void RaiseException(ExceptionType which, int badVAddr);
 				//!< Trap to the Nachos kernel, because of a
 				//!< system call or other exception.  
@@ -183,6 +205,11 @@ class Machine {
   Disk *diskSwap;		/*!< Swap raw disk device (hardware) */
   Console *console;             /*!< Console */
 
+  bool reservationValid;        /*!< A load-reserved (LR) is pending */
+  Thread *fpOwner;              /*!< Thread whose FP registers are in
+				  float_registers, NULL if none */
+  uint64_t reservationAddr;     /*!< Address reserved by the last LR */
+
 private:
   MachineStatus status;	//!< idle, kernel mode, user mode
 
@@ -46,6 +46,7 @@
 //----------------------------------------------------------------------
 MMU::MMU() {
   translationTable = NULL;
+  fetching = false;
 }
 
 //----------------------------------------------------------------------
@@ -81,6 +82,8 @@ MMU::ReadMem(uint64_t virtAddr, int size, uint64_t *value)
 
     // Update statistics
     g_current_thread->GetProcessOwner()->stat->incrMemoryAccess();
+    g_current_thread->hpmEvents[HPM_MEMORY_ACCESSES]++;
+    g_stats->hpmEvents[HPM_MEMORY_ACCESSES]++;
 
     // Perform address translation
     exc = Translate(virtAddr, &physAddr, size, false);
@@ -143,6 +146,8 @@ MMU::WriteMem(uint64_t addr, int size, uint64_t value)
 
     // Update statistics
     g_current_thread->GetProcessOwner()->stat->incrMemoryAccess();
+    g_current_thread->hpmEvents[HPM_MEMORY_ACCESSES]++;
+    g_stats->hpmEvents[HPM_MEMORY_ACCESSES]++;
 
     // Perform address translation
     exc = Translate(addr, &physicalAddress, size, true);
@@ -252,6 +257,8 @@ MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing)
   if (!translationTable->getBitValid(vpn)) {
     // Update statistics
     g_current_thread->GetProcessOwner()->stat->incrPageFault();
+    g_current_thread->hpmEvents[HPM_PAGE_FAULTS]++;
+    g_stats->hpmEvents[HPM_PAGE_FAULTS]++;
     DEBUG('h', (char *)"Raising page fault exception for page number %i\n",
 	  vpn);
 
@@ -60,6 +60,10 @@ public:
   // to physical addresses (relative to the beginning of "mainMemory")
   // is controlled by a traditional linear page table
   TranslationTable *translationTable; //!< Pointer to the translation table
+
+  bool fetching;                //!< Set by the machine while it fetches
+                                //!< an instruction, so that a page fault
+                                //!< is attributed to the right PC
 };
 
 #endif // MMU_H
@@ -55,6 +55,7 @@ extern "C" {
 #include <sys/file.h>
 #include <sys/un.h>
 #include <sys/mman.h>
+#include <time.h>
 #include <sys/time.h>
 #include <fcntl.h>
 #include <netdb.h>
@@ -383,6 +384,23 @@ Delay(int seconds)
     (void) sleep((unsigned) seconds);
 }
 
+//----------------------------------------------------------------------
+// HostNanos
+/*! 	Read the monotonic clock of the host. Unlike the simulated
+//	time, it also advances while the kernel runs with interrupts
+//	disabled.
+//
+//	\return the time in nanoseconds since an arbitrary origin
+*/
+//----------------------------------------------------------------------
+uint64_t
+HostNanos()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
 //----------------------------------------------------------------------
 // Abort
 //! 	Quit and drop core.
@@ -70,6 +70,9 @@ extern void Abort();
 extern void Exit(int exitCode);
 extern void Delay(int seconds);
 
+// Host clock, to measure the cost of the simulation itself
+extern uint64_t HostNanos();
+
 // Initialize system so that cleanUp routine is called when user hits ctl-C
 extern void CallOnUserAbort(VoidNoArgFunctionPtr cleanUp);
 
@@ -78,14 +81,14 @@ extern void RandomInit(unsigned seed);
 extern int Random();
 
 /* Allocate, de-allocate an array, such that de-referencing
-// just beyond either end of the array will cause an error
+// just beyond either end of the array will cause an error
 */
 
 extern int8_t*AllocBoundedArray(size_t size);
 extern void DeallocBoundedArray(int8_t *p, size_t size);
 
 /* Other C library routines that are used by Nachos.
-// These are assumed to be portable, so we don't include a wrapper.
+// These are assumed to be portable, so we don't include a wrapper.
 */
 extern "C" {
 #include <stdlib.h>  // atoi, atof, abs
@@ -0,0 +1,84 @@
+/* aio.c
+ *	Test program for asynchronous I/O.
+ *
+ *	Two writes are in flight at once in different parts of a file,
+ *	and collected in the reverse order. The file is then read back
+ *	asynchronously while polling for the end of the transfer.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+ */
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define SIZE 200
+
+char first[SIZE];
+char second[SIZE];
+char result[2 * SIZE];
+int errors;
+
+// Report a failed check
+static void
+check(int ok, char *what)
+{
+  if (!ok) {
+    n_printf("aio: %s failed\n", what);
+    errors++;
+  }
+}
+
+int
+main()
+{
+  OpenFileId f;
+  AioId a, b;
+  int n;
+
+  n_memset(first, 'a', SIZE);
+  n_memset(second, 'b', SIZE);
+  Create("/aiotest", 2 * SIZE);
+  f = Open("/aiotest");
+  check(f != -1, "Open");
+
+  // Two writes in flight, collected in the reverse order
+  a = AioWrite(first, SIZE, f, 0);
+  b = AioWrite(second, SIZE, f, SIZE);
+  check(a != -1 && b != -1, "AioWrite");
+  check(AioWait(b) == SIZE, "second write");
+  check(AioWait(a) == SIZE, "first write");
+
+  // Read the whole file back, polling
+  a = AioRead(result, 2 * SIZE, f, 0);
+  check(a != -1, "AioRead");
+  while ((n = AioPoll(a)) == AIO_PENDING)
+    Yield();
+  check(n == 2 * SIZE, "read size");
+  check(n_memcmp(result, first, SIZE) == 0
+	&& n_memcmp(result + SIZE, second, SIZE) == 0, "read data");
+
+  // Error paths: collected transfer, console, negative size or offset
+  check(AioWait(a) < 0, "AioWait of a collected transfer");
+  check(AioRead(result, SIZE, CONSOLE_INPUT, 0) == -1, "AioRead of the console");
+  check(AioWrite(first, -1, f, 0) == -1, "AioWrite of a negative size");
+  check(AioRead(result, SIZE, f, -1) == -1, "AioRead at a negative offset");
+
+  Close(f);
+  Remove("/aiotest");
+  n_printf("aio: %d errors\n", errors);
+  Exit(errors);
+  return 0;
+}
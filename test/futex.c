@@ -0,0 +1,114 @@
+/* futex.c
+ *	Test program for the user-space synchronization tools of
+ *	libnachos (mutexes, semaphores and condition variables built
+ *	on FutexWait and FutexWake).
+ *
+ *	Several threads increment a shared counter under a mutex,
+ *	yielding inside the critical section so that the others have
+ *	to block on it, then wait on a condition variable for the main
+ *	thread and signal their end with a semaphore.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+ */
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NUM_THREADS 4
+#define NUM_ITER 20
+
+n_mutex_t mutex;
+n_cond_t cond;
+n_sem_t done;
+int counter;
+int ready;
+int go;
+int errors;
+
+// Report a failed check
+static void
+check(int ok, char *what)
+{
+  if (!ok) {
+    n_printf("futex: %s failed\n", what);
+    errors++;
+  }
+}
+
+static void
+worker()
+{
+  int i, value;
+
+  // Contention on the mutex: the increment is not atomic without it
+  for (i = 0; i < NUM_ITER; i++) {
+    n_mutex_lock(&mutex);
+    value = counter;
+    Yield();
+    counter = value + 1;
+    n_mutex_unlock(&mutex);
+  }
+
+  // Wait for the main thread to let all the workers go at once
+  n_mutex_lock(&mutex);
+  ready++;
+  n_cond_signal(&cond);
+  while (!go)
+    n_cond_wait(&cond, &mutex);
+  n_mutex_unlock(&mutex);
+
+  n_sem_V(&done);
+}
+
+int
+main()
+{
+  int i;
+
+  n_mutex_init(&mutex);
+  n_cond_init(&cond);
+  n_sem_init(&done, 0);
+
+  for (i = 0; i < NUM_THREADS; i++)
+    threadCreate("futex worker", worker);
+
+  n_mutex_lock(&mutex);
+  while (ready < NUM_THREADS)
+    n_cond_wait(&cond, &mutex);
+  check(counter == NUM_THREADS * NUM_ITER, "mutual exclusion");
+  go = 1;
+  n_cond_broadcast(&cond);
+
+  // The mutex is held: trylock must fail
+  check(n_mutex_trylock(&mutex) == -1, "trylock of a locked mutex");
+  n_mutex_unlock(&mutex);
+  check(n_mutex_trylock(&mutex) == 0, "trylock of a free mutex");
+  n_mutex_unlock(&mutex);
+
+  for (i = 0; i < NUM_THREADS; i++)
+    n_sem_P(&done);
+
+  // Error paths: misaligned word, value already changed, no waiter
+  check(FutexWait((int *)((char *)&counter + 1), 0) < 0,
+	"FutexWait on a misaligned word");
+  check(FutexWait(&counter, counter + 1) == 0,
+	"FutexWait on a changed value");
+  check(FutexWake(&counter, 1) == 0, "FutexWake without waiters");
+
+  n_printf("futex: %d errors\n", errors);
+  Exit(errors);
+  return 0;
+}
@@ -0,0 +1,101 @@
+/* gthreads.c
+ *	Test program for the green threads of libnachos.
+ *
+ *	Many green threads, more than the workers running them, yield
+ *	to each other while updating a shared counter. One of them
+ *	creates and joins another green thread.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+ */
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NUM_GTHREADS 32
+#define NUM_WORKERS 3
+#define NUM_ITER 5
+#define STACK_SIZE 1024
+
+n_gthread_t threads[NUM_GTHREADS];
+char stacks[NUM_GTHREADS][STACK_SIZE];
+n_gthread_t child;
+char child_stack[STACK_SIZE];
+
+n_mutex_t mutex;
+int counter;
+int child_done;
+int errors;
+
+// Report a failed check
+static void
+check(int ok, char *what)
+{
+  if (!ok) {
+    n_printf("gthreads: %s failed\n", what);
+    errors++;
+  }
+}
+
+static void
+body(void *arg)
+{
+  int i;
+
+  check(n_gthread_self() == (n_gthread_t *)arg, "n_gthread_self");
+  for (i = 0; i < NUM_ITER; i++) {
+    n_mutex_lock(&mutex);
+    counter++;
+    n_mutex_unlock(&mutex);
+    n_gthread_yield();
+  }
+}
+
+static void
+child_body(void *arg)
+{
+  n_gthread_yield();
+  child_done = 1;
+}
+
+// Create a green thread from a green thread, and wait for it
+static void
+parent_body(void *arg)
+{
+  n_gthread_create(&child, child_stack, STACK_SIZE, child_body, 0);
+  n_gthread_join(&child);
+  check(child_done, "n_gthread_join");
+}
+
+int
+main()
+{
+  int i;
+
+  n_mutex_init(&mutex);
+  check(n_gthread_self() == 0, "n_gthread_self outside a green thread");
+
+  for (i = 0; i < NUM_GTHREADS - 1; i++)
+    n_gthread_create(&threads[i], stacks[i], STACK_SIZE, body, &threads[i]);
+  n_gthread_create(&threads[i], stacks[i], STACK_SIZE, parent_body, 0);
+
+  n_gthread_run(NUM_WORKERS);
+  check(counter == (NUM_GTHREADS - 1) * NUM_ITER, "shared counter");
+  check(child_done, "green thread created by a green thread");
+
+  n_printf("gthreads: %d errors\n", errors);
+  Exit(errors);
+  return 0;
+}
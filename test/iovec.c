@@ -0,0 +1,93 @@
+/* iovec.c
+ *	Test program for vectored I/O (Readv and Writev).
+ *
+ *	A header and a payload are written with a single Writev, and
+ *	read back with a Readv splitting them differently.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+ */
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define HEADER_SIZE 16
+#define PAYLOAD_SIZE 150
+
+char header[HEADER_SIZE];
+char payload[PAYLOAD_SIZE];
+char in1[10], in2[100], in3[HEADER_SIZE + PAYLOAD_SIZE - 110];
+int errors;
+
+// Report a failed check
+static void
+check(int ok, char *what)
+{
+  if (!ok) {
+    n_printf("iovec: %s failed\n", what);
+    errors++;
+  }
+}
+
+int
+main()
+{
+  Nachos_IoVec out[2], in[3], many[NACHOS_IOV_MAX + 1];
+  OpenFileId f;
+  int i;
+
+  n_memset(header, 'h', HEADER_SIZE);
+  for (i = 0; i < PAYLOAD_SIZE; i++)
+    payload[i] = 'a' + i % 26;
+  Create("/iovtest", HEADER_SIZE + PAYLOAD_SIZE);
+  f = Open("/iovtest");
+  check(f != -1, "Open");
+
+  out[0].base = header;
+  out[0].len = HEADER_SIZE;
+  out[1].base = payload;
+  out[1].len = PAYLOAD_SIZE;
+  check(Writev(out, 2, f) == HEADER_SIZE + PAYLOAD_SIZE, "Writev");
+
+  // Read back in three buffers cut at other places
+  Seek(0, f);
+  in[0].base = in1;
+  in[0].len = sizeof(in1);
+  in[1].base = in2;
+  in[1].len = sizeof(in2);
+  in[2].base = in3;
+  in[2].len = sizeof(in3);
+  check(Readv(in, 3, f) == HEADER_SIZE + PAYLOAD_SIZE, "Readv");
+  check(n_memcmp(in1, header, 10) == 0
+	&& n_memcmp(in2, header + 10, HEADER_SIZE - 10) == 0
+	&& n_memcmp(in2 + HEADER_SIZE - 10, payload, 100 - HEADER_SIZE + 10) == 0
+	&& n_memcmp(in3, payload + 100 - HEADER_SIZE + 10, sizeof(in3)) == 0,
+	"Readv data");
+
+  // Error paths: negative count, too many buffers, negative length
+  check(Writev(out, 0, f) == 0, "Writev of no buffer");
+  check(Writev(out, -1, f) < 0, "Writev of a negative count");
+  for (i = 0; i <= NACHOS_IOV_MAX; i++)
+    many[i] = out[0];
+  check(Writev(many, NACHOS_IOV_MAX + 1, f) < 0, "Writev of too many buffers");
+  in[1].len = -1;
+  check(Readv(in, 3, f) < 0, "Readv of a negative length");
+
+  Close(f);
+  Remove("/iovtest");
+  n_printf("iovec: %d errors\n", errors);
+  Exit(errors);
+  return 0;
+}
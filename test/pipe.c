@@ -0,0 +1,79 @@
+/* pipe.c
+ *	Test program for pipes.
+ *
+ *	A thread blocks reading an empty pipe until the main thread
+ *	writes in it, then blocks again until the main thread closes
+ *	the write end. Writing fails once the read end is closed.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+ */
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+OpenFileId ends[2];
+char buffer[32];
+int numread;
+int errors;
+
+// Report a failed check
+static void
+check(int ok, char *what)
+{
+  if (!ok) {
+    n_printf("pipe: %s failed\n", what);
+    errors++;
+  }
+}
+
+// Read the message of the main thread, then the end of the pipe
+static void
+reader()
+{
+  numread = Read(buffer, sizeof(buffer), ends[0]);
+  check(Read(buffer, sizeof(buffer), ends[0]) == 0,
+	"Read of a pipe closed while blocked");
+}
+
+int
+main()
+{
+  OpenFileId other[2];
+  ThreadId tid;
+
+  check(PipeCreate(ends) == 0, "PipeCreate");
+  tid = threadCreate("pipe reader", reader);
+
+  // Let the reader block on the empty pipe
+  Yield();
+  check(Write("hello", 5, ends[1]) == 5, "Write");
+  Yield();
+  Close(ends[1]);
+  Join(tid);
+  check(numread == 5 && n_memcmp(buffer, "hello", 5) == 0, "Read");
+
+  // Error paths: closed read end, closed identifier
+  check(PipeCreate(other) == 0, "second PipeCreate");
+  Close(other[0]);
+  check(Write("lost", 4, other[1]) < 0, "Write without a reader");
+  check(Read(buffer, sizeof(buffer), ends[1]) < 0, "Read of a closed end");
+  Close(other[1]);
+  Close(ends[0]);
+
+  n_printf("pipe: %d errors\n", errors);
+  Exit(errors);
+  return 0;
+}
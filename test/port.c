@@ -0,0 +1,92 @@
+/* port.c
+ *	Test program for message ports.
+ *
+ *	A thread blocks receiving on a port whose identifier is then
+ *	destroyed by the main thread: the port must stay alive until the
+ *	message sent through a new identifier arrives.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+ */
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+// Messages start on a page boundary (PageSize in nachos.cfg)
+#define PAGE_SIZE 128
+#define MSG_SIZE (2 * PAGE_SIZE)
+
+char outbox[MSG_SIZE] __attribute__((aligned(PAGE_SIZE)));
+char inbox[MSG_SIZE] __attribute__((aligned(PAGE_SIZE)));
+PortId port;
+int received;
+int errors;
+
+// Report a failed check
+static void
+check(int ok, char *what)
+{
+  if (!ok) {
+    n_printf("port: %s failed\n", what);
+    errors++;
+  }
+}
+
+static void
+receiver()
+{
+  received = PortReceive(port, inbox, MSG_SIZE);
+}
+
+int
+main()
+{
+  PortId again;
+  ThreadId tid;
+  int i;
+
+  port = PortCreate("test");
+  tid = threadCreate("port receiver", receiver);
+
+  // Destroy the identifier while the receiver is blocked on it
+  Yield();
+  check(PortDestroy(port) == 0, "PortDestroy");
+  again = PortCreate("test");
+
+  n_memset(outbox, 'm', MSG_SIZE);
+  check(PortSend(again, outbox, MSG_SIZE) == 0, "PortSend");
+  for (i = 0; i < MSG_SIZE; i++)
+    if (outbox[i] != 0) break;
+  check(i == MSG_SIZE, "sent buffer zeroed");
+  Join(tid);
+  check(received == MSG_SIZE, "PortReceive size");
+  for (i = 0; i < MSG_SIZE; i++)
+    if (inbox[i] != 'm') break;
+  check(i == MSG_SIZE, "PortReceive data");
+
+  // Error paths: misaligned buffer, too small buffer (the message
+  // stays on the port), destroyed identifier
+  check(PortSend(again, outbox + 1, PAGE_SIZE) < 0, "PortSend of a misaligned buffer");
+  check(PortSend(again, outbox, PAGE_SIZE) == 0, "second PortSend");
+  check(PortReceive(again, inbox, PAGE_SIZE - 1) < 0, "PortReceive in a small buffer");
+  check(PortReceive(again, inbox, MSG_SIZE) == PAGE_SIZE, "second PortReceive");
+  check(PortSend(port, outbox, PAGE_SIZE) < 0, "PortSend on a destroyed identifier");
+  check(PortDestroy(port) < 0, "second PortDestroy");
+  PortDestroy(again);
+
+  n_printf("port: %d errors\n", errors);
+  Exit(errors);
+  return 0;
+}
@@ -0,0 +1,125 @@
+/* ring.c
+ *	Test program for the syscall ring.
+ *
+ *	A thread blocks in a P request of the ring while the main
+ *	thread executes the V waking it up: the completion queue must
+ *	hold both completions, and refuse more requests while it is
+ *	full. Requests that fail post their error as a result.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+ */
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define ENTRIES 2
+
+Nachos_Ring ring;
+Nachos_RingSqe sqes[ENTRIES];
+Nachos_RingCqe cqes[ENTRIES];
+SemId sema;
+int errors;
+
+// Report a failed check
+static void
+check(int ok, char *what)
+{
+  if (!ok) {
+    n_printf("ring: %s failed\n", what);
+    errors++;
+  }
+}
+
+// Queue a request in the submission queue
+static void
+submit(int op, unsigned long id, char *addr, int len, unsigned long data)
+{
+  Nachos_RingSqe *sqe = &sqes[ring.sq_tail % ENTRIES];
+  sqe->op = op;
+  sqe->id = id;
+  sqe->addr = (unsigned long)addr;
+  sqe->len = len;
+  sqe->user_data = data;
+  ring.sq_tail++;
+}
+
+// Take the next completion, which must be the one of request data
+static long
+reap(unsigned long data)
+{
+  Nachos_RingCqe *cqe;
+
+  if (ring.cq_head == ring.cq_tail) {
+    check(0, "completion posted");
+    return -1;
+  }
+  cqe = &cqes[ring.cq_head % ENTRIES];
+  check(cqe->user_data == data, "completion order");
+  ring.cq_head++;
+  return cqe->result;
+}
+
+// Block in a P request until the main thread executes a V
+static void
+waiter()
+{
+  submit(RING_OP_P, sema, 0, 0, 1);
+  check(RingEnter(1) == 1, "blocking request");
+}
+
+int
+main()
+{
+  ThreadId tid;
+
+  // Error paths: no ring yet, size not a power of 2
+  check(RingEnter(0) < 0, "RingEnter without a ring");
+  ring.sqes = sqes;
+  ring.cqes = cqes;
+  check(RingSetup(&ring, 3) < 0, "RingSetup of 3 entries");
+  check(RingSetup(&ring, ENTRIES) == 0, "RingSetup");
+
+  sema = SemCreate("ring", 0);
+  tid = threadCreate("ring waiter", waiter);
+  while (ring.sq_head == 0)
+    Yield();
+
+  // The waiter holds a completion slot while blocked: after the V,
+  // the queue is full and the next request must wait
+  submit(RING_OP_V, sema, 0, 0, 2);
+  check(RingEnter(1) == 1, "waking request");
+  submit(RING_OP_V, sema, 0, 0, 3);
+  check(RingEnter(0) == 0, "request with a full completion queue");
+  Join(tid);
+  check(reap(2) == 0, "V result");
+  check(reap(1) == 0, "P result");
+
+  // Once the completions are consumed, the request goes on
+  check(RingEnter(0) == 1, "request after the queue is emptied");
+  check(reap(3) == 0, "late V result");
+
+  // Failed requests post their error
+  submit(RING_OP_OPEN, 0, "/no such file", 0, 4);
+  submit(42, 0, 0, 0, 5);
+  check(RingEnter(0) == 2, "failing requests");
+  check(reap(4) < 0, "Open of a missing file");
+  check(reap(5) < 0, "unknown operation");
+
+  SemDestroy(sema);
+  n_printf("ring: %d errors\n", errors);
+  Exit(errors);
+  return 0;
+}
@@ -0,0 +1,82 @@
+/* roi.c
+ *	Test program for regions of interest.
+ *
+ *	Two phases are measured as separate regions, one of them
+ *	entered twice; the statistics of each region are printed when
+ *	Nachos halts. Run it with FastForward = 1 in nachos.cfg to check
+ *	that only the regions are simulated in detail.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+ */
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NUM 100
+// Regions created before the error path, and ROI_MAX of kernel/roi.h
+#define NUM_REGIONS 2
+#define MAX_REGIONS 16
+
+int A[NUM];
+int errors;
+
+// Report a failed check
+static void
+check(int ok, char *what)
+{
+  if (!ok) {
+    n_printf("roi: %s failed\n", what);
+    errors++;
+  }
+}
+
+int
+main()
+{
+  char name[16];
+  int i, j, sum = 0;
+
+  check(RoiEnd() < 0, "RoiEnd without a region");
+
+  // Beginning a region ends the active one
+  check(RoiBegin("init") == 0, "RoiBegin");
+  for (i = 0; i < NUM; i++)
+    A[i] = i;
+  check(RoiBegin("sum") == 0, "RoiBegin of a second region");
+  for (i = 0; i < NUM; i++)
+    sum += A[i];
+  check(RoiEnd() == 0, "RoiEnd");
+  check(RoiEnd() < 0, "second RoiEnd");
+
+  // Entering a region again does not create another one
+  check(RoiBegin("init") == 0, "RoiBegin of an existing region");
+  for (i = 0; i < NUM; i++)
+    A[i] = NUM - i;
+  RoiEnd();
+  check(sum == NUM * (NUM - 1) / 2, "sum");
+
+  // Error path: too many regions
+  for (j = NUM_REGIONS; j < MAX_REGIONS; j++) {
+    n_snprintf(name, sizeof(name), "region %d", j);
+    check(RoiBegin(name) == 0, "RoiBegin of a new region");
+  }
+  check(RoiBegin("one too many") < 0, "RoiBegin of too many regions");
+  RoiEnd();
+
+  n_printf("roi: %d errors\n", errors);
+  Exit(errors);
+  return 0;
+}
@@ -0,0 +1,112 @@
+/* rwlock.c
+ *	Test program for reader-writer locks and barriers.
+ *
+ *	Threads alternate between reading and writing shared state under
+ *	a reader-writer lock, yielding while they hold it, and meet at a
+ *	barrier between the phases. Destroying the lock or the barrier
+ *	while in use must fail.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+ */
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NUM_THREADS 4
+#define NUM_PHASES 3
+
+RWLockId rwlock;
+BarrierId barrier;
+int readers;
+int writers;
+int serials;
+int arrived;
+int errors;
+
+// Report a failed check
+static void
+check(int ok, char *what)
+{
+  if (!ok) {
+    n_printf("rwlock: %s failed\n", what);
+    errors++;
+  }
+}
+
+static void
+worker()
+{
+  int phase;
+
+  for (phase = 0; phase < NUM_PHASES; phase++) {
+    RWLockWrite(rwlock);
+    check(readers == 0 && writers == 0, "exclusive write");
+    writers++;
+    Yield();
+    writers--;
+    RWLockRelease(rwlock);
+
+    RWLockRead(rwlock);
+    check(writers == 0, "shared read");
+    readers++;
+    Yield();
+    readers--;
+    RWLockRelease(rwlock);
+
+    arrived++;
+    if (BarrierWait(barrier) == BARRIER_SERIAL)
+      serials++;
+  }
+}
+
+int
+main()
+{
+  ThreadId tids[NUM_THREADS];
+  int i;
+
+  rwlock = RWLockCreate("test", RWLOCK_WRITER_PREF);
+  barrier = BarrierCreate("test", NUM_THREADS + 1);
+
+  for (i = 0; i < NUM_THREADS; i++)
+    tids[i] = threadCreate("rwlock worker", worker);
+
+  // Error paths while the objects are in use: the workers cannot
+  // leave the barrier before the main thread reaches it
+  while (arrived == 0)
+    Yield();
+  check(BarrierDestroy(barrier) < 0, "BarrierDestroy of a busy barrier");
+  RWLockRead(rwlock);
+  check(RWLockDestroy(rwlock) < 0, "RWLockDestroy of a held lock");
+  RWLockRelease(rwlock);
+
+  for (i = 0; i < NUM_PHASES; i++)
+    if (BarrierWait(barrier) == BARRIER_SERIAL)
+      serials++;
+  for (i = 0; i < NUM_THREADS; i++)
+    Join(tids[i]);
+  check(serials == NUM_PHASES, "one BARRIER_SERIAL per phase");
+  check(RWLockRelease(rwlock) < 0, "RWLockRelease of a free lock");
+
+  check(BarrierCreate("empty", 0) == -1, "BarrierCreate of no thread");
+  check(RWLockDestroy(rwlock) == 0, "RWLockDestroy");
+  check(BarrierDestroy(barrier) == 0, "BarrierDestroy");
+  check(RWLockRead(rwlock) < 0, "RWLockRead of a destroyed lock");
+
+  n_printf("rwlock: %d errors\n", errors);
+  Exit(errors);
+  return 0;
+}
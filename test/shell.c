@@ -20,6 +20,65 @@
 // Nachos system calls
 #include "userlib/libnachos.h"
 
+// Maximum number of commands of a pipeline
+#define MAX_PIPELINE 4
+
+// Return 1 if the command line is a pipeline
+static int
+is_pipeline(char *line)
+{
+    while (*line != '\0')
+	if (*line++ == '|') return 1;
+    return 0;
+}
+
+// Run the commands of a pipeline "a | b | ...", each one reading the
+// output of the previous one through a pipe, and wait for them unless
+// bg is set
+static void
+run_pipeline(char *line, int bg)
+{
+    char *cmds[MAX_PIPELINE];
+    ThreadId procs[MAX_PIPELINE];
+    OpenFileId ends[2];
+    OpenFileId in, out;
+    int n = 0, k;
+    char *p = line;
+
+    // Split the line at each '|', removing the spaces around commands
+    while (n < MAX_PIPELINE) {
+	while (*p == ' ') p++;
+	cmds[n++] = p;
+	while (*p != '\0' && *p != '|') p++;
+	k = p - cmds[n-1];
+	while (k > 0 && cmds[n-1][k-1] == ' ') k--;
+	if (*p == '\0') { cmds[n-1][k] = '\0'; break; }
+	cmds[n-1][k] = '\0';
+	p++;
+    }
+
+    in = CONSOLE_INPUT;
+    for (k = 0; k < n; k++) {
+	out = CONSOLE_OUTPUT;
+	if (k < n - 1 && PipeCreate(ends) == 0)
+	    out = ends[1];
+	// The command inherits the redirections
+	Redirect(in, out);
+	procs[k] = Exec(cmds[k]);
+	if (procs[k] == -1)
+	    n_printf("\nUnable to run %s\n", cmds[k]);
+	// Only the commands use the pipes now
+	if (in != CONSOLE_INPUT) Close(in);
+	if (out != CONSOLE_OUTPUT) Close(out);
+	in = (out != CONSOLE_OUTPUT) ? ends[0] : CONSOLE_INPUT;
+    }
+    Redirect(CONSOLE_INPUT, CONSOLE_OUTPUT);
+
+    if (!bg)
+	for (k = 0; k < n; k++)
+	    if (procs[k] != -1) Join(procs[k]);
+}
+
 int
 main()
 {
@@ -69,7 +128,10 @@ main()
 	    
 	// Execute the command
 	// In the case it is a background command, don't wait for its completion
-	if( i > 0 ) {
+	if( i > 0 && is_pipeline(buffer) ) {
+	  run_pipeline(buffer, bg);
+	}
+	else if( i > 0 ) {
 	  newProc = Exec(buffer);
 	  if (newProc == -1) {
 	    n_printf("\nUnable to run %s\n", buffer);
@@ -0,0 +1,109 @@
+/* shm.c
+ *	Test program for shared memory segments.
+ *
+ *	The program runs itself a second time: both processes attach
+ *	the same segment and increment a counter in it under a
+ *	libnachos mutex also placed in the segment, so that they block
+ *	on each other through futexes of the shared pages.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+ */
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+#define NUM_ITER 20
+
+// Content of the segment
+typedef struct {
+  int started;        // set by the first process
+  n_mutex_t mutex;
+  n_sem_t done;       // V by the second process at its end
+  int counter;
+} Shared;
+
+int errors;
+
+// Report a failed check
+static void
+check(int ok, char *what)
+{
+  if (!ok) {
+    n_printf("shm: %s failed\n", what);
+    errors++;
+  }
+}
+
+// Increment the shared counter, yielding in the critical section
+static void
+increment(Shared *s)
+{
+  int i, value;
+
+  for (i = 0; i < NUM_ITER; i++) {
+    n_mutex_lock(&s->mutex);
+    value = s->counter;
+    Yield();
+    s->counter = value + 1;
+    n_mutex_unlock(&s->mutex);
+  }
+}
+
+int
+main()
+{
+  ShmId seg = ShmCreate("test", sizeof(Shared));
+  Shared *s = (Shared *)ShmAttach(seg);
+  ThreadId peer;
+
+  if (s == 0) {
+    n_printf("shm: ShmAttach failed\n");
+    Exit(1);
+  }
+
+  // Second process
+  if (s->started) {
+    increment(s);
+    n_sem_V(&s->done);
+    ShmDetach(s);
+    ShmDestroy(seg);
+    Exit(0);
+  }
+
+  n_mutex_init(&s->mutex);
+  n_sem_init(&s->done, 0);
+  s->started = 1;
+  peer = Exec("/shm");
+  check(peer != -1, "Exec");
+  increment(s);
+  n_sem_P(&s->done);
+  Join(peer);
+  check(s->counter == 2 * NUM_ITER, "mutual exclusion across processes");
+
+  // Error paths: larger existing segment, bad identifier, bad address
+  check(ShmCreate("test", 2 * sizeof(Shared)) == -1, "ShmCreate of a larger segment");
+  check(ShmAttach(-1) == 0, "ShmAttach of a bad identifier");
+  check(ShmDetach((char *)s + 1) < 0, "ShmDetach of a bad address");
+
+  // The segment stays mapped once destroyed
+  check(ShmDestroy(seg) == 0, "ShmDestroy");
+  check(s->counter == 2 * NUM_ITER, "segment mapped after ShmDestroy");
+  check(ShmDetach(s) == 0, "ShmDetach");
+
+  n_printf("shm: %d errors\n", errors);
+  Exit(errors);
+  return 0;
+}
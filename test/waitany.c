@@ -0,0 +1,102 @@
+/* waitany.c
+ *	Test program for WaitAny.
+ *
+ *	The main thread waits for semaphores signalled by another thread,
+ *	for the end of a thread and for data in a pipe, each time among
+ *	objects that stay not ready.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+ */
+
+// Nachos system calls
+#include "userlib/syscall.h"
+#include "userlib/libnachos.h"
+
+SemId idle, signalled;
+int errors;
+
+// Report a failed check
+static void
+check(int ok, char *what)
+{
+  if (!ok) {
+    n_printf("waitany: %s failed\n", what);
+    errors++;
+  }
+}
+
+// Signal the semaphore once the main thread is blocked
+static void
+signaller()
+{
+  Yield();
+  V(signalled);
+}
+
+static void
+quick()
+{
+}
+
+int
+main()
+{
+  unsigned long ids[WAIT_ANY_MAX + 1];
+  OpenFileId ends[2];
+  RWLockId rwlock;
+  int i;
+
+  idle = SemCreate("idle", 0);
+  signalled = SemCreate("signalled", 0);
+
+  // Semaphore V'd while blocked
+  threadCreate("signaller", signaller);
+  ids[0] = idle;
+  ids[1] = signalled;
+  check(WaitAny(ids, 2) == 1, "WaitAny of a semaphore");
+
+  // End of a thread
+  ids[1] = threadCreate("quick", quick);
+  check(WaitAny(ids, 2) == 1, "WaitAny of a thread");
+
+  // Data in a pipe
+  PipeCreate(ends);
+  Write("x", 1, ends[1]);
+  ids[1] = ends[0];
+  check(WaitAny(ids, 2) == 1, "WaitAny of a pipe");
+
+  // The P is done by WaitAny: the semaphore is not ready afterwards
+  V(idle);
+  check(WaitAny(ids, 1) == 0, "WaitAny of a ready semaphore");
+  check(WaitAny(ids, 2) == 1, "P done by WaitAny");
+
+  // Error paths: no object, too many objects, object not waitable
+  check(WaitAny(ids, 0) < 0, "WaitAny of no object");
+  for (i = 0; i <= WAIT_ANY_MAX; i++)
+    ids[i] = idle;
+  check(WaitAny(ids, WAIT_ANY_MAX + 1) < 0, "WaitAny of too many objects");
+  rwlock = RWLockCreate("not waitable", 0);
+  ids[1] = rwlock;
+  check(WaitAny(ids, 2) < 0, "WaitAny of a reader-writer lock");
+
+  RWLockDestroy(rwlock);
+  Close(ends[0]);
+  Close(ends[1]);
+  SemDestroy(idle);
+  SemDestroy(signalled);
+  n_printf("waitany: %d errors\n", errors);
+  Exit(errors);
+  return 0;
+}
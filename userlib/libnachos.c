@@ -67,6 +67,530 @@ ThreadId threadCreate(char *debug_name, VoidNoArgFunctionPtr func)
     return newThread(debug_name, (uint64_t)threadStart,(uint64_t)func);
 }
 
+//----------------------------------------------------------------------
+// Green threads
+//
+// Ready green threads are kept in a FIFO run queue shared by the
+// workers. A worker runs a green thread by switching from its own
+// context to the one of the green thread (n_gt_switch, see sys.s),
+// and gets the control back when the green thread yields or
+// finishes. The green thread is put back on the run queue by the
+// worker, once its context has been saved: another worker cannot
+// resume it before.
+//
+// The register tp of each worker points to its descriptor.
+//----------------------------------------------------------------------
+
+#define GT_READY   0
+#define GT_RUNNING 1
+#define GT_DONE    2
+
+typedef struct {
+  unsigned long ctx[N_GTHREAD_CTX_SIZE]; // context of the worker loop
+  n_gthread_t *current;                  // green thread being run
+} gthread_worker_t;
+
+// Save the callee-saved registers in from, restore those of to
+extern void n_gt_switch(unsigned long *from, unsigned long *to);
+
+static n_mutex_t gt_lock;          // protects the fields below
+static n_cond_t gt_cond;           // signalled when work is available
+static n_gthread_t *gt_head, *gt_tail;
+static int gt_live;                // number of unfinished green threads
+static gthread_worker_t gt_workers[N_GTHREAD_MAX_WORKERS];
+static int gt_next_worker;
+
+static gthread_worker_t *gthread_worker_self(void)
+{
+  gthread_worker_t *w;
+  __asm__ volatile ("mv %0, tp" : "=r" (w));
+  return w;
+}
+
+// Append a green thread to the run queue (gt_lock held)
+static void gthread_enqueue(n_gthread_t *t)
+{
+  t->next = 0;
+  if (gt_tail) gt_tail->next = t; else gt_head = t;
+  gt_tail = t;
+  n_cond_signal(&gt_cond);
+}
+
+//----------------------------------------------------------------------
+// gthread_trampoline()
+/*!	First function executed by a green thread, on its own stack:
+//      calls its function, then gives the worker back for good.
+//      The state is left to GT_RUNNING: the worker marks the thread
+//      done once it is off its stack, which a joiner may then free.
+*/
+//----------------------------------------------------------------------
+static void gthread_trampoline(void)
+{
+  n_gthread_t *t = gthread_worker_self()->current;
+  t->func(t->arg);
+  // The green thread may have moved to another worker meanwhile
+  gthread_worker_t *w = gthread_worker_self();
+  n_gt_switch(t->ctx, w->ctx);
+}
+
+//----------------------------------------------------------------------
+// gthread_worker_loop()
+/*!	Run ready green threads until they have all finished
+//
+//	\param w is the descriptor of the calling worker
+*/
+//----------------------------------------------------------------------
+static void gthread_worker_loop(gthread_worker_t *w)
+{
+  __asm__ volatile ("mv tp, %0" : : "r" (w));
+  w->current = 0;
+
+  n_mutex_lock(&gt_lock);
+  for (;;) {
+    while (gt_head == 0 && gt_live > 0)
+      n_cond_wait(&gt_cond, &gt_lock);
+    if (gt_head == 0)
+      break;
+    n_gthread_t *t = gt_head;
+    gt_head = t->next;
+    if (gt_head == 0) gt_tail = 0;
+    n_mutex_unlock(&gt_lock);
+
+    w->current = t;
+    t->state = GT_RUNNING;
+    n_gt_switch(w->ctx, t->ctx);
+    w->current = 0;
+
+    n_mutex_lock(&gt_lock);
+    if (t->state == GT_READY)
+      gthread_enqueue(t);
+    else {
+      // Finished, and no longer running on its stack
+      __atomic_store_n(&t->state, GT_DONE, __ATOMIC_RELEASE);
+      if (--gt_live == 0)
+	n_cond_broadcast(&gt_cond);
+    }
+  }
+  n_mutex_unlock(&gt_lock);
+
+  __asm__ volatile ("mv tp, zero");
+}
+
+// Entry point of the additional workers
+static void gthread_worker(void)
+{
+  int i = __atomic_fetch_add(&gt_next_worker, 1, __ATOMIC_SEQ_CST);
+  gthread_worker_loop(&gt_workers[i]);
+}
+
+//----------------------------------------------------------------------
+// n_gthread_create()
+/*!	Create a green thread, ready to run.
+//
+//	\param t is the descriptor of the green thread, which must
+//             remain valid until it has finished
+//	\param stack is the stack of the green thread
+//	\param stack_size is the size of the stack in bytes
+//	\param func is the function executed by the green thread
+//	\param arg is the argument passed to func
+*/
+//----------------------------------------------------------------------
+void n_gthread_create(n_gthread_t *t, char *stack, int stack_size,
+		      n_gthread_func_t func, void *arg)
+{
+  int i;
+  for (i = 0; i < N_GTHREAD_CTX_SIZE; i++)
+    t->ctx[i] = 0;
+  t->ctx[0] = (unsigned long)gthread_trampoline;                // ra
+  t->ctx[1] = ((unsigned long)(stack + stack_size)) & ~15UL;    // sp
+  t->func = func;
+  t->arg = arg;
+  t->state = GT_READY;
+
+  n_mutex_lock(&gt_lock);
+  gt_live++;
+  gthread_enqueue(t);
+  n_mutex_unlock(&gt_lock);
+}
+
+//----------------------------------------------------------------------
+// n_gthread_yield()
+/*!	Let the worker run another green thread. The calling green
+//      thread is put at the end of the run queue.
+*/
+//----------------------------------------------------------------------
+void n_gthread_yield(void)
+{
+  gthread_worker_t *w = gthread_worker_self();
+  if (w == 0 || w->current == 0) {
+    Yield();
+    return;
+  }
+  n_gthread_t *t = w->current;
+  t->state = GT_READY;
+  n_gt_switch(t->ctx, w->ctx);
+}
+
+//----------------------------------------------------------------------
+// n_gthread_join()
+/*!	Wait until a green thread has finished, yielding meanwhile
+//
+//	\param t is the green thread to wait for
+*/
+//----------------------------------------------------------------------
+void n_gthread_join(n_gthread_t *t)
+{
+  while (__atomic_load_n(&t->state, __ATOMIC_ACQUIRE) != GT_DONE)
+    n_gthread_yield();
+}
+
+//----------------------------------------------------------------------
+// n_gthread_self()
+/*!	Return the calling green thread, NULL outside a green thread
+*/
+//----------------------------------------------------------------------
+n_gthread_t *n_gthread_self(void)
+{
+  gthread_worker_t *w = gthread_worker_self();
+  return (w == 0) ? 0 : w->current;
+}
+
+//----------------------------------------------------------------------
+// n_gthread_run()
+/*!	Run the green threads until they have all finished. nworkers-1
+//      kernel threads are created, the calling thread being the
+//      last worker.
+//
+//	\param nworkers is the number of kernel threads running green
+//             threads (at most N_GTHREAD_MAX_WORKERS)
+*/
+//----------------------------------------------------------------------
+void n_gthread_run(int nworkers)
+{
+  ThreadId tids[N_GTHREAD_MAX_WORKERS];
+  int i;
+
+  if (nworkers < 1) nworkers = 1;
+  if (nworkers > N_GTHREAD_MAX_WORKERS) nworkers = N_GTHREAD_MAX_WORKERS;
+
+  gt_next_worker = 1;
+  for (i = 1; i < nworkers; i++)
+    tids[i] = threadCreate("gthread worker", gthread_worker);
+  gthread_worker_loop(&gt_workers[0]);
+  for (i = 1; i < nworkers; i++)
+    Join(tids[i]);
+}
+
+//----------------------------------------------------------------------
+// n_mutex_init()
+/*!	Initialize a user-space mutex (free)
+//
+//	\param m is the mutex
+*/
+//----------------------------------------------------------------------
+void n_mutex_init(n_mutex_t *m)
+{
+  m->state = 0;
+}
+
+//----------------------------------------------------------------------
+// n_mutex_lock()
+/*!	Acquire a mutex. The kernel is only called when the mutex is
+//      already locked: the state is then set to 2 so that the owner
+//      knows it has to wake a waiter up when releasing it.
+//
+//	\param m is the mutex
+*/
+//----------------------------------------------------------------------
+void n_mutex_lock(n_mutex_t *m)
+{
+  int c = 0;
+
+  // Fast path: the mutex is free
+  if (__atomic_compare_exchange_n(&m->state, &c, 1, 0,
+				  __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    return;
+
+  // Slow path: mark the mutex as contended and sleep until released
+  if (c != 2)
+    c = __atomic_exchange_n(&m->state, 2, __ATOMIC_ACQUIRE);
+  while (c != 0) {
+    FutexWait((int *)&m->state, 2);
+    c = __atomic_exchange_n(&m->state, 2, __ATOMIC_ACQUIRE);
+  }
+}
+
+//----------------------------------------------------------------------
+// n_mutex_trylock()
+/*!	Acquire a mutex if it is free, never blocks
+//
+//	\param m is the mutex
+//	\return 0 if the mutex has been acquired, -1 otherwise
+*/
+//----------------------------------------------------------------------
+int n_mutex_trylock(n_mutex_t *m)
+{
+  int c = 0;
+  if (__atomic_compare_exchange_n(&m->state, &c, 1, 0,
+				  __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    return 0;
+  return -1;
+}
+
+//----------------------------------------------------------------------
+// n_mutex_unlock()
+/*!	Release a mutex, waking up one waiter if the mutex is contended
+//
+//	\param m is the mutex
+*/
+//----------------------------------------------------------------------
+void n_mutex_unlock(n_mutex_t *m)
+{
+  if (__atomic_fetch_sub(&m->state, 1, __ATOMIC_RELEASE) != 1) {
+    __atomic_store_n(&m->state, 0, __ATOMIC_RELEASE);
+    FutexWake((int *)&m->state, 1);
+  }
+}
+
+//----------------------------------------------------------------------
+// n_sem_init()
+/*!	Initialize a user-space semaphore
+//
+//	\param s is the semaphore
+//	\param count is its initial value (>= 0)
+*/
+//----------------------------------------------------------------------
+void n_sem_init(n_sem_t *s, int count)
+{
+  s->count = count;
+  s->waiters = 0;
+}
+
+//----------------------------------------------------------------------
+// n_sem_P()
+/*!	Wait until the semaphore counter is positive, and decrement it.
+//      The counter never becomes negative: threads sleep on the
+//      counter while it is zero.
+//
+//	\param s is the semaphore
+*/
+//----------------------------------------------------------------------
+void n_sem_P(n_sem_t *s)
+{
+  for (;;) {
+    int v = __atomic_load_n(&s->count, __ATOMIC_SEQ_CST);
+    while (v > 0) {
+      if (__atomic_compare_exchange_n(&s->count, &v, v - 1, 0,
+				      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+	return;
+    }
+    __atomic_fetch_add(&s->waiters, 1, __ATOMIC_SEQ_CST);
+    FutexWait((int *)&s->count, 0);
+    __atomic_fetch_sub(&s->waiters, 1, __ATOMIC_SEQ_CST);
+  }
+}
+
+//----------------------------------------------------------------------
+// n_sem_V()
+/*!	Increment the semaphore counter, waking up a waiter if any
+//
+//	\param s is the semaphore
+*/
+//----------------------------------------------------------------------
+void n_sem_V(n_sem_t *s)
+{
+  __atomic_fetch_add(&s->count, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&s->waiters, __ATOMIC_SEQ_CST) > 0)
+    FutexWake((int *)&s->count, 1);
+}
+
+//----------------------------------------------------------------------
+// n_cond_init()
+/*!	Initialize a user-space condition variable
+//
+//	\param c is the condition variable
+*/
+//----------------------------------------------------------------------
+void n_cond_init(n_cond_t *c)
+{
+  c->seq = 0;
+  c->waiters = 0;
+}
+
+//----------------------------------------------------------------------
+// n_cond_wait()
+/*!	Release a mutex and wait for the condition to be signalled,
+//      then acquire the mutex again. A signal sent between the
+//      release of the mutex and the call to the kernel is not lost,
+//      since it changes the sequence number the thread waits on.
+//
+//	\param c is the condition variable
+//	\param m is the mutex, held by the caller
+*/
+//----------------------------------------------------------------------
+void n_cond_wait(n_cond_t *c, n_mutex_t *m)
+{
+  int seq = __atomic_load_n(&c->seq, __ATOMIC_SEQ_CST);
+  __atomic_fetch_add(&c->waiters, 1, __ATOMIC_SEQ_CST);
+  n_mutex_unlock(m);
+  FutexWait((int *)&c->seq, seq);
+  __atomic_fetch_sub(&c->waiters, 1, __ATOMIC_SEQ_CST);
+
+  // Other threads may have been woken up at the same time:
+  // acquire the mutex in the contended state
+  while (__atomic_exchange_n(&m->state, 2, __ATOMIC_ACQUIRE) != 0)
+    FutexWait((int *)&m->state, 2);
+}
+
+//----------------------------------------------------------------------
+// n_cond_signal()
+/*!	Wake up one thread waiting on the condition, if any
+//
+//	\param c is the condition variable
+*/
+//----------------------------------------------------------------------
+void n_cond_signal(n_cond_t *c)
+{
+  __atomic_fetch_add(&c->seq, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&c->waiters, __ATOMIC_SEQ_CST) > 0)
+    FutexWake((int *)&c->seq, 1);
+}
+
+//----------------------------------------------------------------------
+// n_cond_broadcast()
+/*!	Wake up all the threads waiting on the condition
+//
+//	\param c is the condition variable
+*/
+//----------------------------------------------------------------------
+void n_cond_broadcast(n_cond_t *c)
+{
+  __atomic_fetch_add(&c->seq, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&c->waiters, __ATOMIC_SEQ_CST) > 0)
+    FutexWake((int *)&c->seq, 0x7fffffff);
+}
+
+//----------------------------------------------------------------------
+// n_info_page()
+/*!	Return the information page of the process, asking the kernel
+//	for its address on the first call only.
+*/
+//----------------------------------------------------------------------
+Nachos_InfoPage *n_info_page(void)
+{
+  static Nachos_InfoPage *page = 0;
+  if (page == 0)
+    page = InfoPage();
+  return page;
+}
+
+//----------------------------------------------------------------------
+// n_info_snapshot()
+/*!	Copy the information page. The copy is retried when the kernel
+//	has updated the counters meanwhile (seq changed), so that they
+//	all come from the same update.
+//
+//	\param info where to copy the page
+*/
+//----------------------------------------------------------------------
+void n_info_snapshot(Nachos_InfoPage *info)
+{
+  Nachos_InfoPage *page = n_info_page();
+  unsigned long long seq;
+
+  do {
+    seq = page->seq;
+    info->ticks = page->ticks;
+    info->frequency = page->frequency;
+    info->numInstructions = page->numInstructions;
+    info->userTicks = page->userTicks;
+    info->systemTicks = page->systemTicks;
+    info->numPageFaults = page->numPageFaults;
+    info->tid = page->tid;
+  } while (page->seq != seq);
+  info->seq = seq;
+}
+
+//----------------------------------------------------------------------
+// n_systime()
+/*!	Get the time spent running Nachos, as SysTime does, from the
+//	clock of the information page.
+//
+//	\param t where to store the time
+*/
+//----------------------------------------------------------------------
+void n_systime(Nachos_Time *t)
+{
+  Nachos_InfoPage *page = n_info_page();
+  unsigned long long ticks = page->ticks;
+  unsigned long long freq = page->frequency;
+
+  t->seconds = (long)((ticks / freq) / 1000000);
+  t->nanos = (long)((1000 * ticks / freq) % 1000000000);
+}
+
+//----------------------------------------------------------------------
+// n_rdcycle()
+/*!	\return the number of cycles executed by the calling thread
+*/
+//----------------------------------------------------------------------
+unsigned long n_rdcycle(void)
+{
+  unsigned long v;
+  asm volatile ("rdcycle %0" : "=r" (v));
+  return v;
+}
+
+//----------------------------------------------------------------------
+// n_rdtime()
+/*!	\return the number of cycles since Nachos started
+*/
+//----------------------------------------------------------------------
+unsigned long n_rdtime(void)
+{
+  unsigned long v;
+  asm volatile ("rdtime %0" : "=r" (v));
+  return v;
+}
+
+//----------------------------------------------------------------------
+// n_rdinstret()
+/*!	\return the number of instructions executed by the calling thread
+*/
+//----------------------------------------------------------------------
+unsigned long n_rdinstret(void)
+{
+  unsigned long v;
+  asm volatile ("rdinstret %0" : "=r" (v));
+  return v;
+}
+
+//! A case of n_rdhpmcounter (the CSR number must be a constant)
+#define RDHPM(n) \
+  case n: asm volatile ("csrr %0, hpmcounter" #n : "=r" (v)); break;
+
+//----------------------------------------------------------------------
+// n_rdhpmcounter()
+/*!	Read a hardware performance counter
+//
+//	\param n number of the counter, between 3 and 31
+//	\return the value of hpmcounter<n> for the calling thread, 0 if
+//	  n is out of range
+*/
+//----------------------------------------------------------------------
+unsigned long n_rdhpmcounter(int n)
+{
+  unsigned long v = 0;
+  switch (n) {
+    RDHPM(3) RDHPM(4) RDHPM(5) RDHPM(6) RDHPM(7) RDHPM(8) RDHPM(9)
+    RDHPM(10) RDHPM(11) RDHPM(12) RDHPM(13) RDHPM(14) RDHPM(15)
+    RDHPM(16) RDHPM(17) RDHPM(18) RDHPM(19) RDHPM(20) RDHPM(21)
+    RDHPM(22) RDHPM(23) RDHPM(24) RDHPM(25) RDHPM(26) RDHPM(27)
+    RDHPM(28) RDHPM(29) RDHPM(30) RDHPM(31)
+  }
+  return v;
+}
+
 //----------------------------------------------------------------------
 // n_strcmp()
 /*!	String comparison
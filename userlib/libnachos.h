@@ -36,6 +36,109 @@ typedef unsigned int size_t;
 // ----------------------------
 ThreadId threadCreate(char * debug_name, VoidNoArgFunctionPtr func);
 
+// Green threads :
+// ---------------
+// Lightweight threads scheduled by libnachos on a few kernel threads
+// (the workers). Creating, switching and terminating a green thread
+// never calls the kernel. Green threads are scheduled cooperatively:
+// a green thread runs until it finishes or calls n_gthread_yield.
+// The caller provides the memory of each green thread (descriptor
+// and stack), so that thousands of them can be created.
+
+#define N_GTHREAD_MAX_WORKERS 8
+#define N_GTHREAD_CTX_SIZE 26     // ra, sp, s0-s11, fs0-fs11
+
+typedef void (*n_gthread_func_t)(void *arg);
+
+typedef struct n_gthread {
+  unsigned long ctx[N_GTHREAD_CTX_SIZE]; // saved registers
+  n_gthread_func_t func;
+  void *arg;
+  volatile int state;
+  struct n_gthread *next;               // run queue link
+} n_gthread_t;
+
+// Prepare t to execute func(arg) on the stack [stack, stack+stack_size[,
+// may be called before n_gthread_run or by a green thread
+void n_gthread_create(n_gthread_t *t, char *stack, int stack_size,
+		      n_gthread_func_t func, void *arg);
+// Give the worker to another ready green thread (Yield when called
+// outside a green thread)
+void n_gthread_yield(void);
+// Wait until the green thread t has finished
+void n_gthread_join(n_gthread_t *t);
+// Return the calling green thread (NULL outside a green thread)
+n_gthread_t *n_gthread_self(void);
+// Run the green threads on nworkers kernel threads, the calling one
+// included, and return once they have all finished
+void n_gthread_run(int nworkers);
+
+// Synchronization in user space :
+// --------------------------------
+// These tools only call the kernel (FutexWait/FutexWake) when a
+// thread has to block or to wake another thread up.
+
+// Mutex: 0 = free, 1 = locked, 2 = locked with possible waiters
+typedef struct {
+  volatile int state;
+} n_mutex_t;
+
+// Semaphore
+typedef struct {
+  volatile int count;
+  volatile int waiters;
+} n_sem_t;
+
+// Condition variable
+typedef struct {
+  volatile int seq;
+  volatile int waiters;
+} n_cond_t;
+
+void n_mutex_init(n_mutex_t *m);
+void n_mutex_lock(n_mutex_t *m);
+// Return 0 if the mutex was acquired, -1 if it is already locked
+int n_mutex_trylock(n_mutex_t *m);
+void n_mutex_unlock(n_mutex_t *m);
+
+void n_sem_init(n_sem_t *s, int count);
+void n_sem_P(n_sem_t *s);
+void n_sem_V(n_sem_t *s);
+
+void n_cond_init(n_cond_t *c);
+// Release m, wait for a signal and acquire m again
+void n_cond_wait(n_cond_t *c, n_mutex_t *m);
+void n_cond_signal(n_cond_t *c);
+void n_cond_broadcast(n_cond_t *c);
+
+// System information :
+// --------------------
+// Read from the information page published by the kernel (see
+// Nachos_InfoPage in syscall.h), without any system call once the
+// address of the page is known.
+
+// Return the information page of the process
+Nachos_InfoPage *n_info_page(void);
+// Copy a consistent snapshot of the information page into info
+void n_info_snapshot(Nachos_InfoPage *info);
+// Same as SysTime, without a system call
+void n_systime(Nachos_Time *t);
+
+// Performance counters :
+// ----------------------
+// Read the counter CSRs of the calling thread, without any system
+// call: cycles and instructions executed by the thread, cycles since
+// Nachos started, and the events selected by the HpmCounterN
+// entries of the configuration file (3 <= n <= 31, by default
+// memory accesses, page faults, system calls and context switches
+// for 3 to 6).
+
+unsigned long n_rdcycle(void);
+unsigned long n_rdtime(void);
+unsigned long n_rdinstret(void);
+// Return 0 if n is not between 3 and 31
+unsigned long n_rdhpmcounter(int n);
+
 // Input/Output operations :
 // ------------------------------------
 
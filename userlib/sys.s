@@ -340,4 +340,320 @@ Debug:
 	ecall
 	jr ra
 
+	.globl FutexWait
+	.type	__FutexWait, @function
+FutexWait:	
+	addi a7,zero,SC_FUTEX_WAIT
+	ecall
+	jr ra
+
+	.globl FutexWake
+	.type	__FutexWake, @function
+FutexWake:	
+	addi a7,zero,SC_FUTEX_WAKE
+	ecall
+	jr ra
+
 	
+
+	.globl GetSchedStat
+	.type	__GetSchedStat, @function
+GetSchedStat:	
+	addi a7,zero,SC_SCHED_STAT
+	ecall
+	jr ra
+
+	.globl RingSetup
+	.type	__RingSetup, @function
+RingSetup:	
+	addi a7,zero,SC_RING_SETUP
+	ecall
+	jr ra
+
+	.globl RingEnter
+	.type	__RingEnter, @function
+RingEnter:	
+	addi a7,zero,SC_RING_ENTER
+	ecall
+	jr ra
+
+	.globl InfoPage
+	.type	__InfoPage, @function
+InfoPage:	
+	addi a7,zero,SC_INFO_PAGE
+	ecall
+	jr ra
+
+/* -------------------------------------------------------------
+ * n_gt_switch(from, to)
+ *	Context switch between green threads (see libnachos.c): save
+ *	the callee-saved registers into from, restore them from to,
+ *	and return to the return address saved in to.
+ * -------------------------------------------------------------
+ */
+	.globl n_gt_switch
+	.type	__n_gt_switch, @function
+n_gt_switch:
+	sd ra,0(a0)
+	sd sp,8(a0)
+	sd s0,16(a0)
+	sd s1,24(a0)
+	sd s2,32(a0)
+	sd s3,40(a0)
+	sd s4,48(a0)
+	sd s5,56(a0)
+	sd s6,64(a0)
+	sd s7,72(a0)
+	sd s8,80(a0)
+	sd s9,88(a0)
+	sd s10,96(a0)
+	sd s11,104(a0)
+	fsd fs0,112(a0)
+	fsd fs1,120(a0)
+	fsd fs2,128(a0)
+	fsd fs3,136(a0)
+	fsd fs4,144(a0)
+	fsd fs5,152(a0)
+	fsd fs6,160(a0)
+	fsd fs7,168(a0)
+	fsd fs8,176(a0)
+	fsd fs9,184(a0)
+	fsd fs10,192(a0)
+	fsd fs11,200(a0)
+	ld ra,0(a1)
+	ld sp,8(a1)
+	ld s0,16(a1)
+	ld s1,24(a1)
+	ld s2,32(a1)
+	ld s3,40(a1)
+	ld s4,48(a1)
+	ld s5,56(a1)
+	ld s6,64(a1)
+	ld s7,72(a1)
+	ld s8,80(a1)
+	ld s9,88(a1)
+	ld s10,96(a1)
+	ld s11,104(a1)
+	fld fs0,112(a1)
+	fld fs1,120(a1)
+	fld fs2,128(a1)
+	fld fs3,136(a1)
+	fld fs4,144(a1)
+	fld fs5,152(a1)
+	fld fs6,160(a1)
+	fld fs7,168(a1)
+	fld fs8,176(a1)
+	fld fs9,184(a1)
+	fld fs10,192(a1)
+	fld fs11,200(a1)
+	jr ra
+
+	.globl AioRead
+	.type	__AioRead, @function
+AioRead:	
+	addi a7,zero,SC_AIO_READ
+	ecall
+	jr ra
+
+	.globl AioWrite
+	.type	__AioWrite, @function
+AioWrite:	
+	addi a7,zero,SC_AIO_WRITE
+	ecall
+	jr ra
+
+	.globl AioWait
+	.type	__AioWait, @function
+AioWait:	
+	addi a7,zero,SC_AIO_WAIT
+	ecall
+	jr ra
+
+	.globl AioPoll
+	.type	__AioPoll, @function
+AioPoll:	
+	addi a7,zero,SC_AIO_POLL
+	ecall
+	jr ra
+
+	.globl Readv
+	.type	__Readv, @function
+Readv:	
+	addi a7,zero,SC_READV
+	ecall
+	jr ra
+
+	.globl Writev
+	.type	__Writev, @function
+Writev:	
+	addi a7,zero,SC_WRITEV
+	ecall
+	jr ra
+
+	.globl Sleep
+	.type	__Sleep, @function
+Sleep:	
+	addi a7,zero,SC_SLEEP
+	ecall
+	jr ra
+
+	.globl TimedP
+	.type	__TimedP, @function
+TimedP:	
+	addi a7,zero,SC_TIMED_P
+	ecall
+	jr ra
+
+	.globl PipeCreate
+	.type	__PipeCreate, @function
+PipeCreate:	
+	addi a7,zero,SC_PIPE_CREATE
+	ecall
+	jr ra
+
+	.globl Redirect
+	.type	__Redirect, @function
+Redirect:	
+	addi a7,zero,SC_REDIRECT
+	ecall
+	jr ra
+
+	.globl PortCreate
+	.type	__PortCreate, @function
+PortCreate:	
+	addi a7,zero,SC_PORT_CREATE
+	ecall
+	jr ra
+
+	.globl PortDestroy
+	.type	__PortDestroy, @function
+PortDestroy:	
+	addi a7,zero,SC_PORT_DESTROY
+	ecall
+	jr ra
+
+	.globl PortSend
+	.type	__PortSend, @function
+PortSend:	
+	addi a7,zero,SC_PORT_SEND
+	ecall
+	jr ra
+
+	.globl PortReceive
+	.type	__PortReceive, @function
+PortReceive:	
+	addi a7,zero,SC_PORT_RECEIVE
+	ecall
+	jr ra
+
+	.globl ShmCreate
+	.type	__ShmCreate, @function
+ShmCreate:	
+	addi a7,zero,SC_SHM_CREATE
+	ecall
+	jr ra
+
+	.globl ShmDestroy
+	.type	__ShmDestroy, @function
+ShmDestroy:	
+	addi a7,zero,SC_SHM_DESTROY
+	ecall
+	jr ra
+
+	.globl ShmAttach
+	.type	__ShmAttach, @function
+ShmAttach:	
+	addi a7,zero,SC_SHM_ATTACH
+	ecall
+	jr ra
+
+	.globl ShmDetach
+	.type	__ShmDetach, @function
+ShmDetach:	
+	addi a7,zero,SC_SHM_DETACH
+	ecall
+	jr ra
+
+	.globl SetPriority
+	.type	__SetPriority, @function
+SetPriority:	
+	addi a7,zero,SC_SET_PRIORITY
+	ecall
+	jr ra
+
+	.globl RWLockCreate
+	.type	__RWLockCreate, @function
+RWLockCreate:	
+	addi a7,zero,SC_RWLOCK_CREATE
+	ecall
+	jr ra
+
+	.globl RWLockDestroy
+	.type	__RWLockDestroy, @function
+RWLockDestroy:	
+	addi a7,zero,SC_RWLOCK_DESTROY
+	ecall
+	jr ra
+
+	.globl RWLockRead
+	.type	__RWLockRead, @function
+RWLockRead:	
+	addi a7,zero,SC_RWLOCK_READ
+	ecall
+	jr ra
+
+	.globl RWLockWrite
+	.type	__RWLockWrite, @function
+RWLockWrite:	
+	addi a7,zero,SC_RWLOCK_WRITE
+	ecall
+	jr ra
+
+	.globl RWLockRelease
+	.type	__RWLockRelease, @function
+RWLockRelease:	
+	addi a7,zero,SC_RWLOCK_RELEASE
+	ecall
+	jr ra
+
+	.globl BarrierCreate
+	.type	__BarrierCreate, @function
+BarrierCreate:	
+	addi a7,zero,SC_BARRIER_CREATE
+	ecall
+	jr ra
+
+	.globl BarrierDestroy
+	.type	__BarrierDestroy, @function
+BarrierDestroy:	
+	addi a7,zero,SC_BARRIER_DESTROY
+	ecall
+	jr ra
+
+	.globl BarrierWait
+	.type	__BarrierWait, @function
+BarrierWait:	
+	addi a7,zero,SC_BARRIER_WAIT
+	ecall
+	jr ra
+
+	.globl WaitAny
+	.type	__WaitAny, @function
+WaitAny:	
+	addi a7,zero,SC_WAIT_ANY
+	ecall
+	jr ra
+
+	.globl RoiBegin
+	.type	__RoiBegin, @function
+RoiBegin:	
+	addi a7,zero,SC_ROI_BEGIN
+	ecall
+	jr ra
+
+	.globl RoiEnd
+	.type	__RoiEnd, @function
+RoiEnd:	
+	addi a7,zero,SC_ROI_END
+	ecall
+	jr ra
@@ -73,6 +73,45 @@
 #define SC_SYS_TIME	 32 
 #define SC_MMAP		 33
 #define SC_DEBUG         34
+#define SC_FUTEX_WAIT    35
+#define SC_FUTEX_WAKE    36
+#define SC_SCHED_STAT    37
+#define SC_RING_SETUP    38
+#define SC_RING_ENTER    39
+#define SC_INFO_PAGE     40
+#define SC_AIO_READ      41
+#define SC_AIO_WRITE     42
+#define SC_AIO_WAIT      43
+#define SC_AIO_POLL      44
+#define SC_READV         45
+#define SC_WRITEV        46
+#define SC_SLEEP         47
+#define SC_TIMED_P       48
+#define SC_PIPE_CREATE   49
+#define SC_REDIRECT      50
+#define SC_PORT_CREATE   51
+#define SC_PORT_DESTROY  52
+#define SC_PORT_SEND     53
+#define SC_PORT_RECEIVE  54
+#define SC_SHM_CREATE    55
+#define SC_SHM_DESTROY   56
+#define SC_SHM_ATTACH    57
+#define SC_SHM_DETACH    58
+#define SC_SET_PRIORITY  59
+#define SC_RWLOCK_CREATE  60
+#define SC_RWLOCK_DESTROY 61
+#define SC_RWLOCK_READ    62
+#define SC_RWLOCK_WRITE   63
+#define SC_RWLOCK_RELEASE 64
+#define SC_BARRIER_CREATE 65
+#define SC_BARRIER_DESTROY 66
+#define SC_BARRIER_WAIT   67
+#define SC_WAIT_ANY       68
+#define SC_ROI_BEGIN      69
+#define SC_ROI_END        70
+
+/* One more than the last system call number */
+#define NUM_SYSCALLS      71
 
 #ifndef IN_ASM
 
@@ -96,6 +135,32 @@ typedef struct {
 } Nachos_Time;
 void SysTime(Nachos_Time *t);
 
+/* Block the calling thread for the duration t (flags = 0), or until
+   the date t of the SysTime clock (flags = SLEEP_ABSOLUTE), without
+   using the CPU. */
+#define SLEEP_ABSOLUTE	1
+t_error Sleep(Nachos_Time *t, int flags);
+
+/*! \brief Information page, mapped read-only in every address space
+ * and kept up to date by the kernel: it can be read without any
+ * system call (see n_systime in libnachos.h). The time is updated at
+ * each tick; the other fields at each context switch and each
+ * system call or exception, seq being incremented then.
+ */
+typedef struct {
+  volatile unsigned long long seq;             /* update counter */
+  volatile unsigned long long ticks;           /* current time (cycles) */
+  volatile unsigned long long frequency;       /* processor frequency (MHz) */
+  volatile unsigned long long numInstructions; /* executed by the process */
+  volatile unsigned long long userTicks;       /* user time of the process */
+  volatile unsigned long long systemTicks;     /* system time of the process */
+  volatile unsigned long long numPageFaults;   /* page faults of the process */
+  volatile unsigned long long tid;             /* ThreadId of the running thread */
+} Nachos_InfoPage;
+
+/* Return the address of the information page of the process */
+Nachos_InfoPage *InfoPage();
+
 /* Address space control operations: Exit, Exec, and Join */
 
 /* This user program is done (status = 0 means exited normally). */
@@ -123,6 +188,44 @@ t_error Join(ThreadId id);
  */
 void Yield();		
 
+/*! \brief Scheduling statistics of a thread (times in cycles).
+ * readyLatency is a histogram of the times the thread waited on the
+ * ready list: bucket 0 counts waits below 256 cycles, bucket i waits
+ * in [2^(7+i), 2^(8+i)[, the last bucket all longer waits.
+ */
+#define SCHED_HIST_SIZE 16
+typedef struct {
+  unsigned long long readyLatency[SCHED_HIST_SIZE];
+  unsigned long long maxReadyLatency;
+  unsigned long long readyTicks;
+  unsigned long long runTicks;
+  unsigned long long blockedTicks;
+  unsigned long long numVoluntarySwitches;
+  unsigned long long numInvoluntarySwitches;
+  unsigned long long numPriorityBoosts;
+} Nachos_SchedStat;
+
+/* Copy the scheduling statistics of thread "id" (0 for the calling
+ * thread) into stat.
+ * Return a negative number if an error ocurred.
+ */
+t_error GetSchedStat(ThreadId id, Nachos_SchedStat *stat);
+
+/* Thread priorities: the ready threads of highest priority share the
+ * CPU, and the most urgent thread waiting for a lock, semaphore or
+ * condition is woken up first. A thread holding a lock inherits the
+ * priority of the threads waiting for it (numPriorityBoosts in
+ * Nachos_SchedStat counts these boosts).
+ */
+#define MIN_PRIORITY      0
+#define MAX_PRIORITY      31
+#define DEFAULT_PRIORITY  16
+
+/* Set the priority of thread "id" (0 for the calling thread).
+ * Return a negative number if an error ocurred.
+ */
+t_error SetPriority(ThreadId id, int priority);
+
 /*! Print the last error message with the personalized one "mess" */
 void PError(char *mess); 
 
@@ -165,14 +268,72 @@ t_error Write(char *buffer, int size, OpenFileId id);
  */
 t_error Read(char *buffer, int size, OpenFileId id);
 
+/* Vectored Read and Write: one buffer of "len" bytes at "base" per
+ * element of the array "iov", of "count" elements (at most
+ * NACHOS_IOV_MAX). The buffers are read or written in order, as a
+ * single contiguous area of the file: Writev(iov, 2, id) writes a
+ * header and a payload with one system call and one file write.
+ * Return the total number of bytes read or written.
+ */
+#define NACHOS_IOV_MAX	16
+
+typedef struct {
+  char *base;
+  int len;
+} Nachos_IoVec;
+
+t_error Readv(Nachos_IoVec *iov, int count, OpenFileId id);
+t_error Writev(Nachos_IoVec *iov, int count, OpenFileId id);
+
 /* Seek to a specified offset into an opened file */
 t_error Seek(int offset, OpenFileId id);
 
+/* Asynchronous I/O: AioRead and AioWrite queue a transfer of "size"
+ * bytes at position "offset" of the open file (not the console), and
+ * return at once an identifier of the transfer, done by the kernel
+ * while the program goes on. The buffer must not be used until the
+ * transfer has been collected by AioWait or AioPoll: the data read
+ * is copied into the buffer at that time.
+ */
+typedef unsigned long AioId;
+
+/* Returned by AioPoll while the transfer is not done */
+#define AIO_PENDING	-2
+
+AioId AioRead(char *buffer, int size, OpenFileId id, int offset);
+AioId AioWrite(char *buffer, int size, OpenFileId id, int offset);
+
+/* Wait for the end of a transfer, and return the number of bytes
+ * transferred. The identifier can no longer be used afterwards.
+ */
+int AioWait(AioId aio);
+
+/* Same as AioWait, but return AIO_PENDING at once if the transfer
+ * is not done yet.
+ */
+int AioPoll(AioId aio);
+
 #ifndef SYSDEP_H
 /* Close the file, we're done reading and writing to it. */
 t_error Close(OpenFileId id);
 #endif // SYSDEP_H
 
+/* Pipes: PipeCreate stores in ends[0] the identifier of the read end
+ * of a new pipe, and in ends[1] the one of its write end. They are
+ * used with Read, Write and Close, as open files. Read returns 0 once
+ * the write end is closed and the pipe is empty; Write fails once the
+ * read end is closed.
+ */
+t_error PipeCreate(OpenFileId *ends);
+
+/* Redirect CONSOLE_INPUT to the read end "input" of a pipe, and
+ * CONSOLE_OUTPUT to the write end "output" of a pipe (CONSOLE_INPUT
+ * and CONSOLE_OUTPUT to use the console again). The processes created
+ * by Exec inherit these redirections: the pipes stay open for them
+ * after the ends are closed by the caller.
+ */
+t_error Redirect(OpenFileId input, OpenFileId output);
+
 /* Remove the file */
 t_error Remove(char* name);
 
@@ -214,6 +375,13 @@ t_error P(SemId sema);
 /* Do the operation V() on the semaphore sema */
 t_error V(SemId sema);
 
+/* Same as P, but give up once the duration timeout has passed.
+   Return 0 if the semaphore was acquired, P_TIMEOUT if the timeout
+   expired first (the semaphore is then unchanged), a negative number
+   on error. */
+#define P_TIMEOUT	1
+t_error TimedP(SemId sema, Nachos_Time *timeout);
+
 /* System calls concerning locks management */
 typedef unsigned long LockId;
 
@@ -261,6 +429,193 @@ t_error CondSignal(CondId cond);
 */
 t_error CondBroadcast(CondId cond);
 
+/* System calls concerning reader-writer locks: any number of readers,
+   or a single writer, hold the lock. */
+typedef unsigned long RWLockId;
+
+/* Readers wait while writers are waiting (writers are not starved) */
+#define RWLOCK_WRITER_PREF 1
+
+/* Create a reader-writer lock (flags: 0 or RWLOCK_WRITER_PREF).
+   Return an identifier */
+RWLockId RWLockCreate(char *debug_name, int flags);
+
+/* Destroy a reader-writer lock. It must not be held or waited for.
+   Return a negative number if an error ocurred. */
+t_error RWLockDestroy(RWLockId id);
+
+/* Acquire the lock for reading.
+   Return a negative number if an error ocurred. */
+t_error RWLockRead(RWLockId id);
+
+/* Acquire the lock for writing.
+   Return a negative number if an error ocurred. */
+t_error RWLockWrite(RWLockId id);
+
+/* Release the lock, acquired for reading or writing by the calling
+   thread. Return a negative number if an error ocurred. */
+t_error RWLockRelease(RWLockId id);
+
+/* System calls concerning barriers: count threads wait for each other */
+typedef unsigned long BarrierId;
+
+/* Create a barrier for count threads. Return an identifier */
+BarrierId BarrierCreate(char *debug_name, int count);
+
+/* Destroy a barrier. No thread may be waiting on it.
+   Return a negative number if an error ocurred. */
+t_error BarrierDestroy(BarrierId id);
+
+/* Wait until count threads have called BarrierWait. Return
+   BARRIER_SERIAL in one of them, 0 in the others, a negative number
+   if an error ocurred. The barrier can be used again at once. */
+#define BARRIER_SERIAL 1
+t_error BarrierWait(BarrierId id);
+
+/* Block until one of count objects is ready, count being at most
+   WAIT_ANY_MAX. The objects are given by their identifiers: a
+   semaphore is ready when P would not block (WaitAny then does the P),
+   a thread when it has terminated, the read end of a pipe or
+   CONSOLE_INPUT when Read would not block. Return the index in ids
+   of the ready object, a negative number if an error ocurred. */
+#define WAIT_ANY_MAX 16
+int WaitAny(unsigned long *ids, int count);
+
+/* System calls concerning regions of interest: the statistics of the
+   machine are reported per region at halt, and with FastForward set
+   in the configuration file the detailed instrumentation is only
+   enabled inside a region. */
+
+/* Begin the region name, ending the active region if any. Return a
+   negative number if too many regions were created. */
+t_error RoiBegin(char *name);
+
+/* End the active region. Return a negative number if there is none. */
+t_error RoiEnd(void);
+
+/* System calls concerning futexes, used by the user-space
+   synchronization tools of libnachos. A futex is any 32-bit aligned
+   word of the address space. */
+
+/* Block the calling thread if the word at addr still contains val,
+   until a FutexWake on addr. May return without a matching wake:
+   the caller must check its condition again.
+   Return a negative number if addr is not 32-bit aligned. */
+t_error FutexWait(int *addr, int val);
+
+/* Wake up at most count threads blocked on addr.
+   Return the number of threads woken up. */
+int FutexWake(int *addr, int count);
+
+/******************************************************************/
+/* Message ports: bulk messages between processes, without copy.
+
+   A message is a buffer starting on a page boundary. PortSend moves
+   the physical pages of the buffer to the port: afterwards the buffer
+   reads as zeroes in the sender. PortReceive waits for a message and
+   maps its pages in place of those of the buffer, which must start on
+   a page boundary and be large enough for all the pages of the
+   message. The buffers must be writable (data, heap or stack). */
+
+typedef unsigned long PortId;
+
+/* Create the port called name, or return the existing one */
+PortId PortCreate(char *name);
+
+/* Drop an identifier of a port. The port is destroyed, with the
+   messages not received, once all its identifiers are dropped. */
+t_error PortDestroy(PortId port);
+
+/* Send the size bytes at buffer (blocks while the port is full) */
+t_error PortSend(PortId port, void *buffer, int size);
+
+/* Receive a message in the maxsize bytes at buffer, and return its size */
+int PortReceive(PortId port, void *buffer, int maxsize);
+
+/******************************************************************/
+/* Shared memory segments: pages mapped in several processes at once.
+
+   A segment is filled with zeroes when created. The processes use
+   the other system calls (semaphores, futexes) to synchronize their
+   accesses: the libnachos mutexes, semaphores and condition variables
+   work across processes when placed in a segment. A segment stays mapped where it is attached until
+   ShmDetach or the end of the process, even once destroyed. */
+
+typedef unsigned long ShmId;
+
+/* Create the segment called name of size bytes, or return the existing
+   one (which must be at least size bytes) */
+ShmId ShmCreate(char *name, int size);
+
+/* Drop an identifier of a segment. The segment is destroyed once all
+   its identifiers are dropped. */
+t_error ShmDestroy(ShmId segment);
+
+/* Map a segment in the address space, and return its address
+   (0 on error) */
+void *ShmAttach(ShmId segment);
+
+/* Unmap the segment attached at addr */
+t_error ShmDetach(void *addr);
+
+/******************************************************************/
+/* Syscall ring: batches of Read, Write, Open, Close, P and V requests
+   executed by a single system call.
+
+   The program queues requests in the submission queue and calls
+   RingEnter; the kernel executes them in order and posts one
+   completion per request in the completion queue, with the value the
+   equivalent system call would have returned. Both queues are
+   circular arrays of entries slots, in the program memory:
+
+   - request i is in sqes[i % entries]: the program fills it, then
+     increments sq_tail; the kernel increments sq_head when it takes it.
+   - completion i is in cqes[i % entries]: the kernel fills it, then
+     increments cq_tail; the program increments cq_head once read.
+
+   Having at most entries requests in flight guarantees that the
+   completion queue never overflows. */
+
+#define RING_OP_READ   0   /* id = OpenFileId, addr = buffer, len = size */
+#define RING_OP_WRITE  1   /* id = OpenFileId, addr = buffer, len = size */
+#define RING_OP_OPEN   2   /* addr = file name */
+#define RING_OP_CLOSE  3   /* id = OpenFileId */
+#define RING_OP_P      4   /* id = SemId */
+#define RING_OP_V      5   /* id = SemId */
+
+typedef struct {
+  int op;                    /* RING_OP_xxx */
+  int len;
+  unsigned long id;
+  unsigned long addr;
+  unsigned long user_data;   /* copied into the completion */
+} Nachos_RingSqe;
+
+typedef struct {
+  unsigned long user_data;   /* user_data of the request */
+  long result;               /* result of the request */
+} Nachos_RingCqe;
+
+typedef struct {
+  volatile unsigned int sq_head;
+  volatile unsigned int sq_tail;
+  volatile unsigned int cq_head;
+  volatile unsigned int cq_tail;
+  unsigned int entries;
+  unsigned int pad;
+  Nachos_RingSqe *sqes;
+  Nachos_RingCqe *cqes;
+} Nachos_Ring;
+
+/* Register the syscall ring of the process. sqes and cqes must point
+   to arrays of entries slots (a power of 2); the queues are emptied.
+   Return a negative number if an error ocurred. */
+t_error RingSetup(Nachos_Ring *ring, int entries);
+
+/* Execute at most to_submit queued requests (all of them if
+   to_submit <= 0). Return the number of requests executed. */
+int RingEnter(int to_submit);
+
 /******************************************************************/
 /* System calls concerning serial port and console */
 
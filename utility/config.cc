@@ -56,6 +56,7 @@ Config::Config(char *configname) {
   NumPortLoc=32009;
   NumPortDist=32009;
   PrintStat=false;
+  FastForward=false;
   FormatDisk=false;
   ListDir=false;
   PrintFileSyst=false;
@@ -66,6 +67,14 @@ Config::Config(char *configname) {
   ACIA=ACIA_NONE;
   strcpy(ProgramToRun,"");
 
+  // hpmcounter3 to hpmcounter6 count the kernel events, the others
+  // nothing unless configured
+  memset(HpmEvents, HPM_NONE, sizeof(HpmEvents));
+  HpmEvents[0] = HPM_MEMORY_ACCESSES;
+  HpmEvents[1] = HPM_PAGE_FAULTS;
+  HpmEvents[2] = HPM_SYSCALLS;
+  HpmEvents[3] = HPM_CONTEXT_SWITCHES;
+
   uint32_t nblignes=0;
 
   DEBUG('u',(char *)"Reading the configuration file\n");
@@ -156,6 +165,14 @@ Config::Config(char *configname) {
 	  continue;
 	}
 
+	if (strcmp(commande,"FastForward") == 0){
+	  uint32_t v;
+	  if(sscanf(ligne," %s = %" PRIu32 " ",commande,&v)==2)
+	    FastForward = (v != 0);
+	  else fail(nblignes,configname,ligne);
+	  continue;
+	}
+
 	if (strcmp(commande,"FormatDisk") == 0){
 	  uint32_t v;
 	  if(sscanf(ligne," %s = %" PRIu32 " ",commande,&v)==2)
@@ -264,6 +281,27 @@ Config::Config(char *configname) {
 	continue;
       }
 
+      // HpmCounterN = Event, with 3 <= N <= 31
+      if (strncmp(commande,"HpmCounter",strlen("HpmCounter")) == 0){
+	static const char *events[NUM_HPM_EVENTS] = {
+	  "None", "Cycles", "Instructions", "MemoryAccesses",
+	  "PageFaults", "Syscalls", "ContextSwitches"
+	};
+	char event[MAXSTRLEN];
+	uint32_t counter;
+	if (sscanf(ligne," HpmCounter%" PRIu32 " = %s ",&counter,event)!=2
+	    || counter < 3 || counter >= 3 + NUM_HPM_COUNTERS)
+	  fail(nblignes,configname,ligne);
+	int e;
+	for (e = 0; e < NUM_HPM_EVENTS; e++)
+	  if (strcmp(event,events[e]) == 0)
+	    break;
+	if (e == NUM_HPM_EVENTS)
+	  fail(nblignes,configname,ligne);
+	HpmEvents[counter - 3] = e;
+	continue;
+      }
+
       // Autres variables -> non reconnues
       fail(nblignes,configname,commande);
 	
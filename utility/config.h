@@ -36,6 +36,20 @@
 #define ACIA_BUSY_WAITING 1
 #define ACIA_INTERRUPT 2
 
+/* Events counted for each thread, read by user programs through the
+   hpmcounter CSRs (see Machine::ReadCounter) */
+#define HPM_NONE 0
+#define HPM_CYCLES 1
+#define HPM_INSTRUCTIONS 2
+#define HPM_MEMORY_ACCESSES 3
+#define HPM_PAGE_FAULTS 4
+#define HPM_SYSCALLS 5
+#define HPM_CONTEXT_SWITCHES 6
+#define NUM_HPM_EVENTS 7
+
+/* Number of hpmcounter CSRs (hpmcounter3 to hpmcounter31) */
+#define NUM_HPM_COUNTERS 29
+
 /*! \brief Defines Nachos hardware and software configuration 
 *
 * Used to avoid recompiling Nachos when a change in the configuration
@@ -64,6 +78,7 @@ class Config {
   uint32_t NumPortLoc;	        //!< Local ACIA's port number
   uint32_t NumPortDist;	        //!< Distant ACIA's port number
   char TargetMachineName[MAXSTRLEN];     //!< The name of the target machine for the ACIA
+  uint8_t HpmEvents[NUM_HPM_COUNTERS];   //!< Event counted by hpmcounter3 and up (HPM_*)
 
   // Kernel (process and address space) configuration
   uint64_t MaxVirtPages;   //!< Maximum number of virtual pages in each address space
@@ -77,6 +92,7 @@ class Config {
   bool ListDir;            //!< List all the files and directories if true
   bool PrintFileSyst;      //!< Print all the files in the file system if true
   bool PrintStat;          //!< Print the statistics if true
+  bool FastForward;        //!< Detailed instrumentation only in the regions of interest
   bool FormatDisk;         //!< Format the disk if true
   bool Print;              //!< Print  FileToPrint if true
   bool Remove;             //!< Remove FileToRemove if true
@@ -28,6 +28,7 @@
 #define LIST_H
 #include "kernel/copyright.h"
 #include "utility/utility.h"
+#include "utility/slab.h"
 
 /*! 
   \brief definition of a "list element"
@@ -71,7 +72,16 @@ public:
     key = sortKey;
     next = NULL; // assume we'll put it at the end of the list
   }
+
+  //! Allocated from a cache, one per list operation (see slab.h)
+  void *operator new(size_t size) { return slabCache.Alloc(size); }
+  void operator delete(void *obj) { slabCache.Free(obj); }
+  static SlabCache slabCache;
 };
+
+//! Cache of the list elements, one per type of key
+template <class T>
+SlabCache ListElement<T>::slabCache("ListElement", sizeof(ListElement<T>));
   
 /*! \brief Definition of a generic single-linked "list"
 //
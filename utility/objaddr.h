@@ -1,10 +1,10 @@
 /*! \file objaddr.h
     \brief Object address data structure
-   
+
     Nachos stores a data structure associating object ids with
     their pointers in the kernel address space. The ObjAddr class
     allows to maintain this data structure.
- 
+
 * -----------------------------------------------------
  * This file is part of the Nachos-RiscV distribution
  * Copyright (c) 2022 University of Rennes 1.
@@ -13,12 +13,12 @@
  * it under the terms of the GNU General Public License as published by
  * the Free Software Foundation, version 3.
  *
- * This program is distributed in the hope that it will be useful, but 
- * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
  * General Public License for more details
  * (see see <http://www.gnu.org/licenses/>).
- * ----------------------------------------------------  
+ * ----------------------------------------------------
 */
 
 #ifndef OBJADDR_H
@@ -26,11 +26,17 @@
 
 #include "kernel/copyright.h"
 #include "utility/utility.h"
-#include "utility/list.h"
 #include "kernel/system.h"
-#include <map>
 
-using namespace std;
+//! Initial number of slots of the object table (doubled when full)
+#define OBJADDR_INITIAL_SIZE 64
+
+//! Number of bits of an object identifier used for the slot index
+#define OBJADDR_INDEX_BITS 16
+#define OBJADDR_INDEX_MASK ((1 << OBJADDR_INDEX_BITS) - 1)
+
+//! Generations are kept on 15 bits so that identifiers stay positive
+#define OBJADDR_GENERATION_MASK 0x7fff
 
 /*! \brief Definition of object identifiers
 //
@@ -39,50 +45,120 @@ using namespace std;
 // The class stores the list of created objects and for each of them
 // associates an object identifier than can be passed to subsequent
 // system calls on the object.
-// 
-// A method allows to detect of an object corresponding to a given
-// identifier exists; this is used to check the parameters of system
-// calls.
+//
+// Objects are stored in an array of slots. An identifier is made of
+// the index of its slot (low 16 bits) and of the generation of the
+// slot (next 15 bits). The generation is incremented each time the
+// slot is released, so an identifier kept by a user program after
+// the object has been removed is detected as stale instead of
+// designating the next object stored in the same slot. Generations
+// start at 1, hence identifiers 0, 1 and 2 (console) are never used.
+//
+// Each slot also records the type of the object, so that a system
+// call can check in a single lookup that an identifier exists and
+// designates an object of the expected type.
 */
 class ObjAddr {
  private:
-  int last_id;
-  map<const int32_t,void *> ids;
+  //! A slot of the table
+  typedef struct {
+    void *ptr;            //!< Address of the object, NULL if the slot is free
+    ObjectType type;      //!< Type of the object stored in the slot
+    uint16_t generation;  //!< Current generation of the slot
+    int32_t nextFree;     //!< Next free slot (valid when the slot is free)
+  } ObjSlot;
+
+  ObjSlot *slots;         //!< Slot array
+  int32_t size;           //!< Number of allocated slots
+  int32_t firstFree;      //!< Head of the list of free slots (-1 if none)
+
+  //! Chain slots [from,to[ at the head of the free slot list
+  void InitSlots(int32_t from, int32_t to) {
+    for (int32_t i = to - 1; i >= from; i--) {
+      slots[i].ptr = NULL;
+      slots[i].type = INVALID_TYPE;
+      slots[i].generation = 1;
+      slots[i].nextFree = firstFree;
+      firstFree = i;
+    }
+  }
+
+  //! Double the size of the slot array
+  bool Grow() {
+    int32_t newSize = 2 * size;
+    if (newSize > OBJADDR_INDEX_MASK + 1) return false;
+    ObjSlot *newSlots = new ObjSlot[newSize];
+    memcpy(newSlots, slots, size * sizeof(ObjSlot));
+    delete [] slots;
+    slots = newSlots;
+    InitSlots(size, newSize);
+    size = newSize;
+    return true;
+  }
+
+  //! Return the slot designated by an identifier, NULL if it is not
+  //  in use or if the identifier is stale
+  ObjSlot *GetSlot(int64_t id) {
+    if (id < 0 || id > 0x7fffffff) return NULL;
+    int32_t index = id & OBJADDR_INDEX_MASK;
+    if (index >= size) return NULL;
+    ObjSlot *slot = &slots[index];
+    if (slot->ptr == NULL
+	|| slot->generation != (id >> OBJADDR_INDEX_BITS))
+      return NULL;
+    return slot;
+  }
+
  public:
-   ObjAddr() {last_id = 3; /* 0, 1 and 2 used for file descriptors */}
-  ~ObjAddr() {ids.clear();};
-  
-  int32_t AddObject(void *ptr) {
-    int32_t res = last_id++;
-    ids[res] = ptr;
-    if (res<0) {
+  ObjAddr() {
+    size = OBJADDR_INITIAL_SIZE;
+    slots = new ObjSlot[size];
+    firstFree = -1;
+    InitSlots(0, size);
+  }
+  ~ObjAddr() { delete [] slots; }
+
+  //! Register an object of a given type and return its identifier
+  int32_t AddObject(void *ptr, ObjectType type) {
+    ASSERT(ptr != NULL);
+    if (firstFree == -1 && !Grow()) {
       printf("**** Nachos kernel panic, not enough object identifiers\n");
       extern void Cleanup();
       Cleanup();
     }
-    return res;
+    int32_t index = firstFree;
+    ObjSlot *slot = &slots[index];
+    firstFree = slot->nextFree;
+    slot->ptr = ptr;
+    slot->type = type;
+    return ((int32_t)slot->generation << OBJADDR_INDEX_BITS) | index;
   }
-  
-  void *SearchObject(int32_t id) {
-    if (ids.find(id) == ids.end()) {
-      return (void *)NULL;
-    }
-    return ids[id];
+
+  //! Return the object designated by id if it exists and has the
+  //  requested type, NULL otherwise
+  void *SearchObject(int64_t id, ObjectType type) {
+    ObjSlot *slot = GetSlot(id);
+    if (slot == NULL || slot->type != type) return NULL;
+    return slot->ptr;
   }
-  
-  void RemoveObject(int32_t id) {
-    ids.erase(id);
+
+  //! Return the type of the object designated by id (INVALID_TYPE if
+  //  the identifier does not designate a live object)
+  ObjectType GetType(int64_t id) {
+    ObjSlot *slot = GetSlot(id);
+    return (slot == NULL) ? INVALID_TYPE : slot->type;
   }
-  
-  void RemoveObject(void *ptr) {
-    int32_t id = -1;
-    for (map<const int32_t,void *>::iterator it=ids.begin(); it!=ids.end(); ++it) {
-      if (it->second == ptr) {
-	id = it->first;
-	break;
-      }
-    }
-    if (id != -1) ids.erase(id);
+
+  //! Release the identifier id. Later uses of id are detected as stale.
+  void RemoveObject(int64_t id) {
+    ObjSlot *slot = GetSlot(id);
+    if (slot == NULL) return;
+    slot->ptr = NULL;
+    slot->type = INVALID_TYPE;
+    slot->generation = (slot->generation & OBJADDR_GENERATION_MASK) + 1;
+    if (slot->generation > OBJADDR_GENERATION_MASK) slot->generation = 1;
+    slot->nextFree = firstFree;
+    firstFree = slot - slots;
   }
 };
 
@@ -0,0 +1,148 @@
+/*! \file queue.h
+    \brief Data structures to manage intrusive doubly-linked queues
+
+    Unlike List (see list.h), a Queue does not allocate anything:
+    the links are fields of the queued objects themselves. Inserting
+    and removing an object, wherever it is in the queue, are O(1).
+
+    An object can be on as many queues at a time as it has QueueLink
+    fields, and on at most one queue per QueueLink field.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include "kernel/copyright.h"
+#include "utility/utility.h"
+
+/*! \brief Link fields to be embedded in an object put on a Queue
+ */
+class QueueLink
+{
+public:
+  QueueLink *next;   //!< Next link, NULL if the object is not queued
+  QueueLink *prev;   //!< Previous link
+  void *item;        //!< Object containing this link
+
+  QueueLink() { next = prev = NULL; item = NULL; }
+
+  //! true if the object is on a queue through this link
+  bool IsLinked() { return (next != NULL); }
+};
+
+/*! \brief Definition of an intrusive doubly-linked queue
+//
+// T is the type of the queued objects, and Link the QueueLink field
+// of T used to chain them. For instance, a queue of threads chained
+// through their field queueLink is a Queue<Thread,&Thread::queueLink>.
+//
+// The queue is circular, around a sentinel link stored in the Queue
+// object itself (so a Queue must not be copied).
+*/
+template <class T, QueueLink T::*Link>
+class Queue
+{
+public:
+  //! Initialize an empty queue
+  Queue() { head.next = head.prev = &head; }
+
+  //! Prepare a queue for deallocation, unlinking the objects still queued
+  ~Queue() { while (Remove() != NULL) ; }
+
+  //! true if the queue is empty
+  bool IsEmpty() { return (head.next == &head); }
+
+  //! Put an object at the end of the queue
+  void Append(T *item) { InsertBefore(&(item->*Link), &head, item); }
+
+  //! Put an object at the front of the queue
+  void Prepend(T *item) { InsertBefore(&(item->*Link), head.next, item); }
+
+  //! Put an object just before another one, already on the queue
+  void InsertBefore(T *item, T *before)
+  {
+    ASSERT((before->*Link).IsLinked());
+    InsertBefore(&(item->*Link), &(before->*Link), item);
+  }
+
+  //! Remove the first object of the queue, NULL if the queue is empty
+  T *Remove()
+  {
+    if (IsEmpty())
+      return NULL;
+    QueueLink *link = head.next;
+    Unlink(link);
+    return (T *)link->item;
+  }
+
+  //! Remove an object from the queue, if it is on it
+  void RemoveItem(T *item)
+  {
+    if ((item->*Link).IsLinked())
+      Unlink(&(item->*Link));
+  }
+
+  //! true if the object is on a queue through the Link field
+  bool IsQueued(T *item) { return (item->*Link).IsLinked(); }
+
+  //! First object of the queue, NULL if the queue is empty
+  T *First() { return (IsEmpty()) ? NULL : (T *)head.next->item; }
+
+  //! Object following item on the queue, NULL if item is the last one
+  T *Next(T *item)
+  {
+    QueueLink *link = (item->*Link).next;
+    return (link == &head) ? NULL : (T *)link->item;
+  }
+
+  //! Apply a function to each object of the queue
+  void Mapcar(VoidFunctionPtr func)
+  {
+    for (QueueLink *link = head.next; link != &head; link = link->next)
+      (*func)((int64_t)link->item);
+  }
+
+private:
+  //! Link a QueueLink before another one
+  void InsertBefore(QueueLink *link, QueueLink *before, T *item)
+  {
+    ASSERT(!link->IsLinked());
+    link->item = (void *)item;
+    link->next = before;
+    link->prev = before->prev;
+    before->prev->next = link;
+    before->prev = link;
+  }
+
+  //! Unlink a QueueLink from its queue
+  void Unlink(QueueLink *link)
+  {
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->next = link->prev = NULL;
+  }
+
+  //! Sentinel of the circular chain of links
+  QueueLink head;
+
+  // A queue cannot be copied (the links point to its sentinel)
+  Queue(const Queue &);
+  Queue &operator=(const Queue &);
+};
+
+#endif // QUEUE_H
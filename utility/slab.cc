@@ -0,0 +1,127 @@
+/*! \file slab.cc
+//  \brief Routines to manage the caches of kernel objects
+//
+//	A cache puts itself on the list of caches at its first
+//	allocation, so that caches of unused classes are not reported.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "utility/slab.h"
+#include "kernel/system.h"
+#include "utility/stats.h"
+
+SlabCache *SlabCache::caches = NULL;
+
+//----------------------------------------------------------------------
+// SlabCache::Alloc
+/*!	Allocate an object, taking a new slab from the host if no
+//	object is free
+//
+//	\param size size of the object (bytes), as given to operator new
+//	\return the object (uninitialized)
+*/
+//----------------------------------------------------------------------
+void *
+SlabCache::Alloc(size_t size)
+{
+  // A derived class larger than the class of the cache has no cache
+  ASSERT(size <= objectSize);
+
+  if (!registered) {
+    registered = true;
+    nextCache = caches;
+    caches = this;
+  }
+  if (freeList == NULL)
+    Grow();
+
+  FreeObject *obj = freeList;
+  freeList = obj->next;
+  numAllocs++;
+  if (++numLive > peakLive)
+    peakLive = numLive;
+  return (void *)obj;
+}
+
+//----------------------------------------------------------------------
+// SlabCache::Free
+/*!	Put back an object on the free list of the cache
+//
+//	\param obj the object, NULL being ignored as by delete
+*/
+//----------------------------------------------------------------------
+void
+SlabCache::Free(void *obj)
+{
+  if (obj == NULL)
+    return;
+  ASSERT(numLive > 0);
+  FreeObject *freeObj = (FreeObject *)obj;
+  freeObj->next = freeList;
+  freeList = freeObj;
+  numFrees++;
+  numLive--;
+}
+
+//----------------------------------------------------------------------
+// SlabCache::Grow
+/*!	Take a slab from the host allocator, and put all its objects
+//	on the free list. A slab holds at least one object.
+*/
+//----------------------------------------------------------------------
+void
+SlabCache::Grow()
+{
+  size_t perSlab = (objectSize < SLAB_SIZE) ? SLAB_SIZE / objectSize : 1;
+  char *slab = (char *)malloc(perSlab * objectSize);
+  ASSERT(slab != NULL);
+  for (size_t i = perSlab; i > 0; i--) {
+    FreeObject *obj = (FreeObject *)(slab + (i - 1) * objectSize);
+    obj->next = freeList;
+    freeList = obj;
+  }
+  numSlabs++;
+  DEBUG('m', (char *)"Slab cache %s: slab %" PRIu64 " of %d objects\n",
+	name, numSlabs, (int)perSlab);
+}
+
+//----------------------------------------------------------------------
+// SlabCache::Print
+/*!	Print the number of objects in use, the highest number of objects
+//	in use, and the allocation rate (per million cycles)
+*/
+//----------------------------------------------------------------------
+void
+SlabCache::Print()
+{
+  Time ticks = g_stats->getTotalTicks();
+  printf("   %-18s %4d bytes: %8" PRIu64 " live, %8" PRIu64 " peak, %4"
+	 PRIu64 " slabs, %10" PRIu64 " allocs (%" PRIu64 " per Mcycle)\n",
+	 name, (int)objectSize, numLive, peakLive, numSlabs, numAllocs,
+	 (ticks) ? (uint64_t)(numAllocs * 1000000.0 / ticks) : 0);
+}
+
+//----------------------------------------------------------------------
+// SlabCache::PrintAll
+//!	Print the use of all the caches used so far
+//----------------------------------------------------------------------
+void
+SlabCache::PrintAll()
+{
+  printf("Kernel object caches:\n");
+  for (SlabCache *cache = caches; cache != NULL; cache = cache->nextCache)
+    cache->Print();
+}
@@ -0,0 +1,98 @@
+/*! \file slab.h
+    \brief Data structures for the caches of kernel objects
+
+    The kernel objects created and deleted most often (pending
+    interrupts, list elements, open files, threads...) are allocated
+    from a cache of their class instead of the host allocator. A cache
+    carves slabs of a few kilobytes into objects of a single size, and
+    keeps the deleted objects on a free list: allocating or freeing an
+    object is a couple of pointer updates, and the number of objects
+    of each class in use is known at any time.
+
+    A class uses its cache through class-level operator new and delete:
+
+	void *operator new(size_t size) { return slabCache.Alloc(size); }
+	void operator delete(void *obj) { slabCache.Free(obj); }
+	static SlabCache slabCache;
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stddef.h>
+#include "kernel/copyright.h"
+#include "utility/utility.h"
+
+//! Size of the memory blocks carved into objects (bytes)
+#define SLAB_SIZE 4096
+
+/*! \brief Defines a cache of objects of a single size
+//
+// Slabs are never given back to the host: the memory of the objects
+// deleted is reused for the next objects of the same class. Nachos
+// interrupts only occur between two simulated instructions, so a
+// cache needs no protection against interrupt handlers.
+//
+// The constructor is constexpr so that caches declared as static
+// members are initialized before any code runs, whatever the order
+// of initialization of the files.
+*/
+class SlabCache {
+public:
+  //! Initialize an empty cache of objects of size bytes
+  constexpr SlabCache(const char *cacheName, size_t size)
+    : name(cacheName), objectSize((size + 15) & ~(size_t)15),
+      freeList(NULL), numSlabs(0), numAllocs(0), numFrees(0),
+      numLive(0), peakLive(0), registered(false), nextCache(NULL) {}
+
+  //! Allocate an object of size bytes (at most the size of the cache)
+  void *Alloc(size_t size);
+
+  //! Put back an object returned by Alloc
+  void Free(void *obj);
+
+  //! Print the use of the cache
+  void Print();
+
+  //! Print the use of all the caches
+  static void PrintAll();
+
+private:
+  //! Free object, linked through its first bytes
+  struct FreeObject {
+    FreeObject *next;
+  };
+
+  //! Carve a new slab into free objects
+  void Grow();
+
+  const char *name;        //!< Name of the cache (class of the objects)
+  size_t objectSize;       //!< Size of the objects, rounded up to 16 bytes
+  FreeObject *freeList;    //!< Objects ready to be allocated
+  uint64_t numSlabs;       //!< Number of slabs taken from the host
+  uint64_t numAllocs;      //!< Number of calls to Alloc
+  uint64_t numFrees;       //!< Number of calls to Free
+  uint64_t numLive;        //!< Number of objects in use
+  uint64_t peakLive;       //!< Highest number of objects in use
+  bool registered;         //!< true once on the list of caches
+  SlabCache *nextCache;    //!< Next cache on the list of caches
+
+  static SlabCache *caches; //!< List of the caches used so far
+};
+
+#endif // SLAB_H
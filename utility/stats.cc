@@ -23,6 +23,36 @@
 #include "kernel/copyright.h"
 #include "kernel/system.h"
 #include "utility/stats.h"
+#include "kernel/systable.h"
+
+//----------------------------------------------------------------------
+// PrintHistogram
+/*!     Prints the non-empty buckets of a histogram of durations: bucket
+//      0 counts durations below 2^shift cycles, bucket i > 0 those in
+//      [2^(shift+i-1), 2^(shift+i)[, the last bucket all longer ones.
+//
+//      \param hist the buckets
+//      \param size number of buckets
+//      \param shift log2 of the upper bound of bucket 0
+*/
+//----------------------------------------------------------------------
+static void PrintHistogram(uint64_t *hist, int size, int shift)
+{
+  for (int i = 0; i < size; i++) {
+    if (hist[i] == 0)
+      continue;
+    if (i == 0)
+      printf("\t[0, %" PRIu64 "[ : %" PRIu64 "\n",
+	     (uint64_t)1 << shift, hist[i]);
+    else if (i == size - 1)
+      printf("\t[%" PRIu64 ", +inf[ : %" PRIu64 "\n",
+	     (uint64_t)1 << (shift + i - 1), hist[i]);
+    else
+      printf("\t[%" PRIu64 ", %" PRIu64 "[ : %" PRIu64 "\n",
+	     (uint64_t)1 << (shift + i - 1),
+	     (uint64_t)1 << (shift + i), hist[i]);
+  }
+}
 
 //----------------------------------------------------------------------
 // Statistics::Statistics
@@ -34,6 +64,25 @@ Statistics::Statistics()
 {
   allStatistics = new Listint;
   idleTicks=totalTicks=0;
+  numFPSaves=numFPRestores=0;
+  memset(hpmEvents, 0, sizeof(hpmEvents));
+  detailed = !g_cfg->FastForward;
+  syscallStats = new SyscallStat[NUM_SYSCALLS];
+}
+
+//----------------------------------------------------------------------
+// Statistics::AddSyscall
+/*!     Records a call of a system call
+//
+//      \param number the system call number
+//      \param duration time between the entry and the return (cycles)
+*/
+//----------------------------------------------------------------------
+void
+Statistics::AddSyscall(int number, Time duration)
+{
+  if (number >= 0 && number < NUM_SYSCALLS)
+    syscallStats[number].AddCall(duration);
 }
 
 
@@ -71,6 +120,19 @@ Statistics::Print()
 	 totalTicks,g_cfg->ProcessorFrequency,
 	 cycle_to_sec(totalTicks,g_cfg->ProcessorFrequency),
 	 cycle_to_nano(totalTicks,g_cfg->ProcessorFrequency));
+  schedStat.Print();
+  printf("   FP registers : \t%" PRIu64 " saves, %" PRIu64 " restores (lazy)\n",
+	 numFPSaves, numFPRestores);
+
+  printf("   System calls : \t\tcalls, mean / max cycles\n");
+  for (int i = 0; i < NUM_SYSCALLS; i++) {
+    SyscallStat *sc = &syscallStats[i];
+    if (sc->numCalls == 0)
+      continue;
+    printf("     %-16s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+	   SyscallName(i), sc->numCalls, sc->ticks / sc->numCalls, sc->maxTicks);
+    PrintHistogram(sc->hist, SYSCALL_HIST_SIZE, SYSCALL_HIST_SHIFT);
+  }
 }
 
 ProcessStat*
@@ -98,6 +160,7 @@ Statistics::~Statistics()
       delete s;
     }
   delete allStatistics;
+  delete [] syscallStats;
 }
 
 //----------------------------------------------------------------------
@@ -182,7 +245,95 @@ void ProcessStat::Print(void)
 	 numConsoleCharsRead, numConsoleCharsWritten);
   printf("   Memory Management :  \t%" PRIu64 " accesses,  %" PRIu64 " page faults\n", 
 	   numMemoryAccess, numPageFaults);
+  schedStat.Print();
 
     printf("------------------------------------------------------------\n");
 }
-      
+
+//----------------------------------------------------------------------
+// SchedStat::SchedStat
+//!     Initializes scheduling metrics to zero
+//----------------------------------------------------------------------
+SchedStat::SchedStat()
+{
+  for (int i = 0; i < SCHED_HIST_SIZE; i++)
+    readyLatency[i] = 0;
+  maxReadyLatency = readyTicks = runTicks = blockedTicks = 0;
+  numVoluntarySwitches = numInvoluntarySwitches = 0;
+  numPriorityBoosts = 0;
+}
+
+//----------------------------------------------------------------------
+// SchedStat::AddReadyLatency
+/*!     Records the time a thread waited on the ready list before
+//      getting the CPU
+//
+//      \param latency time spent on the ready list (cycles)
+*/
+//----------------------------------------------------------------------
+void SchedStat::AddReadyLatency(Time latency)
+{
+  int bucket = 0;
+  while (bucket < SCHED_HIST_SIZE - 1
+	 && (latency >> (SCHED_HIST_SHIFT + bucket)) != 0)
+    bucket++;
+  readyLatency[bucket]++;
+  readyTicks += latency;
+  if (latency > maxReadyLatency)
+    maxReadyLatency = latency;
+}
+
+//----------------------------------------------------------------------
+// SchedStat::Print
+/*!     Prints scheduling statistics
+*/
+//----------------------------------------------------------------------
+void SchedStat::Print(void)
+{
+  uint64_t numDispatches = 0;
+  for (int i = 0; i < SCHED_HIST_SIZE; i++)
+    numDispatches += readyLatency[i];
+
+  printf("   Scheduling : \t\t%" PRIu64 " voluntary, %" PRIu64 " involuntary switches\n",
+	 numVoluntarySwitches, numInvoluntarySwitches);
+  printf("   On-CPU / blocked time : \t%" PRIu64 " / %" PRIu64 " cycles\n",
+	 runTicks, blockedTicks);
+  printf("   Priority boosts : \t\t%" PRIu64 "\n", numPriorityBoosts);
+  printf("   Ready list latency : \t%" PRIu64 " dispatches, mean %" PRIu64
+	 ", max %" PRIu64 " cycles\n",
+	 numDispatches, (numDispatches) ? readyTicks / numDispatches : 0,
+	 maxReadyLatency);
+  PrintHistogram(readyLatency, SCHED_HIST_SIZE, SCHED_HIST_SHIFT);
+}
+
+//----------------------------------------------------------------------
+// SyscallStat::SyscallStat
+//!     Initializes the statistics of a system call to zero
+//----------------------------------------------------------------------
+SyscallStat::SyscallStat()
+{
+  for (int i = 0; i < SYSCALL_HIST_SIZE; i++)
+    hist[i] = 0;
+  numCalls = 0;
+  ticks = maxTicks = 0;
+}
+
+//----------------------------------------------------------------------
+// SyscallStat::AddCall
+/*!     Records a call of the system call
+//
+//      \param duration time between the entry and the return (cycles)
+*/
+//----------------------------------------------------------------------
+void SyscallStat::AddCall(Time duration)
+{
+  int bucket = 0;
+  while (bucket < SYSCALL_HIST_SIZE - 1
+	 && (duration >> (SYSCALL_HIST_SHIFT + bucket)) != 0)
+    bucket++;
+  hist[bucket]++;
+  numCalls++;
+  ticks += duration;
+  if (duration > maxTicks)
+    maxTicks = duration;
+}
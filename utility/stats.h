@@ -34,11 +34,76 @@
 
 class ProcessStat;
 
+//! Number of buckets of the ready list latency histograms (must be
+//  the same as in userlib/syscall.h)
+#define SCHED_HIST_SIZE 16
+
+//! Bucket 0 counts latencies below 2^SCHED_HIST_SHIFT cycles
+#define SCHED_HIST_SHIFT 8
+
+/*! \brief Defines scheduling statistics
+//
+// Kept for each thread, each process and for the whole system, by
+// the scheduler (see Scheduler::ReadyToRun and Scheduler::SwitchTo).
+// A switch is involuntary when the thread is preempted at the end of
+// its quantum, voluntary when it blocks or calls Yield.
+//
+// Bucket 0 of the histogram counts the ready list latencies (time
+// between ReadyToRun and getting the CPU) below 2^SCHED_HIST_SHIFT
+// cycles, bucket i > 0 those in [2^(SCHED_HIST_SHIFT+i-1),
+// 2^(SCHED_HIST_SHIFT+i)[, the last bucket all longer latencies.
+*/
+class SchedStat {
+public:
+  SchedStat();                         // initialises everything to zero
+
+  //! Record the time a thread waited on the ready list
+  void AddReadyLatency(Time latency);
+
+  void Print(void);
+
+  uint64_t readyLatency[SCHED_HIST_SIZE]; //!< Ready list latency histogram
+  Time maxReadyLatency;          //!< Longest wait on the ready list
+  Time readyTicks;               //!< Total time spent on the ready list
+  Time runTicks;                 //!< Total time spent holding the CPU
+  Time blockedTicks;             //!< Total time spent blocked
+  uint64_t numVoluntarySwitches;   //!< Switches where the thread blocked or yielded
+  uint64_t numInvoluntarySwitches; //!< Switches where the thread was preempted
+  uint64_t numPriorityBoosts;      //!< Priorities inherited through a lock
+};
+
+//! Number of buckets of the system call duration histograms
+#define SYSCALL_HIST_SIZE 16
+
+//! Bucket 0 counts durations below 2^SYSCALL_HIST_SHIFT cycles
+#define SYSCALL_HIST_SHIFT 4
+
+/*! \brief Defines the statistics of one system call
+//
+// Kept by ExceptionHandler for the whole system. The duration of a
+// call is the simulated time between its entry and its return, the
+// time it spent blocked included. The histogram buckets are as in
+// SchedStat, starting at 2^SYSCALL_HIST_SHIFT cycles.
+*/
+class SyscallStat {
+public:
+  SyscallStat();                       // initialises everything to zero
+
+  //! Record a call of the system call
+  void AddCall(Time duration);
+
+  uint64_t numCalls;                   //!< Number of calls
+  Time ticks;                          //!< Total duration of the calls
+  Time maxTicks;                       //!< Longest call
+  uint64_t hist[SYSCALL_HIST_SIZE];    //!< Duration histogram
+};
+
 class Statistics {
  private:
   Listint *allStatistics;      //!< enables to keep  statistics of all processes when they are finished.
   Time totalTicks;	   //!< Total time spent running Nachos
   Time idleTicks;           //!< Time spent idle (no thread to run)
+  SyscallStat *syscallStats; //!< Statistics of each system call, by number
                           
  public:
   Statistics();            // initialyses everything to zero
@@ -54,6 +119,19 @@ class Statistics {
   void setTotalTicks(Time val) {totalTicks=val;}
   Time getTotalTicks(void) {return totalTicks;}
   void incrIdleTicks (Time val) {idleTicks +=val;}
+
+  //! Record a call of system call number, which lasted duration cycles
+  void AddSyscall(int number, Time duration);
+
+  SchedStat schedStat;     //!< Scheduling statistics of all threads
+  //! Events of all threads, indexed by HPM_* (see Thread::hpmEvents)
+  uint64_t hpmEvents[NUM_HPM_EVENTS];
+
+  //! Detailed instrumentation enabled (see RoiManager)
+  bool detailed;
+
+  uint64_t numFPSaves;     //!< FP registers saved (see Machine::UseFP)
+  uint64_t numFPRestores;  //!< FP registers restored
 };
 
 
@@ -92,8 +170,11 @@ public:
   void incrNumDiskReads(void) {numDiskReads++;}
   void incrNumDiskWrites(void) {numDiskWrites++;}
   void incrNumInstruction(void) {numInstruction++;}
-  int getNumInstruction(void) {return numInstruction;}
+  uint64_t getNumInstruction(void) {return numInstruction;}
+  uint64_t getNumPageFaults(void) {return numPageFaults;}
   void Print(void);
+
+  SchedStat schedStat;               //!< Scheduling statistics of the process threads
 };
 
 // Constants used to reflect the relative time an operation would
@@ -15,6 +15,7 @@
      	'f' -- file system
      	'a' -- address spaces
         'x' -- virtual memory
+        'y' -- system call trace, with arguments, results and durations
 
  * -----------------------------------------------------
  * This file is part of the Nachos-RiscV distribution
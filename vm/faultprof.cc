@@ -0,0 +1,274 @@
+/*! \file faultprof.cc
+//  \brief Routines of the page fault profiler
+//
+//	The per-page and per-PC tables are open-addressed hash tables
+//	with linear probing: a fault costs a few comparisons, without
+//	any allocation.
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#include "vm/faultprof.h"
+#include "utility/config.h"
+
+//! Names of the fault types, for the debug messages
+static const char *faultTypeNames[NUM_FAULT_TYPES] = {
+  "first touch", "swap-in", "file"
+};
+
+//----------------------------------------------------------------------
+// CopyName
+/*!	Copy a name for the report, truncated if needed
+//
+//	\param dest buffer of FAULT_NAME_LEN characters
+//	\param name the name
+*/
+//----------------------------------------------------------------------
+static void
+CopyName(char *dest, const char *name)
+{
+  strncpy(dest, name, FAULT_NAME_LEN - 1);
+  dest[FAULT_NAME_LEN - 1] = '\0';
+}
+
+//----------------------------------------------------------------------
+// AddFault
+/*!	Count a fault
+//
+//	\param counts the counters
+//	\param type type of the fault
+//	\param ticks resolution time (cycles)
+*/
+//----------------------------------------------------------------------
+static void
+AddFault(FaultCounts *counts, FaultType type, Time ticks)
+{
+  counts->num[type]++;
+  counts->ticks += ticks;
+  if (ticks > counts->maxTicks)
+    counts->maxTicks = ticks;
+}
+
+//----------------------------------------------------------------------
+// NumFaults
+/*!	\return the number of faults of all types in counts
+*/
+//----------------------------------------------------------------------
+static uint64_t
+NumFaults(const FaultCounts *counts)
+{
+  uint64_t n = 0;
+  for (int t = 0; t < NUM_FAULT_TYPES; t++)
+    n += counts->num[t];
+  return n;
+}
+
+//----------------------------------------------------------------------
+// PrintCounts
+/*!	Print the counters of a region or site, after its name
+//
+//	\param counts the counters
+*/
+//----------------------------------------------------------------------
+static void
+PrintCounts(const FaultCounts *counts)
+{
+  uint64_t n = NumFaults(counts);
+  printf("%8" PRIu64 " faults (%" PRIu64 " first touch, %" PRIu64
+	 " swap-in, %" PRIu64 " file), avg %" PRIu64 " cycles, max %"
+	 PRIu64 "\n", n, counts->num[FAULT_FIRST_TOUCH],
+	 counts->num[FAULT_SWAP_IN], counts->num[FAULT_FILE],
+	 (uint64_t)(n ? counts->ticks / n : 0), (uint64_t)counts->maxTicks);
+}
+
+//----------------------------------------------------------------------
+// FaultProfiler::FaultProfiler
+//!	Initialize an empty profile, with the region of the other faults
+//----------------------------------------------------------------------
+FaultProfiler::FaultProfiler()
+{
+  memset(regions, 0, sizeof(regions));
+  CopyName(regions[FAULT_OTHER_REGION].program, "-");
+  CopyName(regions[FAULT_OTHER_REGION].section, "(stack, mappings)");
+  numRegions = 1;
+  for (int i = 0; i < FAULT_MAX_SITES; i++) {
+    memset(&pages[i], 0, sizeof(FaultSite));
+    pages[i].region = -1;
+    memset(&pcs[i], 0, sizeof(FaultSite));
+    pcs[i].region = -1;
+  }
+  numDropped = 0;
+  memset(&total, 0, sizeof(total));
+}
+
+//----------------------------------------------------------------------
+// FaultProfiler::~FaultProfiler
+//!	Nothing is allocated
+//----------------------------------------------------------------------
+FaultProfiler::~FaultProfiler()
+{
+}
+
+//----------------------------------------------------------------------
+// FaultProfiler::GetRegion
+/*!	Return the region of a section of an executable file. Called
+//	when an address space is loaded, not at each fault.
+//
+//	\param program name of the executable file
+//	\param section name of the section
+//	\return the index of the region, FAULT_OTHER_REGION if the
+//	       table is full
+*/
+//----------------------------------------------------------------------
+int
+FaultProfiler::GetRegion(const char *program, const char *section)
+{
+  char p[FAULT_NAME_LEN], s[FAULT_NAME_LEN];
+  CopyName(p, program);
+  CopyName(s, section);
+
+  for (int i = 1; i < numRegions; i++)
+    if (strcmp(regions[i].program, p) == 0
+	&& strcmp(regions[i].section, s) == 0)
+      return i;
+  if (numRegions == FAULT_MAX_REGIONS)
+    return FAULT_OTHER_REGION;
+  strcpy(regions[numRegions].program, p);
+  strcpy(regions[numRegions].section, s);
+  return numRegions++;
+}
+
+//----------------------------------------------------------------------
+// FaultProfiler::FindSite
+/*!	Look for the entry of a page or code address, creating it if
+//	there is room
+//
+//	\param table pages or pcs
+//	\param region region of the site
+//	\param key virtual page number or PC
+//	\return the entry, NULL if the table is full
+*/
+//----------------------------------------------------------------------
+FaultSite *
+FaultProfiler::FindSite(FaultSite *table, int region, uint64_t key)
+{
+  unsigned int h = (unsigned int)((key * 2654435761u + region) % FAULT_MAX_SITES);
+  for (int i = 0; i < FAULT_MAX_SITES; i++) {
+    FaultSite *site = &table[(h + i) % FAULT_MAX_SITES];
+    if (site->region == -1) {
+      site->region = region;
+      site->key = key;
+      return site;
+    }
+    if (site->region == region && site->key == key)
+      return site;
+  }
+  return NULL;
+}
+
+//----------------------------------------------------------------------
+// FaultProfiler::Record
+/*!	Record a page fault
+//
+//	\param region region of the faulting page (see GetRegion)
+//	\param vpn virtual page number
+//	\param pc address of the faulting instruction
+//	\param type where the page came from
+//	\param ticks time taken by the page fault manager (cycles)
+*/
+//----------------------------------------------------------------------
+void
+FaultProfiler::Record(int region, uint64_t vpn, uint64_t pc,
+		      FaultType type, Time ticks)
+{
+  ASSERT(region >= 0 && region < numRegions);
+  DEBUG('x', (char *)"Page fault: page %" PRIu64 " of %s:%s, pc 0x%" PRIx64
+	", %s, %" PRIu64 " cycles\n", vpn, regions[region].program,
+	regions[region].section, pc, faultTypeNames[type], (uint64_t)ticks);
+
+  AddFault(&total, type, ticks);
+  AddFault(&regions[region].counts, type, ticks);
+
+  // The code address is attributed to the region of the page faulting
+  FaultSite *page = FindSite(pages, region, vpn);
+  FaultSite *code = FindSite(pcs, region, pc);
+  if (page != NULL)
+    AddFault(&page->counts, type, ticks);
+  if (code != NULL)
+    AddFault(&code->counts, type, ticks);
+  if (page == NULL || code == NULL)
+    numDropped++;
+}
+
+//----------------------------------------------------------------------
+// FaultProfiler::PrintTop
+/*!	Print the FAULT_TOP_N entries of a table with the most faults
+//
+//	\param table pages or pcs
+//	\param isPage true for pages, printed by their address
+*/
+//----------------------------------------------------------------------
+void
+FaultProfiler::PrintTop(FaultSite *table, bool isPage)
+{
+  bool printed[FAULT_MAX_SITES];
+  memset(printed, 0, sizeof(printed));
+
+  for (int n = 0; n < FAULT_TOP_N; n++) {
+    FaultSite *best = NULL;
+    int bestIndex = 0;
+    for (int i = 0; i < FAULT_MAX_SITES; i++)
+      if (table[i].region != -1 && !printed[i]
+	  && (best == NULL || NumFaults(&table[i].counts) > NumFaults(&best->counts))) {
+	best = &table[i];
+	bestIndex = i;
+      }
+    if (best == NULL)
+      return;
+    printed[bestIndex] = true;
+    printf("  %s 0x%-8" PRIx64 " %-12s %-12s", isPage ? "page" : "pc  ",
+	   isPage ? best->key * g_cfg->PageSize : best->key,
+	   regions[best->region].program, regions[best->region].section);
+    PrintCounts(&best->counts);
+  }
+}
+
+//----------------------------------------------------------------------
+// FaultProfiler::Print
+//!	Print the profile: totals, regions, then the busiest pages and
+//	code addresses
+//----------------------------------------------------------------------
+void
+FaultProfiler::Print()
+{
+  printf("Page faults: ");
+  PrintCounts(&total);
+  if (NumFaults(&total) == 0)
+    return;
+
+  printf("Page faults per section:\n");
+  for (int i = 0; i < numRegions; i++)
+    if (NumFaults(&regions[i].counts) != 0) {
+      printf("  %-20s %-20s", regions[i].program, regions[i].section);
+      PrintCounts(&regions[i].counts);
+    }
+  printf("Pages with the most faults:\n");
+  PrintTop(pages, true);
+  printf("Code addresses with the most faults:\n");
+  PrintTop(pcs, false);
+  if (numDropped != 0)
+    printf("  (%" PRIu64 " faults not attributed to a page or code address,"
+	   " tables full)\n", numDropped);
+}
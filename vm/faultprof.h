@@ -0,0 +1,126 @@
+/*! \file faultprof.h
+    \brief Page fault profiler
+
+    Each page fault raised by the MMU is recorded with its virtual
+    page, the PC of the faulting instruction, its type and the time
+    taken to resolve it. The faults are aggregated per section of
+    the executable files, per virtual page and per code address, and
+    reported at halt: thrashing shows up as swap-ins concentrated on
+    a few pages, poor locality as first touches spread over many
+    pages.
+
+ * -----------------------------------------------------
+ * This file is part of the Nachos-RiscV distribution
+ * Copyright (c) 2022 University of Rennes 1.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details
+ * (see see <http://www.gnu.org/licenses/>).
+ * -----------------------------------------------------
+*/
+
+#ifndef FAULTPROF_H
+#define FAULTPROF_H
+
+#include "kernel/copyright.h"
+#include "kernel/system.h"
+
+//! Types of page faults, by where the page comes from
+enum FaultType {
+  FAULT_FIRST_TOUCH,  //!< Anonymous page (bss, stack), zero-filled
+  FAULT_SWAP_IN,      //!< Page read back from the swap disk
+  FAULT_FILE,         //!< Page read from the executable or a mapped file
+  NUM_FAULT_TYPES
+};
+
+//! Maximum number of sections in the profile (program, section)
+#define FAULT_MAX_REGIONS 64
+
+//! Number of entries of the per-page and per-PC tables
+#define FAULT_MAX_SITES 256
+
+//! Number of pages and of code addresses in the report
+#define FAULT_TOP_N 10
+
+//! Length of the names kept by the profiler
+#define FAULT_NAME_LEN 32
+
+//! Region of the faults outside of the sections (stack, mappings)
+#define FAULT_OTHER_REGION 0
+
+/*! \brief Page faults counted by type, with their resolution time
+ */
+typedef struct {
+  uint64_t num[NUM_FAULT_TYPES]; //!< Number of faults of each type
+  Time ticks;                    //!< Total resolution time
+  Time maxTicks;                 //!< Longest resolution time
+} FaultCounts;
+
+/*! \brief Faults in a section of an executable file, for all the
+//  address spaces loaded from it
+*/
+typedef struct {
+  char program[FAULT_NAME_LEN];  //!< Name of the executable file
+  char section[FAULT_NAME_LEN];  //!< Name of the section
+  FaultCounts counts;            //!< Faults in the section
+} FaultRegion;
+
+/*! \brief Faults on a virtual page or at a code address of a region
+ */
+typedef struct {
+  int region;          //!< Region of the page or code address, -1 if free
+  uint64_t key;        //!< Virtual page number or PC
+  FaultCounts counts;  //!< Faults on the page or at the PC
+} FaultSite;
+
+/*! \brief Defines the page fault profiler
+//
+// Regions are shared by the address spaces of a same program, so
+// that the profile of a program run several times is aggregated.
+// The tables are bounded: once full, new regions are counted in
+// FAULT_OTHER_REGION and new pages or code addresses only in their
+// region.
+//
+//	GetRegion(program, section) -- return the index of a region,
+//	        used by AddrSpace to attribute its pages
+//
+//	Record(region, vpn, pc, type, ticks) -- record a fault resolved
+//	        in ticks cycles
+*/
+class FaultProfiler {
+public:
+  FaultProfiler();
+  ~FaultProfiler();
+
+  //! Return the region of a section, creating it if needed
+  int GetRegion(const char *program, const char *section);
+
+  //! Record a page fault on page vpn of region, raised at pc
+  void Record(int region, uint64_t vpn, uint64_t pc,
+	      FaultType type, Time ticks);
+
+  //! Print the faults per region, page and code address
+  void Print();
+
+private:
+  //! Return the entry of a site in table, NULL if the table is full
+  FaultSite *FindSite(FaultSite *table, int region, uint64_t key);
+
+  //! Print the FAULT_TOP_N sites of a table with the most faults
+  void PrintTop(FaultSite *table, bool isPage);
+
+  FaultRegion regions[FAULT_MAX_REGIONS]; //!< Sections, 0 for the others
+  int numRegions;                  //!< Number of regions used
+  FaultSite pages[FAULT_MAX_SITES]; //!< Faults per virtual page
+  FaultSite pcs[FAULT_MAX_SITES];   //!< Faults per code address
+  uint64_t numDropped;             //!< Faults on sites left out of the tables
+  FaultCounts total;               //!< All faults
+};
+
+#endif // FAULTPROF_H
@@ -38,7 +38,8 @@ PhysicalMemManager::PhysicalMemManager() {
     tpr[i].free=true;
     tpr[i].locked=false;
     tpr[i].owner=NULL;
-    free_page_list.Append((void*)i);
+    tpr[i].refCount=0;
+    free_page_list.Append(&tpr[i]);
   }
   i_clock=-1;
 }
@@ -56,7 +57,8 @@ PhysicalMemManager::~PhysicalMemManager() {
 //
 /*! This method releases an unused physical page by clearing the
 //  corresponding bit in the page_flags bitmap structure, and adding
-//  it in the free_page_list.
+//  it in the free_page_list. A shared page is only freed when its
+//  last reference is removed.
 //
 //  \param num_page is the number of the real page to free
 */
@@ -66,14 +68,58 @@ void PhysicalMemManager::RemovePhysicalToVirtualMapping(uint64_t num_page) {
   // Check that the page is not already free 
   ASSERT(!tpr[num_page].free);
 
+  // Only drop a reference if the page is still shared
+  ASSERT(tpr[num_page].refCount > 0);
+  if (--tpr[num_page].refCount > 0)
+    return;
+
   // Update the physical page table entry
   tpr[num_page].free=true;
   tpr[num_page].locked=false;
-  if (tpr[num_page].owner->translationTable!=NULL) 
+  if (tpr[num_page].owner!=NULL && tpr[num_page].owner->translationTable!=NULL) 
     tpr[num_page].owner->translationTable->clearBitValid(tpr[num_page].virtualPage);
 
   // Insert the page in the free list
-  free_page_list.Prepend((void*)num_page);
+  free_page_list.Prepend(&tpr[num_page]);
+}
+
+//-----------------------------------------------------------------
+// PhysicalMemManager::AllocSharedFrame
+//
+/*! This method returns a free page filled with zeroes, to be mapped
+//  in several address spaces. The page has no owner, is locked, and
+//  has one reference (see ShareFrame). Unlike
+//  AddPhysicalToVirtualMapping, it does not evict any page.
+//
+//  \return A new physical page number, INVALID_PAGE if none is free
+*/
+//-----------------------------------------------------------------
+int PhysicalMemManager::AllocSharedFrame() {
+  int page = FindFreePage();
+  if (page == INVALID_PAGE)
+    return INVALID_PAGE;
+  memset(&(g_machine->mainMemory[page*g_cfg->PageSize]), 0, g_cfg->PageSize);
+  tpr[page].owner = NULL;
+  tpr[page].locked = true;
+  return page;
+}
+
+//-----------------------------------------------------------------
+// PhysicalMemManager::ShareFrame
+//
+/*! This method adds a reference on a page mapped in several address
+//  spaces (shared memory segment). Such a page has no owner and is
+//  locked: it cannot be evicted, as its owner would be ambiguous.
+//
+//  \param num_page is the number of the real page to share
+*/
+//-----------------------------------------------------------------
+void PhysicalMemManager::ShareFrame(uint64_t num_page) {
+  ASSERT(num_page<g_cfg->NumPhysPages);
+  ASSERT(tpr[num_page].free==false);
+  tpr[num_page].owner = NULL;
+  tpr[num_page].locked = true;
+  tpr[num_page].refCount++;
 }
 
 //-----------------------------------------------------------------
@@ -157,13 +203,14 @@ int PhysicalMemManager::FindFreePage() {
   g_current_thread->GetProcessOwner()->stat->incrMemoryAccess();
   
   // Get a page from the free list
-  page = (int64_t)free_page_list.Remove();
+  page = free_page_list.Remove() - tpr;
   
   // Check that the page is really free
   ASSERT(tpr[page].free);
   
   // Update the physical page table
   tpr[page].free = false;
+  tpr[page].refCount = 1;
 
   return page;
 }
@@ -200,10 +247,11 @@ void PhysicalMemManager::Print(void) {
 
   printf("Contents of TPR (%" PRIu64 " pages)\n",g_cfg->NumPhysPages);
   for (i=0;i<g_cfg->NumPhysPages;i++) {
-    printf("Page %" PRIu64 " free=%d locked=%d virtpage=%" PRIu64 " owner=%lx U=%d M=%d\n",
+    printf("Page %" PRIu64 " free=%d locked=%d refs=%d virtpage=%" PRIu64 " owner=%lx U=%d M=%d\n",
 	   i,
 	   tpr[i].free,
 	   tpr[i].locked,
+	   tpr[i].refCount,
 	   tpr[i].virtualPage,
 	   (long int)tpr[i].owner,
 	   (tpr[i].owner!=NULL) ? tpr[i].owner->translationTable->getBitU(tpr[i].virtualPage) : 0,
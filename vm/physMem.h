@@ -31,7 +31,7 @@ class PhysicalMemManager;
 #include "kernel/synch.h"
 #include "kernel/system.h"
 #include "vm/swapManager.h"
-#include "utility/list.h"
+#include "utility/queue.h"
 
 //-----------------------------------------------------------------
 /*! \brief Implements the physical page management.
@@ -54,6 +54,10 @@ public:
 
   int AddPhysicalToVirtualMapping(AddrSpace* owner,uint64_t vp); //!< Finds a new page and adds a new page mapping
   void RemovePhysicalToVirtualMapping(uint64_t numPage); //!< Frees the page and deletes the existing page mapping
+  int AllocSharedFrame(); //!< Return a zeroed page to share, INVALID_PAGE if none
+  void ShareFrame(uint64_t numPage); //!< Add a reference on a shared page
+  bool IsShared(uint64_t numPage)   //!< true if the page has no owner
+  { return !tpr[numPage].free && tpr[numPage].owner == NULL; }
   void ChangeOwner(uint64_t numPage, Thread* owner);   //!< Change the page owner
   void UnlockPage(uint64_t numPage); //!< Unlock physical page
   void Print(void); //!< Print the contents of a page
@@ -68,12 +72,15 @@ private:
     bool free;  	      //!< true if page is free
     bool locked;              //!< true if page is locked in memory (system page or page under sap in/out)
     uint64_t virtualPage;     //!< Number of the virtualPage which references this real page
-    AddrSpace* owner;	      //!< Address space of the owner process
+    AddrSpace* owner;	      //!< Address space of the owner process (NULL if shared)
+    int refCount;             //!< Number of references, more than one if shared
+    QueueLink freeLink;       //!< Link in the free page list
   }; 
 
   struct tpr_c *tpr;	//!< RealPage Array to know the state of each real page
 
-  Listint free_page_list; //!< List of available (unused) real page numbers
+  //! List of available (unused) real pages
+  Queue<tpr_c, &tpr_c::freeLink> free_page_list;
 
   uint64_t i_clock;          //!< Index for clock_algorithm
 